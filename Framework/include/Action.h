@@ -84,8 +84,32 @@ namespace Robot
 		bool m_Playing;
 		bool m_StopPlaying;
 		bool m_PlayingFinished;
+
+		double m_PlayTime;	// msec since the page started
+		double m_UnitTime;	// msec of the last computed step
+		int m_UnitValue[JointData::NUMBER_OF_JOINTS];
+		int m_PrevUnitValue[JointData::NUMBER_OF_JOINTS];
+
+		// ProcessUnit() state, kept per instance
+		unsigned short wpStartAngle1024[JointData::NUMBER_OF_JOINTS];	// interpolation start
+		unsigned short wpTargetAngle1024[JointData::NUMBER_OF_JOINTS];	// interpolation target
+		short int ipMovingAngle1024[JointData::NUMBER_OF_JOINTS];		// whole distance to go
+		short int ipMainAngle1024[JointData::NUMBER_OF_JOINTS];		// distance in the constant speed section
+		short int ipAccelAngle1024[JointData::NUMBER_OF_JOINTS];		// distance in the acceleration section
+		short int ipMainSpeed1024[JointData::NUMBER_OF_JOINTS];		// constant speed to reach
+		short int ipLastOutSpeed1024[JointData::NUMBER_OF_JOINTS];	// speed of the previous step (inertia)
+		short int ipGoalSpeed1024[JointData::NUMBER_OF_JOINTS];		// speed the motor has to reach
+		unsigned char bpFinishType[JointData::NUMBER_OF_JOINTS];		// how the target is reached
+		unsigned short wUnitTimeCount;
+		unsigned short wUnitTimeNum;
+		unsigned short wPauseTime;
+		unsigned short wUnitTimeTotalNum;
+		unsigned short wAccelStep;
+		unsigned char bSection;
+		unsigned char bPlayRepeatCount;
+		unsigned short wNextPlayPage;
 		
-		Action();
+		void ProcessUnit();
 
 		bool VerifyChecksum( PAGE *pPage );
 		void SetChecksum( PAGE *pPage );		
@@ -93,6 +117,7 @@ namespace Robot
 	public:
 		bool DEBUG_PRINT;
 		
+		Action();
 		~Action();
 
 		static Action* GetInstance() { return m_UniqueInstance; }
@@ -108,6 +133,7 @@ namespace Robot
 		void Brake();
 		bool IsRunning();
 		bool IsRunning(int *iPage, int *iStep);
+		bool IsActive() { return m_Playing; }	// holds its joints only while a page plays
 		bool LoadPage(int index, PAGE *pPage);
 		bool SavePage(int index, PAGE *pPage);
 		void ResetPage(PAGE *pPage);
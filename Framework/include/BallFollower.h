@@ -35,8 +35,6 @@ namespace Robot
 		double m_FollowMaxRLTurn;
         double m_FitFBStep;
 		double m_FitMaxRLTurn;
-		double m_UnitFBStep;
-		double m_UnitRLTurn;
 		
 		double m_GoalFBStep;
 		double m_GoalRLTurn;
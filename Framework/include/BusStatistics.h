@@ -0,0 +1,84 @@
+/*
+ *   BusStatistics.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _BUS_STATISTICS_H_
+#define _BUS_STATISTICS_H_
+
+namespace Robot
+{
+    class BusCounter
+    {
+    public:
+        enum
+        {
+            // bin 0: < 100us, bin n: [100us * 2^(n-1), 100us * 2^n), last open-ended
+            NUMBER_OF_LATENCY_BIN = 12
+        };
+
+        unsigned int packets;
+        unsigned int tx_fail;       // TX_FAIL and TX_CORRUPT
+        unsigned int rx_timeout;
+        unsigned int rx_corrupt;
+        unsigned int tx_bytes;
+        unsigned int rx_bytes;
+        unsigned int latency[NUMBER_OF_LATENCY_BIN];
+
+        BusCounter();
+        void Clear();
+    };
+
+    /*
+     * Always-on bus counters, kept per Dynamixel ID and per instruction.
+     * Writers only use atomic increments, so the control loop never takes a
+     * lock for them. A snapshot copies each counter atomically; counters of
+     * one snapshot may straddle a packet in flight.
+     */
+    class BusStatistics
+    {
+    public:
+        enum
+        {
+            STAT_PING,
+            STAT_READ,
+            STAT_WRITE,
+            STAT_REG_WRITE,
+            STAT_ACTION,
+            STAT_RESET,
+            STAT_SYNC_WRITE,
+            STAT_BULK_READ,
+            STAT_OTHER,
+            NUMBER_OF_INSTRUCTION
+        };
+
+        enum
+        {
+            NUMBER_OF_ID = 256
+        };
+
+    private:
+        BusCounter m_ID[NUMBER_OF_ID];
+        BusCounter m_Instruction[NUMBER_OF_INSTRUCTION];
+
+        static void Add(BusCounter *counter, int result, int tx_bytes, int rx_bytes, double msec);
+        static void Copy(BusCounter *dst, BusCounter *src);
+
+    public:
+        static int GetInstructionIndex(int instruction);
+        static const char* GetInstructionName(int index);
+
+        // msec < 0 : latency is not meaningful, leave the histogram alone
+        void AddPacket(int id, int instruction, int result, int tx_bytes, int rx_bytes, double msec);
+        void AddInstruction(int instruction, int result, int tx_bytes, int rx_bytes, double msec);
+        void AddID(int id, int result, int tx_bytes, int rx_bytes, double msec);
+
+        void GetIDSnapshot(int id, BusCounter *snapshot);
+        void GetInstructionSnapshot(int index, BusCounter *snapshot);
+        void Clear();
+    };
+}
+
+#endif
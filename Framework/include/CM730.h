@@ -9,6 +9,11 @@
 #define _CM_730_H_
 
 #include "MX28.h"
+#include "JointData.h"
+#include "PacketRing.h"
+#include "DynamixelProtocol.h"
+#include "BusStatistics.h"
+#include "SensorSnapshot.h"
 
 #define MAXNUM_TXPARAM      (256)
 #define MAXNUM_RXPARAM      (1024)
@@ -20,6 +25,7 @@ namespace Robot
     public:
         int start_address;
         int length;
+        int read_address;   // start address requested by the last bulk read
         int error;
         unsigned char table[MX28::MAXNUM_ADDRESS];
 
@@ -33,6 +39,8 @@ namespace Robot
 	class PlatformCM730
 	{
 	public:
+		virtual ~PlatformCM730() {}
+
 		/////////// Need to implement below methods (Platform porting) //////////////
 		// Port control
 		virtual bool OpenPort() = 0;
@@ -41,8 +49,12 @@ namespace Robot
 		virtual void ClearPort() = 0;
 		virtual int WritePort(unsigned char* packet, int numPacket) = 0;
 		virtual int ReadPort(unsigned char* packet, int numPacket) = 0;
+		// Optional: any bit rate (bps); GetBaudrate() returns 0 if unsupported
+		virtual bool SetBaudrate(int bps) { return false; }
+		virtual int GetBaudrate() { return 0; }
 
-		// Using semaphore
+		// Bus access: each Wait grants the whole bus for one transaction.
+		// A waiting higher priority is served before any lower one.
 		virtual void LowPriorityWait() = 0;
 		virtual void MidPriorityWait() = 0;
 		virtual void HighPriorityWait() = 0;
@@ -52,6 +64,11 @@ namespace Robot
 
 		// Using timeout
 		virtual void SetPacketTimeout(int lenPacket) = 0;
+		// Optional: timeout for a transaction with 'id' moving 'lenPacket' bytes
+		// (request + reply), and a notice that its reply arrived in full, so the
+		// platform can learn each servo's answer delay.
+		virtual void SetPacketTimeout(int id, int lenPacket) { SetPacketTimeout(lenPacket); }
+		virtual void PacketReceived() {}
 		virtual bool IsPacketTimeout() = 0;
 		virtual double GetPacketTime() = 0;
 		virtual void SetUpdateTimeout(int msec) = 0;
@@ -154,14 +171,53 @@ namespace Robot
 			ID_BROADCAST	= 254
 		};
 
+		enum
+		{
+			MAXNUM_BULKREAD_RANGE	= 64
+		};
+
 	private:
+		struct BulkReadRange
+		{
+			int id;
+			int start_address;
+			int length;
+			int period;		// read once every 'period' BulkRead() calls
+		};
+
 		PlatformCM730 *m_Platform;
 		static const int RefreshTime = 6; //msec
 		unsigned char m_ControlTable[MAXNUM_ADDRESS];
 
 		unsigned char m_BulkReadTxPacket[MAXNUM_TXPARAM + 10];
+		PacketRing m_RxRing;
+		Protocol1 m_Protocol1;
+		DynamixelProtocol *m_Protocol;
+		BusStatistics m_Statistics;
+		SensorSnapshot m_SensorSnapshot;
+
+		BulkReadRange m_BulkReadRange[MAXNUM_BULKREAD_RANGE];
+		bool m_BulkReadDue[MAXNUM_BULKREAD_RANGE];
+		bool m_BulkReadPlanChanged;
+		unsigned int m_BulkReadCount;
+		int m_DeviceBulkReadRange[3];
+		int m_JointBulkReadRange[JointData::NUMBER_OF_JOINTS];	// Webots only
+		bool m_BulkReadPending;
+		int m_BulkReadTxResult;
+		int m_BulkReadTxLength;
+		int m_TxLength;		// wire bytes of the last request
+
+		void UpdateBulkReadPacket();
 
 		int TxRxPacket(unsigned char *txpacket, unsigned char *rxpacket, int priority);
+		int TxPacket(unsigned char *txpacket);
+		int RxPacket(unsigned char *txpacket, unsigned char *rxpacket);
+		int ReadRxRing();
+		int RxStatusPacket(int id, unsigned char *rxpacket);
+		int RxBulkRead(int num, unsigned char *rxpacket);
+		void PrintResult(int res);
+		int CollectBulkRead(bool timed);
+		void UpdateStatistics(unsigned char *txpacket, int tx_bytes, unsigned char *rxpacket, int res, bool timed);
 		unsigned char CalculateChecksum(unsigned char *packet);
 
 	public:
@@ -173,6 +229,14 @@ namespace Robot
 
 		bool Connect();
         bool ChangeBaud(int baud);
+		// Move every device and the host to 'baud' (register value of the
+		// current protocol), verify with a ping and roll back on failure.
+		// The devices are left alone if the host cannot open the new rate.
+		bool NegotiateBaud(int baud);
+
+		// Wire protocol, 1.0 by default. 0 restores 1.0.
+		void SetProtocol(DynamixelProtocol *protocol);
+		DynamixelProtocol* GetProtocol()	{ return m_Protocol; }
 		void Disconnect();
 		bool DXLPowerOn();
 
@@ -187,12 +251,30 @@ namespace Robot
 		int ReadTable(int id, int start_addr, int end_addr, unsigned char *table, int *error);
 		int WriteByte(int id, int address, int value, int *error);
 		int WriteWord(int id, int address, int value, int *error);
+		// One bulk read of the same window from 'number' IDs, outside the
+		// bulk read plan. m_BulkReadData[id].error stays -1 for an ID that did
+		// not answer; in protocol 1.0 the IDs listed after it stay silent too.
+		int BulkReadOnce(int number, int *id, int start_addr, int length);
 
 		// For motion control
 		int SyncWrite(int start_addr, int each_length, int number, int *pParam);
 
+		// Bulk read plan: every tick reads the union of the ranges due for each ID
+		int AddBulkReadRange(int id, int start_addr, int length);
+		int AddBulkReadRange(int id, int start_addr, int length, int period);
+		void RemoveBulkReadRange(int handle);
 		void MakeBulkReadPacket();
         int BulkRead();
+		// Split bulk read: the request goes out in Start(), the replies are
+		// collected in Finish(). The bus stays locked in between.
+		int BulkReadStart();
+		int BulkReadFinish();
+
+		// Per-ID and per-instruction bus counters, safe to read from any thread
+		BusStatistics* GetStatistics()	{ return &m_Statistics; }
+
+		// Decoded bulk read results of the last complete tick, safe to read from any thread
+		SensorSnapshot* GetSensorSnapshot()	{ return &m_SensorSnapshot; }
 
 		// Utility
 		static int MakeWord(int lowbyte, int highbyte);
@@ -13,9 +13,12 @@
 #include "MotionModule.h"
 #include "MotionManager.h"
 #include "MotionStatus.h"
+#include "MotionContext.h"
+#include "WalkEvaluator.h"
 #include "JointData.h"
 #include "Action.h"
 #include "Walking.h"
+#include "PreviewWalking.h"
 #include "Head.h"
 #include "Image.h"
 #include "ImgProcess.h"
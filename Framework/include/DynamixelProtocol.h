@@ -0,0 +1,162 @@
+/*
+ *   DynamixelProtocol.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _DYNAMIXEL_PROTOCOL_H_
+#define _DYNAMIXEL_PROTOCOL_H_
+
+#include "PacketRing.h"
+
+namespace Robot
+{
+    /*
+     * Wire format of the Dynamixel bus.
+     * CM730 always builds requests in the protocol 1.0 layout
+     * (FF FF ID LEN INST PARAM... CHK) and reads status packets in that
+     * layout (FF FF ID LEN ERR PARAM... CHK). A protocol translates requests
+     * to its own wire format and parses its replies back into that layout.
+     */
+    class DynamixelProtocol
+    {
+    public:
+        enum
+        {
+            FRAME_INCOMPLETE,
+            FRAME_RECEIVED,
+            FRAME_CORRUPT
+        };
+
+        virtual ~DynamixelProtocol() {}
+
+        virtual int GetVersion() = 0;
+
+        // Returns the wire length, or 0 if the request does not fit 'capacity'.
+        virtual int Encode(unsigned char *txpacket, unsigned char *wire, int capacity) = 0;
+
+        // Parser state is kept between calls; Reset() drops a partial frame.
+        virtual void Reset() = 0;
+        virtual int Parse(PacketRing *ring, unsigned char *rxpacket, int capacity) = 0;
+
+        // Bytes on the wire of a status packet carrying 'num_param' bytes
+        virtual int GetStatusLength(int num_param) = 0;
+        // Bytes on the wire of the replies to a bulk read from 'num' IDs,
+        // 'num_param' bytes in all
+        virtual int GetBulkStatusLength(int num, int num_param) = 0;
+        // Bytes on the wire of a SyncWrite to 'number' IDs of 'each_length'
+        // bytes each, ID included
+        virtual int GetSyncWriteLength(int each_length, int number) = 0;
+
+        // Bit rate of a baud rate register value, 0 if unknown
+        virtual int GetBaudrate(int baud_number) = 0;
+        virtual int GetBaudRateAddress() = 0;
+    };
+
+    class Protocol1 : public DynamixelProtocol
+    {
+    private:
+        enum
+        {
+            WAIT_HEADER1,
+            WAIT_HEADER2,
+            WAIT_ID,
+            WAIT_LENGTH,
+            WAIT_BODY
+        };
+
+        int m_State;
+        int m_FrameIndex;
+        int m_FrameLength;
+        unsigned char m_Checksum;
+
+    public:
+        Protocol1();
+
+        int GetVersion() { return 1; }
+        int Encode(unsigned char *txpacket, unsigned char *wire, int capacity);
+        void Reset();
+        int Parse(PacketRing *ring, unsigned char *rxpacket, int capacity);
+        int GetStatusLength(int num_param) { return num_param + 6; }
+        int GetBulkStatusLength(int num, int num_param) { return num * 6 + num_param; }
+        int GetSyncWriteLength(int each_length, int number) { return 8 + number * each_length; }
+        int GetBaudrate(int baud_number);
+        int GetBaudRateAddress() { return 4; }
+    };
+
+    /*
+     * Protocol 2.0: FF FF FD 00 ID LEN_L LEN_H INST PARAM... CRC_L CRC_H,
+     * with byte stuffing and 16-bit addresses/lengths. With FAST_READ a bulk
+     * read goes out as Fast Sync Read if every ID reads the same range, else
+     * as Fast Bulk Read, and the single reply is split back into one status
+     * packet per ID.
+     */
+    class Protocol2 : public DynamixelProtocol
+    {
+    public:
+        enum
+        {
+            MAXNUM_BODY     = 1024,
+            MAXNUM_FAST_ID  = 64
+        };
+
+    private:
+        enum
+        {
+            WAIT_HEADER1,
+            WAIT_HEADER2,
+            WAIT_HEADER3,
+            WAIT_RESERVED,
+            WAIT_ID,
+            WAIT_LENGTH_L,
+            WAIT_LENGTH_H,
+            WAIT_BODY
+        };
+
+        unsigned short m_CRCTable[256];
+
+        int m_State;
+        int m_ID;
+        int m_Length;       // LEN field: instruction + stuffed parameters + CRC
+        int m_Index;        // LEN bytes received
+        unsigned short m_CRC;
+        unsigned char m_Body[MAXNUM_BODY];
+        int m_BodyLength;   // de-stuffed instruction + error + parameters
+        int m_StuffMatch;   // FF FF FD seen right before this byte
+        unsigned char m_CRCLow;
+
+        // Fast Bulk Read: per-ID data lengths of the request, and the reply
+        // blocks still to hand out
+        bool m_FastPending;
+        int m_FastNum;
+        int m_FastLength[MAXNUM_FAST_ID];
+        int m_FastIndex;
+        int m_FastOffset;
+
+        void MakeCRCTable();
+        unsigned short UpdateCRC(unsigned short crc, const unsigned char *data, int length);
+        int Stuff(const unsigned char *param, int num_param, unsigned char *out, int capacity);
+        int NextFastBlock(unsigned char *rxpacket, int capacity);
+
+    public:
+        bool FAST_READ;
+
+        Protocol2();
+
+        int GetVersion() { return 2; }
+        int Encode(unsigned char *txpacket, unsigned char *wire, int capacity);
+        void Reset();
+        int Parse(PacketRing *ring, unsigned char *rxpacket, int capacity);
+        // lengths below leave out byte stuffing, which data rarely needs
+        int GetStatusLength(int num_param) { return num_param + 11; }
+        int GetBulkStatusLength(int num, int num_param);
+        int GetSyncWriteLength(int each_length, int number) { return 14 + number * each_length; }
+        int GetBaudrate(int baud_number);
+        int GetBaudRateAddress() { return 8; }
+
+        unsigned short CalculateCRC(const unsigned char *data, int length) { return UpdateCRC(0, data, length); }
+    };
+}
+
+#endif
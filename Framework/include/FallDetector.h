@@ -0,0 +1,48 @@
+/*
+ *   FallDetector.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _FALL_DETECTOR_H_
+#define _FALL_DETECTOR_H_
+
+namespace Robot
+{
+	/*
+	 * Tells STANDUP, FORWARD or BACKWARD from the front-back accelerometer.
+	 * The average over the samples of the last WINDOW_TIME is kept as a
+	 * running sum, so a sample costs the same however long the window is.
+	 */
+	class FallDetector
+	{
+	public:
+		enum
+		{
+			MAX_WINDOW_SIZE = 256
+		};
+
+	private:
+		double m_TimeUnit;
+		int m_Window[MAX_WINDOW_SIZE];
+		int m_WindowSize;
+		int m_Index;
+		int m_Sum;
+
+	public:
+		double WINDOW_TIME;	// msec, applied by Reset()
+
+		FallDetector();
+
+		void Reset();
+		// msec between samples; restarts the window
+		void SetTimeUnit(double msec);
+		void AddSample(int fb_accel);
+
+		int GetAverage()	{ return m_Sum / m_WindowSize; }
+		int GetState();		// STANDUP, FORWARD or BACKWARD
+	};
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ *   FixedMatrix.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _FIXED_MATRIX_H_
+#define _FIXED_MATRIX_H_
+
+namespace Robot
+{
+	/*
+	 * Small dense matrix whose size is part of its type, for controllers
+	 * that run in the motion tick: no allocation, and the compiler unrolls
+	 * the loops. Elements are row major in m[].
+	 */
+	template<int ROWS, int COLS>
+	class FixedMatrix
+	{
+	public:
+		double m[ROWS * COLS];
+
+		FixedMatrix()									{ Zero(); }
+
+		void Zero()
+		{
+			for(int i = 0; i < ROWS * COLS; i++)
+				m[i] = 0;
+		}
+
+		void Identity()
+		{
+			for(int r = 0; r < ROWS; r++)
+				for(int c = 0; c < COLS; c++)
+					m[r * COLS + c] = (r == c) ? 1 : 0;
+		}
+
+		double &operator()(int row, int col)			{ return m[row * COLS + col]; }
+		double operator()(int row, int col) const		{ return m[row * COLS + col]; }
+
+		FixedMatrix<COLS, ROWS> Transpose() const
+		{
+			FixedMatrix<COLS, ROWS> t;
+			for(int r = 0; r < ROWS; r++)
+				for(int c = 0; c < COLS; c++)
+					t(c, r) = m[r * COLS + c];
+			return t;
+		}
+
+		FixedMatrix operator + (const FixedMatrix &mat) const
+		{
+			FixedMatrix sum;
+			for(int i = 0; i < ROWS * COLS; i++)
+				sum.m[i] = m[i] + mat.m[i];
+			return sum;
+		}
+
+		FixedMatrix operator - (const FixedMatrix &mat) const
+		{
+			FixedMatrix diff;
+			for(int i = 0; i < ROWS * COLS; i++)
+				diff.m[i] = m[i] - mat.m[i];
+			return diff;
+		}
+
+		FixedMatrix operator * (double scale) const
+		{
+			FixedMatrix prod;
+			for(int i = 0; i < ROWS * COLS; i++)
+				prod.m[i] = m[i] * scale;
+			return prod;
+		}
+
+		template<int N>
+		FixedMatrix<ROWS, N> operator * (const FixedMatrix<COLS, N> &mat) const
+		{
+			FixedMatrix<ROWS, N> prod;
+			for(int r = 0; r < ROWS; r++)
+				for(int c = 0; c < N; c++)
+				{
+					double sum = 0;
+					for(int k = 0; k < COLS; k++)
+						sum += m[r * COLS + k] * mat(k, c);
+					prod(r, c) = sum;
+				}
+			return prod;
+		}
+	};
+}
+
+#endif
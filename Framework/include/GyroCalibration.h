@@ -0,0 +1,68 @@
+/*
+ *   GyroCalibration.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _GYRO_CALIBRATION_H_
+#define _GYRO_CALIBRATION_H_
+
+namespace Robot
+{
+	/*
+	 * Gyro zero point, estimated online.
+	 * Calibration keeps a running mean and variance (Welford) of the samples
+	 * of the first WINDOW_TIME and accepts the mean if pitch and roll were still.
+	 * Afterwards an exponential mean and variance follow the gyro, and while
+	 * they show the robot standing still the center drifts slowly towards
+	 * them, so a bias that moves with temperature keeps being removed.
+	 */
+	class GyroCalibration
+	{
+	public:
+		enum
+		{
+			FB_AXIS,
+			RL_AXIS,
+			YAW_AXIS,
+			NUMBER_OF_AXIS
+		};
+
+	private:
+		double m_TimeUnit;
+		int m_Status;
+		int m_Count;
+		double m_Mean[NUMBER_OF_AXIS];
+		double m_M2[NUMBER_OF_AXIS];
+		double m_Center[NUMBER_OF_AXIS];
+		double m_TrackMean[NUMBER_OF_AXIS];
+		double m_TrackVar[NUMBER_OF_AXIS];
+
+	public:
+		double MARGIN_OF_SD;	// largest standard deviation that counts as still
+		bool BIAS_TRACKING;
+		double WINDOW_TIME;		// msec of samples the calibration averages
+		double TRACKING_TIME;	// msec, time constant of the still detector
+		double BIAS_TIME;		// msec, time constant of the center while still
+
+		GyroCalibration();
+
+		void Reset();
+		// msec between samples, the times above are converted with it
+		void SetTimeUnit(double msec);
+		void AddSample(int fb, int rl, int yaw);
+
+		// 0: collecting, 1: calibrated, -1: the last window was not still
+		int GetStatus()					{ return m_Status; }
+		int GetSampleCount()			{ return m_Count; }
+		double GetCenter(int axis)		{ return m_Center[axis]; }
+		double GetDeviation(int axis);	// of the window, or of the tracker once calibrated
+		bool IsStill();
+
+		// gyro reading minus the center, rounded
+		int Correct(int axis, int value);
+	};
+}
+
+#endif
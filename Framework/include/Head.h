@@ -12,6 +12,7 @@
 
 #include "minIni.h"
 #include "MotionModule.h"
+#include "SeqLock.h"
 #include "Point.h"
 
 #define HEAD_SECTION    "Head Pan/Tilt"
@@ -22,6 +23,12 @@ namespace Robot
 	class Head : public MotionModule
 	{
 	private:
+		struct Target
+		{
+			double pan;
+			double tilt;
+		};
+
 		static Head* m_UniqueInstance;
 		double m_LeftLimit;
 		double m_RightLimit;
@@ -39,13 +46,18 @@ namespace Robot
 		double m_Tilt_d_gain;
 		double m_PanAngle;
 		double m_TiltAngle;
+
+		// angles handed from the caller's thread to Process()
+		SeqLock<Target> m_Target;
+		Target m_ProcessTarget;
 		
-		Head();
 		void CheckLimit();
+		void PostTarget();
 
 	public:
 		static Head* GetInstance() { return m_UniqueInstance; }
 		
+		Head();
 		~Head();
 
 		void Initialize();
@@ -54,6 +54,13 @@ namespace Robot
 		    D_GAIN_DEFAULT      = 0
 		};
 
+		enum
+		{
+			CHANGED_VALUE		= 0x01,	// goal position
+			CHANGED_GAIN		= 0x02,	// compliance slopes or PID gains
+			CHANGED_ALL			= CHANGED_VALUE | CHANGED_GAIN
+		};
+
 	private:		
 
 	protected:
@@ -65,6 +72,7 @@ namespace Robot
 		int m_PGain[NUMBER_OF_JOINTS];
         int m_IGain[NUMBER_OF_JOINTS];
         int m_DGain[NUMBER_OF_JOINTS];
+		int m_Changed[NUMBER_OF_JOINTS];
 
 	public:
 		JointData();
@@ -107,12 +115,18 @@ namespace Robot
 		void SetCCWSlope(int id, int ccwSlope);
 		int  GetCCWSlope(int id);
 
-        void SetPGain(int id, int pgain) { m_PGain[id] = pgain; }
+        void SetPGain(int id, int pgain);
         int  GetPGain(int id)            { return m_PGain[id]; }
-        void SetIGain(int id, int igain) { m_IGain[id] = igain; }
+        void SetIGain(int id, int igain);
         int  GetIGain(int id)            { return m_IGain[id]; }
-        void SetDGain(int id, int dgain) { m_DGain[id] = dgain; }
+        void SetDGain(int id, int dgain);
         int  GetDGain(int id)            { return m_DGain[id]; }
+
+		// Which registers moved since ClearChanged(). Setters only flag a real
+		// change, so rewriting the same value every tick stays clean.
+		int  GetChanged(int id)				{ return m_Changed[id]; }
+		void SetChanged(int id)				{ m_Changed[id] = CHANGED_ALL; }
+		void ClearChanged(int id)			{ m_Changed[id] = 0; }
 	};
 }
 
@@ -13,6 +13,17 @@
 
 namespace Robot
 {
+	// Structure of arrays for Kinematics::LegIK(), 'number' poses
+	template<typename T>
+	struct LegIKBatch
+	{
+		int number;
+		const T *x, *y, *z;		// foot position (mm), z = 0 is the stretched leg
+		const T *a, *b, *c;		// foot roll, pitch and yaw (rad)
+		T *angle[6];			// out (rad): hip yaw, hip roll, hip pitch, knee, ankle pitch, ankle roll
+		bool *valid;			// out, may be 0
+	};
+
 	class Kinematics
 	{
 	private:
@@ -33,6 +44,20 @@ namespace Robot
 		~Kinematics();
 
 		static Kinematics* GetInstance()			{ return m_UniqueInstance; }
+
+		// Closed-form inverse kinematics of a DARwIn-OP leg. 'out' gets the six
+		// joint angles in LegIKBatch order; false if the pose is out of reach.
+		// No matrices and no allocation, the batch versions solve both legs or
+		// any number of candidate poses in one call and return how many were
+		// reachable (angles of the others are left untouched).
+		static bool LegIK(double *out, double x, double y, double z, double a, double b, double c);
+		static bool LegIK(float *out, float x, float y, float z, float a, float b, float c);
+		static int LegIK(const LegIKBatch<double> &batch);
+		static int LegIK(const LegIKBatch<float> &batch);
+
+		// How far (mm) the hip to ankle distance of a leg pose is from the
+		// nearest end of the knee's range; negative if LegIK() cannot reach it.
+		static double LegReachMargin(double x, double y, double z, double a, double b, double c);
 	};
 }
 
@@ -0,0 +1,57 @@
+/*
+ *   MotionContext.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _MOTION_CONTEXT_H_
+#define _MOTION_CONTEXT_H_
+
+#include "CM730.h"
+#include "MotionStatus.h"
+#include "MotionManager.h"
+#include "Action.h"
+#include "Head.h"
+#include "Walking.h"
+
+namespace Robot
+{
+	/*
+	 * One robot: a CM730 on the caller's platform, its own MotionStatus and
+	 * MotionManager, and a Walking, Action and Head that only touch those.
+	 * Nothing is shared between contexts, so several can be driven from
+	 * different threads, e.g. to evaluate gait parameters in parallel on
+	 * simulated buses. The GetInstance() singletons stay the default robot.
+	 */
+	class MotionContext
+	{
+	private:
+		MotionStatus m_Status;
+		CM730 *m_CM730;
+		MotionManager *m_Manager;
+		Walking *m_Walking;
+		Action *m_Action;
+		Head *m_Head;
+
+		MotionContext(const MotionContext &);
+		MotionContext &operator=(const MotionContext &);
+
+	public:
+		MotionContext(PlatformCM730 *platform);
+		~MotionContext();
+
+		// Initializes the manager on the CM730 and adds Action, Head and
+		// Walking to it, in that order.
+		bool Initialize();
+
+		MotionStatus* GetMotionStatus()		{ return &m_Status; }
+		CM730* GetCM730()					{ return m_CM730; }
+		MotionManager* GetMotionManager()	{ return m_Manager; }
+		Walking* GetWalking()				{ return m_Walking; }
+		Action* GetAction()					{ return m_Action; }
+		Head* GetHead()						{ return m_Head; }
+	};
+}
+
+#endif
@@ -14,6 +14,10 @@
 #include "MotionStatus.h"
 #include "MotionModule.h"
 #include "CM730.h"
+#include "Telemetry.h"
+#include "GyroCalibration.h"
+#include "FallDetector.h"
+#include "OrientationFilter.h"
 #include "minIni.h"
 
 #define OFFSET_SECTION "Offset"
@@ -26,20 +30,44 @@ namespace Robot
 	private:
 		static MotionManager* m_UniqueInstance;
 		std::list<MotionModule*> m_Modules;
+		MotionStatus *m_Status;
 		CM730 *m_CM730;
 		bool m_ProcessEnable;
 		bool m_Enabled;
-		int m_FBGyroCenter;
-		int m_RLGyroCenter;
-		int m_CalibrationStatus;
+		GyroCalibration m_GyroCalibration;
+		FallDetector m_FallDetector;
+		OrientationFilter m_OrientationFilter;
 
-		bool m_IsRunning;
+		volatile bool m_IsRunning;
 		bool m_IsThreadRunning;
-		bool m_IsLogging;
+		volatile bool m_IsLogging;
+		bool m_BusPipelining;
+		double m_TimeUnit;
+		bool m_DeltaWrite;
+		double m_FullWritePeriod;
+		double m_FullWriteElapsed;
+		int m_WriteBytes;
+		int m_WrittenOffset[JointData::NUMBER_OF_JOINTS];
 
-		std::ofstream m_LogFileStream;
+		TelemetryRing m_Telemetry;
+		double m_LogStartTime;
 
-        MotionManager();
+		int m_JointBulkReadRange[JointData::NUMBER_OF_JOINTS];
+		int m_JointStatusBulkReadRange[JointData::NUMBER_OF_JOINTS];
+
+		MotionModule *m_JointOwner[JointData::NUMBER_OF_JOINTS];
+		int m_FadeStart[JointData::NUMBER_OF_JOINTS];		// output when the owner changed
+		double m_FadeElapsed[JointData::NUMBER_OF_JOINTS];	// msec, negative when not fading
+		double m_FadeDuration[JointData::NUMBER_OF_JOINTS];
+
+		bool m_JointFound[JointData::NUMBER_OF_JOINTS];	// topology of the last discovery
+
+		void DiscoverJoints();
+		void SetJointFound(int id, int value);
+
+		void SubscribeJointBulkRead();
+		void ArbitrateJoints();
+		void WriteJoints();
 
 	protected:
 
@@ -47,24 +75,64 @@ namespace Robot
 		bool DEBUG_PRINT;
         int m_Offset[JointData::NUMBER_OF_JOINTS];
 
+		// Every manager publishes into its own MotionStatus, so several
+		// robots can run in one process. GetInstance() uses the default one.
+		MotionManager(MotionStatus *status);
 		~MotionManager();
 
 		static MotionManager* GetInstance() { return m_UniqueInstance; }
 
+		MotionStatus* GetMotionStatus()		{ return m_Status; }
+		CM730* GetCM730()					{ return m_CM730; }
+
+		// Both look for the joints with one bulk read of the servos found last
+		// time (all of them at first) and single reads for the rest, so only
+		// a missing servo costs a packet timeout.
 		bool Initialize(CM730 *cm730);
 		bool Reinitialize();
+		bool IsJointFound(int id)			{ return m_JointFound[id]; }
         void Process();
 		void SetEnable(bool enable);
 		bool GetEnable()				{ return m_Enabled; }
 		void AddModule(MotionModule *module);
 		void RemoveModule(MotionModule *module);
 
-		void ResetGyroCalibration() { m_CalibrationStatus = 0; m_FBGyroCenter = 512; m_RLGyroCenter = 512; }
-		int GetCalibrationStatus() { return m_CalibrationStatus; }
+		void ResetGyroCalibration() { m_GyroCalibration.Reset(); m_OrientationFilter.Reset(); }
+		int GetCalibrationStatus() { return m_GyroCalibration.GetStatus(); }
+		GyroCalibration* GetGyroCalibration()	{ return &m_GyroCalibration; }
+		FallDetector* GetFallDetector()			{ return &m_FallDetector; }
+		OrientationFilter* GetOrientationFilter()	{ return &m_OrientationFilter; }
 		void SetJointDisable(int index);
-
+		MotionModule* GetJointOwner(int id)	{ return m_JointOwner[id]; }
+		bool IsJointFading(int id)			{ return m_FadeElapsed[id] >= 0; }
+
+		// Overlap the bulk read reply with module computation (default on).
+		// Off restores the serial SyncWrite -> BulkRead order.
+		void SetBusPipelining(bool enable)	{ m_BusPipelining = enable; }
+		bool GetBusPipelining()				{ return m_BusPipelining; }
+
+		// Control period in msec (default MotionModule::TIME_UNIT), passed on
+		// to every module. The motion timer picks it up on its next tick.
+		void SetTimeUnit(double msec);
+		double GetTimeUnit()				{ return m_TimeUnit; }
+
+		// Only send the joints whose goal or gains changed, and only the goal
+		// position when their gains did not (default on). Every full write
+		// period all enabled joints are sent again in case a packet was lost.
+		void SetDeltaWrite(bool enable)		{ m_DeltaWrite = enable; }
+		bool GetDeltaWrite()				{ return m_DeltaWrite; }
+		void SetFullWritePeriod(double msec)	{ m_FullWritePeriod = msec; }
+		double GetFullWritePeriod()			{ return m_FullWritePeriod; }
+		void InvalidateJoints()				{ m_FullWriteElapsed = m_FullWritePeriod; }
+		int GetWriteBytes()					{ return m_WriteBytes; }	// SyncWrite bytes of the last tick
+
+		// Process() pushes a TelemetryRecord per tick into the telemetry ring
+		// while logging. It never touches a file: a writer thread such as
+		// LinuxTelemetryWriter drains the ring, a full ring drops records.
 		void StartLogging();
 		void StopLogging();
+		bool IsLogging()					{ return m_IsLogging; }
+		TelemetryRing* GetTelemetry()		{ return &m_Telemetry; }
 
         void LoadINISettings(minIni* ini);
         void LoadINISettings(minIni* ini, const std::string &section);
@@ -9,6 +9,7 @@
 #define _MOTION_MODULE_H_
 
 #include "JointData.h"
+#include "MotionStatus.h"
 
 namespace Robot
 {
@@ -17,14 +18,55 @@ namespace Robot
 	private:
 
 	protected:
+		double m_TimeUnit; //msec, time between two Process() calls
+		int m_Priority[JointData::NUMBER_OF_JOINTS];
+		double m_FadeTime; //msec
+		MotionStatus *m_MotionStatus; //status of the robot this module drives
+
+		// 'value' moved towards 'target' by at most 'max_change'
+		static double Approach(double value, double target, double max_change)
+		{
+			if(target > value + max_change)
+				return value + max_change;
+			if(target < value - max_change)
+				return value - max_change;
+			return target;
+		}
 
 	public:
 		JointData m_Joint;
 
-		static const int TIME_UNIT = 8; //msec 
+		static const int TIME_UNIT = 8; //msec, default control period
+
+		MotionModule() : m_TimeUnit(TIME_UNIT), m_FadeTime(0), m_MotionStatus(MotionStatus::GetDefault())
+		{
+			for(int id = 0; id < JointData::NUMBER_OF_JOINTS; id++)
+				m_Priority[id] = 0;
+		}
+		virtual ~MotionModule() {}
 
 		virtual void Initialize() = 0;
 		virtual void Process() = 0;
+
+		// Set by MotionManager, modules advance their time by this each Process()
+		virtual void SetTimeUnit(double msec)	{ m_TimeUnit = msec; }
+		double GetTimeUnit()					{ return m_TimeUnit; }
+
+		// Set by MotionManager::AddModule()
+		void SetMotionStatus(MotionStatus *status)	{ m_MotionStatus = status; }
+		MotionStatus* GetMotionStatus()			{ return m_MotionStatus; }
+
+		// Joint arbitration in MotionManager. Among the modules that enable a
+		// joint the active one with the highest priority owns it (the later
+		// added module wins a tie), an inactive module only keeps a joint
+		// nobody active wants. Taking a joint over blends from the previous
+		// output to this module's over its fade time (0 switches at once).
+		void SetPriority(int priority)			{ for(int id = 0; id < JointData::NUMBER_OF_JOINTS; id++) m_Priority[id] = priority; }
+		void SetPriority(int id, int priority)	{ m_Priority[id] = priority; }
+		int GetPriority(int id)					{ return m_Priority[id]; }
+		void SetFadeTime(double msec)			{ m_FadeTime = msec; }
+		double GetFadeTime()					{ return m_FadeTime; }
+		virtual bool IsActive()					{ return true; }
 	};
 }
 
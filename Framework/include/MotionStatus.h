@@ -9,6 +9,7 @@
 #define _MOTION_STATUS_H_
 
 #include "JointData.h"
+#include "SeqLock.h"
 
 
 namespace Robot
@@ -19,23 +20,79 @@ namespace Robot
         FORWARD     = 1
     };
 
+	// Consistent copy of MotionStatus as of the end of one motion tick
+	struct MotionState
+	{
+		unsigned int tick;
+		int joint_value[JointData::NUMBER_OF_JOINTS];
+		int fb_gyro;
+		int rl_gyro;
+		int fb_accel;
+		int rl_accel;
+		int button;
+		int fallen;
+		double pitch;
+		double roll;
+		double yaw_rate;
+		int fall_prediction;
+	};
+
+	/*
+	 * Status of one robot, shared by its MotionManager and motion modules.
+	 * The static members are the status of the default robot, the one
+	 * MotionManager::GetInstance() drives, so existing code keeps working.
+	 */
 	class MotionStatus
 	{
 	private:
+		static MotionStatus m_Default;
+		SeqLock<MotionState> m_State;
 
 	public:
 	    static const int FALLEN_F_LIMIT     = 390;
 	    static const int FALLEN_B_LIMIT     = 580;
 	    static const int FALLEN_MAX_COUNT   = 30;
 
-		static JointData m_CurrentJoints;
-		static int FB_GYRO;
-		static int RL_GYRO;
-		static int FB_ACCEL;
-		static int RL_ACCEL;
+		JointData m_Joints;
+		int m_FBGyro;
+		int m_RLGyro;
+		int m_FBAccel;
+		int m_RLAccel;
+		int m_Button;
+		int m_Fallen;
+		double m_Pitch;
+		double m_Roll;
+		double m_YawRate;
+		int m_FallPrediction;
+
+		MotionStatus();
+
+		// The fields above belong to the motion thread. PublishState() is
+		// called by MotionManager after each tick; other threads ReadState().
+		void PublishState();
+		void ReadState(MotionState *state);
+
+		static MotionStatus* GetDefault()	{ return &m_Default; }
+
+		// default robot
+		static JointData &m_CurrentJoints;
+		static int &FB_GYRO;
+		static int &RL_GYRO;
+		static int &FB_ACCEL;
+		static int &RL_ACCEL;
+
+		static int &BUTTON;
+		static int &FALLEN;
+
+		// from the orientation filter: degrees, deg/s, and FORWARD or
+		// BACKWARD when a fall is coming (before FALLEN reports it)
+		static double &PITCH;
+		static double &ROLL;
+		static double &YAW_RATE;
+		static int &FALL_PREDICTION;
 
-		static int BUTTON;
-		static int FALLEN;
+		static void Publish()						{ m_Default.PublishState(); }
+		static void GetState(MotionState *state)	{ m_Default.ReadState(state); }
 	};
 }
 
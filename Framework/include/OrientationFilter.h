@@ -0,0 +1,63 @@
+/*
+ *   OrientationFilter.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _ORIENTATION_FILTER_H_
+#define _ORIENTATION_FILTER_H_
+
+namespace Robot
+{
+	/*
+	 * Complementary filter for the body tilt.
+	 * The gyro rates are integrated every tick and pulled towards the tilt
+	 * the accelerometer sees with time constant TIME_CONSTANT. While the
+	 * measured acceleration is far from 1 g (steps, impacts) the accelerometer
+	 * is not trusted and the gyro runs alone. The filter starts from the
+	 * first reading within ACCEL_MARGIN of 1 g and predicts nothing before.
+	 * Pitch is positive leaning forward, roll positive leaning to the right,
+	 * all in degrees.
+	 */
+	class OrientationFilter
+	{
+	private:
+		double m_Pitch;
+		double m_Roll;
+		double m_PitchRate;
+		double m_RollRate;
+		double m_YawRate;
+		bool m_Initialized;
+
+	public:
+		double GYRO_SCALE;			// deg/s per gyro step
+		double ACCEL_SCALE;			// accelerometer steps per g
+		int FB_GYRO_SIGN;			// +1 or -1, so the gyro turns the way the tilt does
+		int RL_GYRO_SIGN;
+		double TIME_CONSTANT;		// sec
+		double ACCEL_MARGIN;		// g away from 1 g the accelerometer still counts
+		double FALLEN_ANGLE;		// deg of pitch at which the robot lies
+		double PREDICTION_TIME;		// sec looked ahead for a fall
+
+		OrientationFilter();
+
+		void Reset();
+
+		// gyro: calibrated rates in gyro steps, accel: raw readings (512 = 0 g)
+		void Process(double dt, int fb_gyro, int rl_gyro, int yaw_gyro,
+					 int fb_accel, int rl_accel, int z_accel);
+
+		double GetPitch()			{ return m_Pitch; }
+		double GetRoll()			{ return m_Roll; }
+		double GetPitchRate()		{ return m_PitchRate; }
+		double GetRollRate()		{ return m_RollRate; }
+		double GetYawRate()			{ return m_YawRate; }
+
+		// FORWARD or BACKWARD when the pitch reaches FALLEN_ANGLE within
+		// PREDICTION_TIME at its current rate (or already has), else STANDUP
+		int GetFallPrediction();
+	};
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ *   PacketRing.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _PACKET_RING_H_
+#define _PACKET_RING_H_
+
+namespace Robot
+{
+    /*
+     * Receive ring for Dynamixel status packets.
+     * The port writes straight into the free span of the ring and a protocol
+     * parser walks the new bytes once with Pop(), keeping its own header,
+     * length and checksum state between calls. A corrupt frame rewinds to one
+     * byte after its header, so resynchronisation never shifts the buffer.
+     */
+    class PacketRing
+    {
+    public:
+        enum
+        {
+            RING_SIZE   = 2048,
+            RING_MASK   = RING_SIZE - 1
+        };
+
+    private:
+        unsigned char m_Ring[RING_SIZE];
+        unsigned int m_Head;        // next byte to parse
+        unsigned int m_Tail;        // next byte the port will write
+        unsigned int m_FrameStart;  // first header byte of the frame being parsed
+        bool m_InFrame;
+
+    public:
+        PacketRing();
+
+        void Reset();
+
+        // Contiguous free space the port may fill, then Commit() what was read.
+        int GetWritable(unsigned char **ptr);
+        void Commit(int length);
+
+        // Parser side
+        bool Pop(unsigned char *data);
+        void BeginFrame();          // the byte just popped is a frame header
+        void SkipFrameByte();       // drop the first byte of the current header
+        void EndFrame();            // frame complete, its bytes may be reused
+        void Resync();              // frame corrupt, parse again after its header
+    };
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ *   PreviewWalking.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _PREVIEW_WALKING_H_
+#define _PREVIEW_WALKING_H_
+
+#include <string.h>
+
+#include "minIni.h"
+#include "MotionModule.h"
+#include "FixedMatrix.h"
+#include "SeqLock.h"
+
+#define PREVIEW_WALKING_SECTION "Preview Walking Config"
+#define INVALID_VALUE   -1024.0
+
+namespace Robot
+{
+	/*
+	 * Walking by ZMP preview control, an alternative to Walking's open-loop
+	 * sine gait. A step planner turns the velocity command into a queue of
+	 * footsteps, the ZMP reference follows the support foot, and the centre
+	 * of mass of a cart-table model tracks it with a preview controller that
+	 * looks PREVIEW_TIME ahead. The feet are placed around the centre of
+	 * mass with Kinematics::LegIK().
+	 * Positions are mm in a world frame fixed at Initialize(), x forward,
+	 * y left; angles are degrees in the public interface.
+	 */
+	class PreviewWalking : public MotionModule
+	{
+	public:
+		enum
+		{
+			RIGHT_FOOT = 0,
+			LEFT_FOOT = 1,
+			STAND = -1,				// Footstep::swing of a step that ends walking
+
+			MAX_PREVIEW = 256,		// ticks
+			MAX_FOOTSTEPS = 16
+		};
+
+		struct Footstep
+		{
+			int swing;				// foot that moves, or STAND
+			double x, y, a;			// where it lands (a in rad)
+			double zmp_x, zmp_y;	// ZMP reference once the step's double support is over
+			double body_x, body_y, body_a;	// pose the feet are placed around
+			double vx, vy, va;		// step velocity after the acceleration limits (mm, rad)
+		};
+
+	private:
+		// Posted by application threads, taken by Process() on the motion thread
+		struct Command
+		{
+			double x_move;
+			double y_move;
+			double a_move;
+			bool running;
+		};
+
+		enum
+		{
+			LOCKED_STEPS = 2		// steps kept when the command changes
+		};
+
+		static PreviewWalking* m_UniqueInstance;
+
+		SeqLock<Command> m_Command;
+		unsigned int m_CommandSequence;
+		double m_X_Velocity;
+		double m_Y_Velocity;
+		double m_A_Velocity;
+		bool m_Ctrl_Running;
+		bool m_Real_Running;
+
+		// Preview controller of the cart-table model, state (pos, vel, acc)
+		FixedMatrix<3, 3> m_A;
+		FixedMatrix<3, 1> m_B;
+		FixedMatrix<1, 3> m_C;
+		double m_Gi;				// gain on the summed ZMP error
+		FixedMatrix<1, 3> m_Gx;		// state feedback
+		double m_Gp[MAX_PREVIEW];	// gains on the future ZMP reference
+		int m_PreviewCount;
+		double m_Gain_TimeUnit;		// settings the gains were built for
+		double m_Gain_ComHeight;
+		double m_Gain_PreviewTime;
+		double m_Gain_ZmpWeight;
+
+		FixedMatrix<3, 1> m_ComX;
+		FixedMatrix<3, 1> m_ComY;
+		double m_ErrorSumX;
+		double m_ErrorSumY;
+		double m_RefX[MAX_PREVIEW + 1];	// ZMP reference, [0] is this tick
+		double m_RefY[MAX_PREVIEW + 1];
+
+		// Footsteps, [0] is the step being made
+		Footstep m_Step[MAX_FOOTSTEPS];
+		int m_StepCount;
+		double m_StepTime;			// msec into m_Step[0]
+		double m_Foot_X[2];			// feet on the ground
+		double m_Foot_Y[2];
+		double m_Foot_A[2];
+		double m_ZMP_X;				// ZMP reference when m_Step[0] started
+		double m_ZMP_Y;
+		double m_Body_X;			// pose the feet were placed around when standing
+		double m_Body_Y;
+		double m_Body_A;
+
+		double m_Endpoint[12];
+		unsigned int m_IKFailCount;
+
+		void update_command();
+		void update_gain();
+		void plan_steps();
+		void update_reference();
+		void control(FixedMatrix<3, 1> *com, double *error_sum, const double *ref);
+		void update_joints();
+
+	public:
+		// Walking initial pose, as Walking
+		double X_OFFSET;
+		double Y_OFFSET;
+		double Z_OFFSET;
+		double A_OFFSET;
+		double P_OFFSET;
+		double R_OFFSET;
+		double HIP_PITCH_OFFSET;
+
+		// Walking control
+		double PERIOD_TIME;			// msec, two steps
+		double DSP_RATIO;
+		double Z_MOVE_AMPLITUDE;	// foot height (mm)
+		double X_MOVE_ACCEL;		// largest change of the step velocity per step
+		double Y_MOVE_ACCEL;
+		double A_MOVE_ACCEL;
+
+		// Preview control
+		double COM_HEIGHT;			// mm above the soles
+		double PREVIEW_TIME;		// msec, at most MAX_PREVIEW ticks
+		double ZMP_WEIGHT;			// error cost against the jerk cost of 1e-6
+
+		PreviewWalking();
+		virtual ~PreviewWalking();
+
+		static PreviewWalking* GetInstance() { return m_UniqueInstance; }
+
+		void Initialize();
+		// Start() and Stop() are posted like SetVelocity(); IsRunning() turns
+		// true on the next Process() and false once the robot stands again
+		void Start();
+		void Stop();
+		void Process();
+		bool IsRunning();
+		bool IsActive()			{ return m_Real_Running; }	// keeps the legs only while it walks
+
+		// Thread safe, the step size in mm and degree per step like Walking's
+		// X/Y/A_MOVE_AMPLITUDE; steps after the next one are replanned with
+		// it. A sideways or turning step moves the foot on that side twice as
+		// far and the other one not at all.
+		void SetVelocity(double x, double y, double a);
+
+		// State of the last Process()
+		int GetStepCount()					{ return m_StepCount; }
+		const Footstep& GetStep(int index)	{ return m_Step[index]; }
+		double GetComX()					{ return m_ComX(0, 0); }
+		double GetComY()					{ return m_ComY(0, 0); }
+		double GetZmpX()					{ return (m_C * m_ComX)(0, 0); }	// of the model
+		double GetZmpY()					{ return (m_C * m_ComY)(0, 0); }
+		double GetZmpRefX()					{ return m_RefX[0]; }
+		double GetZmpRefY()					{ return m_RefY[0]; }
+		double GetEndpoint(int index)		{ return m_Endpoint[index]; }	// as Walking::GetEndpoint()
+		unsigned int GetIKFailCount()		{ return m_IKFailCount; }
+
+		void LoadINISettings(minIni* ini);
+		void LoadINISettings(minIni* ini, const std::string &section);
+		void SaveINISettings(minIni* ini);
+		void SaveINISettings(minIni* ini, const std::string &section);
+	};
+}
+
+#endif
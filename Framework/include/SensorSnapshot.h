@@ -0,0 +1,87 @@
+/*
+ *   SensorSnapshot.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _SENSOR_SNAPSHOT_H_
+#define _SENSOR_SNAPSHOT_H_
+
+#include "JointData.h"
+
+namespace Robot
+{
+    /*
+     * Decoded readings of one bulk read, one array per quantity.
+     * A value keeps its last reading when its range was not read this tick;
+     * the error arrays tell what answered this tick (-1: no reply).
+     */
+    class SensorFrame
+    {
+    public:
+        enum
+        {
+            GYRO_Z, GYRO_Y, GYRO_X,
+            ACCEL_X = 0, ACCEL_Y, ACCEL_Z,
+            NUMBER_OF_AXIS = 3
+        };
+
+        enum
+        {
+            FSR_LEFT,
+            FSR_RIGHT,
+            NUMBER_OF_FSR
+        };
+
+        unsigned int tick;
+
+        int joint_error[JointData::NUMBER_OF_JOINTS];
+        int position[JointData::NUMBER_OF_JOINTS];
+        int speed[JointData::NUMBER_OF_JOINTS];
+        int load[JointData::NUMBER_OF_JOINTS];
+        int voltage[JointData::NUMBER_OF_JOINTS];
+        int temperature[JointData::NUMBER_OF_JOINTS];
+
+        int cm_error;
+        int gyro[NUMBER_OF_AXIS];
+        int accel[NUMBER_OF_AXIS];
+        int button;
+        int cm_voltage;
+
+        int fsr_error[NUMBER_OF_FSR];
+        int fsr[NUMBER_OF_FSR][4];
+        int fsr_x[NUMBER_OF_FSR];
+        int fsr_y[NUMBER_OF_FSR];
+
+        SensorFrame();
+    };
+
+    /*
+     * Two SensorFrames, written by the bus thread and read by anyone.
+     * The writer fills the back frame and publishes it by bumping a sequence
+     * number; a reader copies the front frame and retries if the sequence
+     * moved meanwhile, so neither side ever waits on a lock.
+     */
+    class SensorSnapshot
+    {
+    private:
+        SensorFrame m_Frame[2];
+        volatile unsigned int m_Sequence;
+        SensorFrame *m_Back;
+
+    public:
+        SensorSnapshot();
+
+        // Writer side (bus thread only)
+        void BeginWrite();
+        void Decode(int id, int address, const unsigned char *data, int length, int error);
+        void EndWrite();
+
+        // Reader side (any thread): copy of the last complete tick
+        void Read(SensorFrame *frame);
+        unsigned int GetTick() { return m_Sequence; }
+    };
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ *   SeqLock.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _SEQ_LOCK_H_
+#define _SEQ_LOCK_H_
+
+namespace Robot
+{
+    /*
+     * One value shared between threads without a mutex.
+     * Writers claim the value by making the sequence odd and publish it by
+     * making it even again; concurrent writers wait for each other. A reader
+     * copies the value and keeps the copy only if the sequence did not move,
+     * so TryRead() never waits: the motion thread keeps its last command when
+     * an application thread is in the middle of writing.
+     * T must be a plain struct.
+     */
+    template <class T>
+    class SeqLock
+    {
+    private:
+        volatile unsigned int m_Sequence;
+        T m_Value;
+
+    public:
+        SeqLock() : m_Sequence(0), m_Value() {}
+
+        // Writer side: modify the value in place between the two calls
+        T* BeginWrite()
+        {
+            unsigned int seq;
+            do {
+                seq = m_Sequence;
+            } while((seq & 1) != 0 || __sync_bool_compare_and_swap(&m_Sequence, seq, seq + 1) == false);
+            __sync_synchronize();
+            return &m_Value;
+        }
+
+        void EndWrite()
+        {
+            __sync_synchronize();
+            m_Sequence++;
+        }
+
+        void Write(const T &value)
+        {
+            *BeginWrite() = value;
+            EndWrite();
+        }
+
+        // Reader side: false if a write was in progress, 'value' is then undefined
+        bool TryRead(T *value, unsigned int *sequence = 0)
+        {
+            unsigned int seq = m_Sequence;
+            if((seq & 1) != 0)
+                return false;
+
+            __sync_synchronize();
+            *value = m_Value;
+            __sync_synchronize();
+            if(seq != m_Sequence)
+                return false;
+
+            if(sequence != 0)
+                *sequence = seq;
+            return true;
+        }
+
+        void Read(T *value)
+        {
+            while(TryRead(value) == false)
+                ;
+        }
+
+        // Even number that grows by 2 with each completed write
+        unsigned int GetSequence() { return m_Sequence; }
+    };
+}
+
+#endif
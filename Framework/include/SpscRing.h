@@ -0,0 +1,97 @@
+/*
+ *   SpscRing.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+namespace Robot
+{
+    /*
+     * Fixed size ring for one producer thread and one consumer thread.
+     * Each side only moves its own index, so neither takes a lock or waits.
+     * The producer fills a slot in place between BeginPush() and EndPush().
+     * A full ring drops the new element and counts it, so the producer's cost
+     * stays bounded however slow the consumer is.
+     * SIZE must be a power of two, T a plain struct.
+     */
+    template <class T, int SIZE>
+    class SpscRing
+    {
+    private:
+        volatile unsigned int m_Head;       // next slot to read, moved by the consumer
+        volatile unsigned int m_Tail;       // next slot to write, moved by the producer
+        volatile unsigned int m_Dropped;
+        T m_Buffer[SIZE];
+
+    public:
+        SpscRing() : m_Head(0), m_Tail(0), m_Dropped(0) {}
+
+        // Producer side: 0 when the ring is full
+        T* BeginPush()
+        {
+            if(m_Tail - m_Head >= (unsigned int)SIZE)
+            {
+                m_Dropped++;
+                return 0;
+            }
+            return &m_Buffer[m_Tail & (SIZE - 1)];
+        }
+
+        void EndPush()
+        {
+            __sync_synchronize();
+            m_Tail++;
+        }
+
+        bool Push(const T &value)
+        {
+            T *slot = BeginPush();
+            if(slot == 0)
+                return false;
+            *slot = value;
+            EndPush();
+            return true;
+        }
+
+        // Consumer side: contiguous elements ready to read, Release() them once used
+        int Peek(T **ptr)
+        {
+            unsigned int tail = m_Tail;
+            __sync_synchronize();
+
+            int count = (int)(tail - m_Head);
+            int linear = SIZE - (int)(m_Head & (SIZE - 1));
+
+            *ptr = &m_Buffer[m_Head & (SIZE - 1)];
+            return (count < linear) ? count : linear;
+        }
+
+        void Release(int count)
+        {
+            __sync_synchronize();
+            m_Head += count;
+        }
+
+        bool Pop(T *value)
+        {
+            T *ptr;
+            if(Peek(&ptr) == 0)
+                return false;
+            *value = *ptr;
+            Release(1);
+            return true;
+        }
+
+        // Consumer side: drop everything pushed so far
+        void Clear()        { m_Head = m_Tail; }
+
+        int GetCount()              { return (int)(m_Tail - m_Head); }
+        unsigned int GetDropped()   { return m_Dropped; }
+    };
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ *   Telemetry.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include "JointData.h"
+#include "SpscRing.h"
+
+#define TELEMETRY_MAGIC     "DLOG"
+
+namespace Robot
+{
+    enum
+    {
+        TELEMETRY_VERSION   = 1,
+        TELEMETRY_RING_SIZE = 4096     // records, about 30 sec at 8 msec
+    };
+
+    /*
+     * Log file layout: one TelemetryHeader, then TelemetryRecords back to back
+     * from header_size on, in host byte order. Every field sits at its natural
+     * alignment, so the file can be mapped and read as an array of records.
+     */
+    struct TelemetryHeader
+    {
+        char magic[4];                  // TELEMETRY_MAGIC
+        unsigned int version;           // TELEMETRY_VERSION
+        unsigned int header_size;
+        unsigned int record_size;
+        unsigned int number_of_joints;
+        float time_unit;                // msec
+        unsigned int record_count;      // written on close, 0 if the log was not closed
+        unsigned int dropped;           // records lost to a full ring
+    };
+
+    // One motion tick, filled by MotionManager::Process()
+    struct TelemetryRecord
+    {
+        double time;                    // msec since StartLogging()
+        float process_time;             // msec spent in Process()
+        unsigned int tick;              // sensor frame tick
+        short goal_position[JointData::NUMBER_OF_JOINTS];
+        short present_position[JointData::NUMBER_OF_JOINTS];
+        short gyro[3];                  // SensorFrame axis order
+        short accel[3];
+        short fsr_x[2];                 // left, right
+        short fsr_y[2];
+        unsigned short write_bytes;     // joint SyncWrite bytes
+        short cm_error;
+        short reserved[2];
+    };
+
+    typedef SpscRing<TelemetryRecord, TELEMETRY_RING_SIZE> TelemetryRing;
+}
+
+#endif
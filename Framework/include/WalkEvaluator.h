@@ -0,0 +1,80 @@
+/*
+ *   WalkEvaluator.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _WALK_EVALUATOR_H_
+#define _WALK_EVALUATOR_H_
+
+#include "MotionStatus.h"
+#include "Walking.h"
+
+namespace Robot
+{
+	// The Walking settings a gait candidate varies, named as in Walking
+	struct WalkParameters
+	{
+		double X_OFFSET;
+		double Y_OFFSET;
+		double Z_OFFSET;
+		double A_OFFSET;
+		double P_OFFSET;
+		double R_OFFSET;
+		double PERIOD_TIME;
+		double DSP_RATIO;
+		double STEP_FB_RATIO;
+		double X_MOVE_AMPLITUDE;
+		double Y_MOVE_AMPLITUDE;
+		double Z_MOVE_AMPLITUDE;
+		double A_MOVE_AMPLITUDE;
+		bool A_MOVE_AIM_ON;
+		double Y_SWAP_AMPLITUDE;
+		double Z_SWAP_AMPLITUDE;
+		double ARM_SWING_GAIN;
+		double PELVIS_OFFSET;
+		double HIP_PITCH_OFFSET;
+
+		void Get(Walking *walking);		// e.g. from Walking::GetInstance() after LoadINISettings()
+		void Set(Walking *walking) const;
+	};
+
+	struct WalkCandidate
+	{
+		WalkParameters param;	// in
+		int cycles;				// in, gait periods to walk from standing
+		int *trajectory;		// out, may be 0: ticks * NUMBER_OF_JOINTS servo values, see GetTicks()
+		int ticks;				// out
+		int ik_failures;		// out, ticks a foot endpoint was out of reach
+		double reach_margin;	// out (mm), smallest Kinematics::LegReachMargin() of both legs
+	};
+
+	/*
+	 * Runs Walking without a robot: Walking::Process() and the leg IK tick
+	 * after tick on a private MotionStatus, nothing is read from or written
+	 * to a CM730. One evaluator is not thread safe, but several can run in
+	 * different threads, see LinuxWalkEvaluator.
+	 */
+	class WalkEvaluator
+	{
+	private:
+		MotionStatus m_Status;
+		Walking *m_Walking;
+		double m_TimeUnit;
+
+		WalkEvaluator(const WalkEvaluator &);
+		WalkEvaluator &operator=(const WalkEvaluator &);
+
+	public:
+		WalkEvaluator(double time_unit = MotionModule::TIME_UNIT);
+		~WalkEvaluator();
+
+		// Process() calls for 'cycles' periods of 'param'
+		int GetTicks(const WalkParameters &param, int cycles);
+
+		void Evaluate(WalkCandidate *candidate);
+	};
+}
+
+#endif
@@ -12,6 +12,7 @@
 
 #include "minIni.h"
 #include "MotionModule.h"
+#include "SeqLock.h"
 
 #define WALKING_SECTION "Walking Config"
 #define INVALID_VALUE   -1024.0
@@ -30,8 +31,30 @@ namespace Robot
 		};
 
 	private:
+		// Posted by application threads, taken by Process() on the motion thread
+		struct Command
+		{
+			unsigned int move_count;	// bumped when the amplitudes below change
+			double x_move;
+			double y_move;
+			double a_move;
+			unsigned int aim_count;		// bumped when a_move_aim_on changes
+			bool a_move_aim_on;
+			bool velocity;				// x/y/a_move are SetVelocity() targets
+			bool running;
+		};
+
 		static Walking* m_UniqueInstance;
 
+		SeqLock<Command> m_Command;
+		unsigned int m_CommandSequence;
+		unsigned int m_MoveCount;
+		unsigned int m_AimCount;
+		bool m_Velocity_On;
+		double m_X_Velocity;
+		double m_Y_Velocity;
+		double m_A_Velocity;
+
 		double m_PeriodTime;
 		double m_DSP_Ratio;
 		double m_SSP_Ratio;
@@ -85,18 +108,58 @@ namespace Robot
 		double m_Hip_Pitch_Offset;
 		double m_Arm_Swing_Gain;
 
+		// Gait coefficients, rebuilt by update_param_time(). Every trajectory
+		// is mag * sin(omega * time - shift) + mag_shift, and the sine at the
+		// phase boundaries where a foot holds still is kept in a hold table.
+		struct Wave
+		{
+			double omega;	// 2 * pi / period
+			double shift;
+		};
+
+		enum
+		{
+			HOLD_START_L,	// m_SSP_Time_Start_L ...
+			HOLD_END_L,
+			HOLD_START_R,
+			HOLD_END_R,
+			NUMBER_OF_HOLDS
+		};
+
+		Wave m_X_Swap_Wave;
+		Wave m_Y_Swap_Wave;
+		Wave m_Z_Swap_Wave;
+		Wave m_X_Move_Wave_L;
+		Wave m_X_Move_Wave_R;
+		Wave m_Y_Move_Wave_L;
+		Wave m_Y_Move_Wave_R;
+		Wave m_Z_Move_Wave_L;
+		Wave m_Z_Move_Wave_R;
+		Wave m_A_Move_Wave_L;
+		Wave m_A_Move_Wave_R;
+		Wave m_Arm_Swing_Wave;
+		double m_X_Move_Hold[NUMBER_OF_HOLDS];
+		double m_Y_Move_Hold[NUMBER_OF_HOLDS];
+		double m_Z_Move_Hold[NUMBER_OF_HOLDS];
+		double m_A_Move_Hold[NUMBER_OF_HOLDS];
+		double m_Wave_PeriodTime;	// timing the coefficients were built for
+		double m_Wave_DSP_Ratio;
+
 		bool m_Ctrl_Running;
 		bool m_Real_Running;
 		double m_Time;
+		double m_Endpoint[12];
+		unsigned int m_IKFailCount;
 
 		int    m_Phase;
 		double m_Body_Swing_Y;
 		double m_Body_Swing_Z;
 
-        Walking();
-
-		double wsin(double time, double period, double period_shift, double mag, double mag_shift);
-		bool computeIK(double *out, double x, double y, double z, double a, double b, double c);
+		static double wave_sin(const Wave &wave, double time);
+		void set_wave(Wave *wave, double period, double shift);
+		void set_hold(double *hold, const Wave &wave_l, const Wave &wave_r);
+		void update_command();
+		void update_velocity();
 		void update_param_time();
 		void update_param_move();
 		void update_param_balance();
@@ -119,6 +182,11 @@ namespace Robot
 		double Z_MOVE_AMPLITUDE;
 		double A_MOVE_AMPLITUDE;
 		bool A_MOVE_AIM_ON;
+		// Largest change of X/Y/A_MOVE_AMPLITUDE from one step to the next
+		// while following SetVelocity()
+		double X_MOVE_ACCEL;
+		double Y_MOVE_ACCEL;
+		double A_MOVE_ACCEL;
 
 		// Balance control
 		bool   BALANCE_ENABLE;
@@ -139,17 +207,39 @@ namespace Robot
 		int GetCurrentPhase()		{ return m_Phase; }
 		double GetBodySwingY()		{ return m_Body_Swing_Y; }
 		double GetBodySwingZ()		{ return m_Body_Swing_Z; }
-
+		// Foot endpoints of the last Process(): right x, y, z, roll, pitch,
+		// yaw, then left (mm, rad)
+		double GetEndpoint(int index)	{ return m_Endpoint[index]; }
+		// Process() calls whose endpoints the leg IK could not reach, the
+		// joints kept their previous values
+		unsigned int GetIKFailCount()	{ return m_IKFailCount; }
+
+		Walking();
 		virtual ~Walking();
 
 		static Walking* GetInstance() { return m_UniqueInstance; }
 
 		void Initialize();
+		// Start() and Stop() are posted like SetVelocity(); IsRunning() turns
+		// true on the next Process() and false once the robot stands again
 		void Start();
 		void Stop();
 		void Process();
 		bool IsRunning();
 
+		// Thread safe walking commands, applied at the start of the next tick.
+		// Writing X/Y/A_MOVE_AMPLITUDE directly still works from the motion thread.
+		void SetMoveAmplitude(double x, double y, double a);
+		void SetMoveAimOn(bool aim_on);
+		// The last values posted above, for callers that change them in steps
+		void GetMoveAmplitude(double *x, double *y, double *a);
+		bool GetMoveAimOn();
+		// Walking speed as the move amplitudes (mm and degree per step). They
+		// follow it every tick within the X/Y/A_MOVE_ACCEL limits instead of
+		// jumping at the next half period. Stop() still ends the walk within
+		// a step. SetMoveAmplitude() turns this off.
+		void SetVelocity(double x, double y, double a);
+
         void LoadINISettings(minIni* ini);
         void LoadINISettings(minIni* ini, const std::string &section);
         void SaveINISettings(minIni* ini);
@@ -0,0 +1,157 @@
+/*
+ *   BusStatistics.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+#include "CM730.h"
+#include "BusStatistics.h"
+
+using namespace Robot;
+
+
+BusCounter::BusCounter()
+{
+    Clear();
+}
+
+void BusCounter::Clear()
+{
+    packets = 0;
+    tx_fail = 0;
+    rx_timeout = 0;
+    rx_corrupt = 0;
+    tx_bytes = 0;
+    rx_bytes = 0;
+    for(int i = 0; i < NUMBER_OF_LATENCY_BIN; i++)
+        latency[i] = 0;
+}
+
+int BusStatistics::GetInstructionIndex(int instruction)
+{
+    switch(instruction)
+    {
+    case 1:     return STAT_PING;
+    case 2:     return STAT_READ;
+    case 3:     return STAT_WRITE;
+    case 4:     return STAT_REG_WRITE;
+    case 5:     return STAT_ACTION;
+    case 6:     return STAT_RESET;
+    case 131:   return STAT_SYNC_WRITE;
+    case 146:   return STAT_BULK_READ;
+    }
+
+    return STAT_OTHER;
+}
+
+const char* BusStatistics::GetInstructionName(int index)
+{
+    switch(index)
+    {
+    case STAT_PING:         return "PING";
+    case STAT_READ:         return "READ";
+    case STAT_WRITE:        return "WRITE";
+    case STAT_REG_WRITE:    return "REG_WRITE";
+    case STAT_ACTION:       return "ACTION";
+    case STAT_RESET:        return "RESET";
+    case STAT_SYNC_WRITE:   return "SYNC_WRITE";
+    case STAT_BULK_READ:    return "BULK_READ";
+    }
+
+    return "OTHER";
+}
+
+void BusStatistics::Add(BusCounter *counter, int result, int tx_bytes, int rx_bytes, double msec)
+{
+    __sync_fetch_and_add(&counter->packets, 1);
+
+    switch(result)
+    {
+    case CM730::TX_FAIL:
+    case CM730::TX_CORRUPT:
+        __sync_fetch_and_add(&counter->tx_fail, 1);
+        break;
+
+    case CM730::RX_TIMEOUT:
+        __sync_fetch_and_add(&counter->rx_timeout, 1);
+        break;
+
+    case CM730::RX_CORRUPT:
+        __sync_fetch_and_add(&counter->rx_corrupt, 1);
+        break;
+    }
+
+    if(tx_bytes > 0)
+        __sync_fetch_and_add(&counter->tx_bytes, tx_bytes);
+    if(rx_bytes > 0)
+        __sync_fetch_and_add(&counter->rx_bytes, rx_bytes);
+
+    if(msec >= 0.0)
+    {
+        int bin = 0;
+        for(double limit = 0.1; msec >= limit && bin < BusCounter::NUMBER_OF_LATENCY_BIN - 1; limit *= 2.0)
+            bin++;
+        __sync_fetch_and_add(&counter->latency[bin], 1);
+    }
+}
+
+void BusStatistics::Copy(BusCounter *dst, BusCounter *src)
+{
+    dst->packets = __sync_fetch_and_add(&src->packets, 0);
+    dst->tx_fail = __sync_fetch_and_add(&src->tx_fail, 0);
+    dst->rx_timeout = __sync_fetch_and_add(&src->rx_timeout, 0);
+    dst->rx_corrupt = __sync_fetch_and_add(&src->rx_corrupt, 0);
+    dst->tx_bytes = __sync_fetch_and_add(&src->tx_bytes, 0);
+    dst->rx_bytes = __sync_fetch_and_add(&src->rx_bytes, 0);
+    for(int i = 0; i < BusCounter::NUMBER_OF_LATENCY_BIN; i++)
+        dst->latency[i] = __sync_fetch_and_add(&src->latency[i], 0);
+}
+
+void BusStatistics::AddPacket(int id, int instruction, int result, int tx_bytes, int rx_bytes, double msec)
+{
+    AddInstruction(instruction, result, tx_bytes, rx_bytes, msec);
+    AddID(id, result, tx_bytes, rx_bytes, msec);
+}
+
+void BusStatistics::AddInstruction(int instruction, int result, int tx_bytes, int rx_bytes, double msec)
+{
+    Add(&m_Instruction[GetInstructionIndex(instruction)], result, tx_bytes, rx_bytes, msec);
+}
+
+void BusStatistics::AddID(int id, int result, int tx_bytes, int rx_bytes, double msec)
+{
+    if(id < 0 || id >= NUMBER_OF_ID)
+        return;
+
+    Add(&m_ID[id], result, tx_bytes, rx_bytes, msec);
+}
+
+void BusStatistics::GetIDSnapshot(int id, BusCounter *snapshot)
+{
+    if(id < 0 || id >= NUMBER_OF_ID)
+    {
+        snapshot->Clear();
+        return;
+    }
+
+    Copy(snapshot, &m_ID[id]);
+}
+
+void BusStatistics::GetInstructionSnapshot(int index, BusCounter *snapshot)
+{
+    if(index < 0 || index >= NUMBER_OF_INSTRUCTION)
+    {
+        snapshot->Clear();
+        return;
+    }
+
+    Copy(snapshot, &m_Instruction[index]);
+}
+
+void BusStatistics::Clear()
+{
+    for(int i = 0; i < NUMBER_OF_ID; i++)
+        m_ID[i].Clear();
+    for(int i = 0; i < NUMBER_OF_INSTRUCTION; i++)
+        m_Instruction[i].Clear();
+}
@@ -5,6 +5,7 @@
  *
  */
 #include <stdio.h>
+#include <string.h>
 #include "FSR.h"
 #include "CM730.h"
 #include "MotionStatus.h"
@@ -32,6 +33,7 @@ using namespace Robot;
 BulkReadData::BulkReadData() :
         start_address(0),
         length(0),
+        read_address(0),
         error(-1)
 {
     for(int i = 0; i < MX28::MAXNUM_ADDRESS; i++)
@@ -58,10 +60,27 @@ int BulkReadData::ReadWord(int address)
 CM730::CM730(PlatformCM730 *platform)
 {
 	m_Platform = platform;
+	m_Protocol = &m_Protocol1;
 	DEBUG_PRINT = false;
     m_BulkReadTxPacket[LENGTH] = 0;
 	for(int i = 0; i < ID_BROADCAST; i++)
 	    m_BulkReadData[i] = BulkReadData();
+
+    for(int i = 0; i < MAXNUM_BULKREAD_RANGE; i++)
+    {
+        m_BulkReadRange[i].length = 0;
+        m_BulkReadDue[i] = false;
+    }
+    m_BulkReadPlanChanged = true;
+    m_BulkReadCount = 0;
+    for(int i = 0; i < 3; i++)
+        m_DeviceBulkReadRange[i] = -1;
+    for(int id = 0; id < JointData::NUMBER_OF_JOINTS; id++)
+        m_JointBulkReadRange[id] = -1;
+    m_BulkReadPending = false;
+    m_BulkReadTxResult = SUCCESS;
+    m_BulkReadTxLength = 0;
+    m_TxLength = 0;
 }
 
 CM730::~CM730()
@@ -73,22 +92,52 @@ int CM730::TxRxPacket(unsigned char *txpacket, unsigned char *rxpacket, int prio
 {
 	if(priority > 1)
 		m_Platform->LowPriorityWait();
-	if(priority > 0)
+	else if(priority > 0)
 		m_Platform->MidPriorityWait();
-	m_Platform->HighPriorityWait();
+	else
+		m_Platform->HighPriorityWait();
+
+	int res = TxPacket(txpacket);
+	if(res == SUCCESS)
+	{
+		res = RxPacket(txpacket, rxpacket);
+		if(res == SUCCESS && (txpacket[ID] != ID_BROADCAST || txpacket[INSTRUCTION] == INST_BULK_READ))
+			m_Platform->PacketReceived();
+	}
+	UpdateStatistics(txpacket, m_TxLength, rxpacket, res, true);
 
-	int res = TX_FAIL;
+	if(DEBUG_PRINT == true)
+		PrintResult(res);
+
+	if(priority > 1)
+		m_Platform->LowPriorityRelease();
+	else if(priority > 0)
+		m_Platform->MidPriorityRelease();
+	else
+		m_Platform->HighPriorityRelease();
+
+	return res;
+}
+
+int CM730::TxPacket(unsigned char *txpacket)
+{
 	int length = txpacket[LENGTH] + 4;
 
 	txpacket[0] = 0xFF;
     txpacket[1] = 0xFF;
 	txpacket[length - 1] = CalculateChecksum(txpacket);
 
+	unsigned char wire[(MAXNUM_TXPARAM + 10) * 2];
+	int wire_length = 0;
+	if(length < (MAXNUM_TXPARAM + 6))
+		wire_length = m_Protocol->Encode(txpacket, wire, sizeof(wire));
+	m_TxLength = wire_length;
+
 	if(DEBUG_PRINT == true)
 	{
 		fprintf(stderr, "\nTX: ");
-		for(int n=0; n<length; n++)
-			fprintf(stderr, "%.2X ", txpacket[n]);
+		for(int n=0; n<wire_length; n++)
+			fprintf(stderr, "%.2X ", wire[n]);
 
 		fprintf(stderr, "INST: ");
 		switch(txpacket[INSTRUCTION])
@@ -131,252 +180,135 @@ int CM730::TxRxPacket(unsigned char *txpacket, unsigned char *rxpacket, int prio
 		}
 	}
 
-	if(length < (MAXNUM_TXPARAM + 6))
+	if(wire_length == 0)
+		return TX_CORRUPT;
+
+	m_Platform->ClearPort();
+	m_RxRing.Reset();
+	m_Protocol->Reset();
+	if(m_Platform->WritePort(wire, wire_length) != wire_length)
+		return TX_FAIL;
+
+	if(txpacket[ID] != ID_BROADCAST)
 	{
-		m_Platform->ClearPort();
-		if(m_Platform->WritePort(txpacket, length) == length)
-		{
-			if (txpacket[ID] != ID_BROADCAST)
-			{
-				int to_length = 0;
-
-				if(txpacket[INSTRUCTION] == INST_READ)
-					to_length = txpacket[PARAMETER+1] + 6;
-				else
-					to_length = 6;
-
-				m_Platform->SetPacketTimeout(length);
-
-				int get_length = 0;
-				if(DEBUG_PRINT == true)
-					fprintf(stderr, "RX: ");
-				
-				while(1)
-				{
-					length = m_Platform->ReadPort(&rxpacket[get_length], to_length - get_length);
-					if(DEBUG_PRINT == true)
-					{
-						for(int n=0; n<length; n++)
-							fprintf(stderr, "%.2X ", rxpacket[get_length + n]);
-					}
-					get_length += length;
-
-					if(get_length == to_length)
-					{
-						// Find packet header
-						int i;
-						for(i = 0; i < (get_length - 1); i++)
-						{
-							if(rxpacket[i] == 0xFF && rxpacket[i+1] == 0xFF)
-								break;
-							else if(i == (get_length - 2) && rxpacket[get_length - 1] == 0xFF)
-								break;
-						}
-
-						if(i == 0)
-						{
-							// Check checksum
-							unsigned char checksum = CalculateChecksum(rxpacket);
-							if(DEBUG_PRINT == true)
-								fprintf(stderr, "CHK:%.2X\n", checksum);
-
-							if(rxpacket[get_length-1] == checksum)
-								res = SUCCESS;
-							else
-								res = RX_CORRUPT;
-							
-							break;
-						}
-						else
-						{
-							for(int j = 0; j < (get_length - i); j++)
-								rxpacket[j] = rxpacket[j+i];
-							get_length -= i;
-						}						
-					}
-					else
-					{
-						if(m_Platform->IsPacketTimeout() == true)
-						{
-							if(get_length == 0)
-								res = RX_TIMEOUT;
-							else
-								res = RX_CORRUPT;
-							
-							break;
-						}
-					}
-				}
-			}
-			else if(txpacket[INSTRUCTION] == INST_BULK_READ)
-			{
-                int to_length = 0;
-                int num = (txpacket[LENGTH]-3) / 3;
+		int num_param = 0;
+		if(txpacket[INSTRUCTION] == INST_READ)
+			num_param = txpacket[PARAMETER+1];
 
-                for(int x = 0; x < num; x++)
-                {
-                    int _id = txpacket[PARAMETER+(3*x)+2];
-                    int _len = txpacket[PARAMETER+(3*x)+1];
-                    int _addr = txpacket[PARAMETER+(3*x)+3];
+		m_Platform->SetPacketTimeout(txpacket[ID], wire_length + m_Protocol->GetStatusLength(num_param));
+	}
+	else if(txpacket[INSTRUCTION] == INST_BULK_READ)
+	{
+        int to_length = 0;
+        int num = (txpacket[LENGTH]-3) / 3;
 
-                    to_length += _len + 6;
-                    m_BulkReadData[_id].length = _len;
-                    m_BulkReadData[_id].start_address = _addr;
-                }
+        for(int x = 0; x < num; x++)
+        {
+            int _id = txpacket[PARAMETER+(3*x)+2];
+            int _len = txpacket[PARAMETER+(3*x)+1];
+            int _addr = txpacket[PARAMETER+(3*x)+3];
 
-                m_Platform->SetPacketTimeout(to_length*1.5);
+            to_length += m_Protocol->GetStatusLength(_len);
+            m_BulkReadData[_id].read_address = _addr;
+            m_BulkReadData[_id].error = -1;
+        }
 
-                int get_length = 0;
-                if(DEBUG_PRINT == true)
-                    fprintf(stderr, "RX: ");
-
-                while(1)
-                {
-                    length = m_Platform->ReadPort(&rxpacket[get_length], to_length - get_length);
-                    if(DEBUG_PRINT == true)
-                    {
-                        for(int n=0; n<length; n++)
-                            fprintf(stderr, "%.2X ", rxpacket[get_length + n]);
-                    }
-                    get_length += length;
-
-                    if(get_length == to_length)
-                    {
-                        res = SUCCESS;
-                        break;
-                    }
-                    else
-                    {
-                        if(m_Platform->IsPacketTimeout() == true)
-                        {
-                            if(get_length == 0)
-                                res = RX_TIMEOUT;
-                            else
-                                res = RX_CORRUPT;
-
-                            break;
-                        }
-                    }
-                }
-
-                for(int x = 0; x < num; x++)
-                {
-                    int _id = txpacket[PARAMETER+(3*x)+2];
-                    m_BulkReadData[_id].error = -1;
-                }
-
-                while(1)
-                {
-                    int i;
-                    for(i = 0; i < get_length - 1; i++)
-                    {
-                        if(rxpacket[i] == 0xFF && rxpacket[i+1] == 0xFF)
-                            break;
-                        else if(i == (get_length - 2) && rxpacket[get_length - 1] == 0xFF)
-                            break;
-                    }
-
-                    if(i == 0)
-                    {
-                        // Check checksum
-                        unsigned char checksum = CalculateChecksum(rxpacket);
-                        if(DEBUG_PRINT == true)
-                            fprintf(stderr, "CHK:%.2X\n", checksum);
-
-                        if(rxpacket[LENGTH+rxpacket[LENGTH]] == checksum)
-                        {
-                            for(int j = 0; j < (rxpacket[LENGTH]-2); j++)
-                                m_BulkReadData[rxpacket[ID]].table[m_BulkReadData[rxpacket[ID]].start_address + j] = rxpacket[PARAMETER + j];
-
-                            m_BulkReadData[rxpacket[ID]].error = (int)rxpacket[ERRBIT];
-
-                            int cur_packet_length = LENGTH + 1 + rxpacket[LENGTH];
-                            to_length = get_length - cur_packet_length;
-                            for(int j = 0; j <= to_length; j++)
-                                rxpacket[j] = rxpacket[j+cur_packet_length];
-
-                            get_length = to_length;
-                            num--;
-                        }
-                        else
-                        {
-                            res = RX_CORRUPT;
-
-                            for(int j = 0; j <= get_length - 2; j++)
-                                rxpacket[j] = rxpacket[j+2];
-
-                            to_length = get_length -= 2;
-                        }
-
-                        if(num == 0)
-                            break;
-                        else if(get_length <= 6)
-                        {
-                            if(num != 0) res = RX_CORRUPT;
-                            break;
-                        }
-
-                    }
-                    else
-                    {
-                        for(int j = 0; j < (get_length - i); j++)
-                            rxpacket[j] = rxpacket[j+i];
-                        get_length -= i;
-                    }
-                }
-			}
-			else
-				res = SUCCESS;			
-		}
-		else
-			res = TX_FAIL;		
+        m_Platform->SetPacketTimeout(ID_BROADCAST, (int)(to_length*1.5));
 	}
-	else
-		res = TX_CORRUPT;
 
-	if(DEBUG_PRINT == true)
+	return SUCCESS;
+}
+
+int CM730::RxPacket(unsigned char *txpacket, unsigned char *rxpacket)
+{
+	if(txpacket[ID] != ID_BROADCAST)
 	{
-		fprintf(stderr, "Time:%.2fms  ", m_Platform->GetPacketTime());
-		fprintf(stderr, "RETURN: ");
-		switch(res)
-		{
-		case SUCCESS:
-			fprintf(stderr, "SUCCESS\n");
-			break;
+		if(DEBUG_PRINT == true)
+			fprintf(stderr, "RX: ");
 
-		case TX_CORRUPT:
-			fprintf(stderr, "TX_CORRUPT\n");
-			break;
+		return RxStatusPacket(txpacket[ID], rxpacket);
+	}
+	else if(txpacket[INSTRUCTION] == INST_BULK_READ)
+	{
+		if(DEBUG_PRINT == true)
+			fprintf(stderr, "RX: ");
 
-		case TX_FAIL:
-			fprintf(stderr, "TX_FAIL\n");
-			break;
+		return RxBulkRead((txpacket[LENGTH]-3) / 3, rxpacket);
+	}
 
-		case RX_FAIL:
-			fprintf(stderr, "RX_FAIL\n");
-			break;
+	return SUCCESS;
+}
 
-		case RX_TIMEOUT:
-			fprintf(stderr, "RX_TIMEOUT\n");
-			break;
+void CM730::PrintResult(int res)
+{
+	fprintf(stderr, "Time:%.2fms  ", m_Platform->GetPacketTime());
+	fprintf(stderr, "RETURN: ");
+	switch(res)
+	{
+	case SUCCESS:
+		fprintf(stderr, "SUCCESS\n");
+		break;
 
-		case RX_CORRUPT:
-			fprintf(stderr, "RX_CORRUPT\n");
-			break;
+	case TX_CORRUPT:
+		fprintf(stderr, "TX_CORRUPT\n");
+		break;
 
-		default:
-			fprintf(stderr, "UNKNOWN\n");
-			break;
-		}
+	case TX_FAIL:
+		fprintf(stderr, "TX_FAIL\n");
+		break;
+
+	case RX_FAIL:
+		fprintf(stderr, "RX_FAIL\n");
+		break;
+
+	case RX_TIMEOUT:
+		fprintf(stderr, "RX_TIMEOUT\n");
+		break;
+
+	case RX_CORRUPT:
+		fprintf(stderr, "RX_CORRUPT\n");
+		break;
+
+	default:
+		fprintf(stderr, "UNKNOWN\n");
+		break;
 	}
+}
 
-	m_Platform->HighPriorityRelease();
-    if(priority > 0)
-        m_Platform->MidPriorityRelease();
-    if(priority > 1)
-        m_Platform->LowPriorityRelease();
+void CM730::UpdateStatistics(unsigned char *txpacket, int tx_bytes, unsigned char *rxpacket, int res, bool timed)
+{
+	double msec = -1.0;
+	if(timed == true && res != TX_FAIL && res != TX_CORRUPT)
+		msec = m_Platform->GetPacketTime();
 
-	return res;
+	if(txpacket[ID] != ID_BROADCAST)
+	{
+		int rx_bytes = (res == SUCCESS) ? m_Protocol->GetStatusLength(rxpacket[LENGTH] - 2) : 0;
+		m_Statistics.AddPacket(txpacket[ID], txpacket[INSTRUCTION], res, tx_bytes, rx_bytes, msec);
+	}
+	else if(txpacket[INSTRUCTION] == INST_BULK_READ && res != TX_FAIL && res != TX_CORRUPT)
+	{
+		int rx_num = 0, rx_param = 0;
+		int num = (txpacket[LENGTH]-3) / 3;
+
+		for(int x = 0; x < num; x++)
+		{
+			int _id = txpacket[PARAMETER+(3*x)+2];
+			int _len = txpacket[PARAMETER+(3*x)+1];
+
+			if(m_BulkReadData[_id].error != -1)
+			{
+				m_Statistics.AddID(_id, SUCCESS, 0, m_Protocol->GetStatusLength(_len), msec);
+				rx_num++;
+				rx_param += _len;
+			}
+			else
+				m_Statistics.AddID(_id, (res == SUCCESS) ? RX_TIMEOUT : res, 0, 0, -1.0);
+		}
+		m_Statistics.AddInstruction(INST_BULK_READ, res, tx_bytes, m_Protocol->GetBulkStatusLength(rx_num, rx_param), msec);
+	}
+	else
+		m_Statistics.AddInstruction(txpacket[INSTRUCTION], res, tx_bytes, 0, -1.0);
 }
 
 unsigned char CM730::CalculateChecksum(unsigned char *packet)
@@ -387,69 +319,343 @@ unsigned char CM730::CalculateChecksum(unsigned char *packet)
 	return (~checksum);
 }
 
-void CM730::MakeBulkReadPacket()
+int CM730::ReadRxRing()
+{
+    unsigned char *ptr;
+    int space = m_RxRing.GetWritable(&ptr);
+    if(space == 0)
+        return 0;
+
+    int length = m_Platform->ReadPort(ptr, space);
+    if(length <= 0)
+        return 0;
+
+    if(DEBUG_PRINT == true)
+    {
+        for(int n=0; n<length; n++)
+            fprintf(stderr, "%.2X ", ptr[n]);
+    }
+
+    m_RxRing.Commit(length);
+    return length;
+}
+
+int CM730::RxStatusPacket(int id, unsigned char *rxpacket)
+{
+    int get_length = 0;
+
+    while(1)
+    {
+        get_length += ReadRxRing();
+
+        int status;
+        while((status = m_Protocol->Parse(&m_RxRing, rxpacket, MAXNUM_RXPARAM + 10)) != DynamixelProtocol::FRAME_INCOMPLETE)
+        {
+            if(status == DynamixelProtocol::FRAME_CORRUPT)
+                return RX_CORRUPT;
+
+            if(rxpacket[ID] == id)
+            {
+                if(DEBUG_PRINT == true)
+                    fprintf(stderr, "CHK:%.2X\n", rxpacket[LENGTH + rxpacket[LENGTH]]);
+                return SUCCESS;
+            }
+        }
+
+        if(m_Platform->IsPacketTimeout() == true)
+        {
+            if(get_length == 0)
+                return RX_TIMEOUT;
+            else
+                return RX_CORRUPT;
+        }
+    }
+}
+
+int CM730::RxBulkRead(int num, unsigned char *rxpacket)
+{
+    int res = SUCCESS;
+    int get_length = 0;
+
+    m_SensorSnapshot.BeginWrite();
+
+    while(num > 0)
+    {
+        get_length += ReadRxRing();
+
+        int status;
+        while(num > 0 && (status = m_Protocol->Parse(&m_RxRing, rxpacket, MAXNUM_RXPARAM + 10)) != DynamixelProtocol::FRAME_INCOMPLETE)
+        {
+            if(status == DynamixelProtocol::FRAME_CORRUPT)
+            {
+                res = RX_CORRUPT;
+                continue;
+            }
+
+            if(DEBUG_PRINT == true)
+                fprintf(stderr, "CHK:%.2X\n", rxpacket[LENGTH + rxpacket[LENGTH]]);
+
+            BulkReadData *data = &m_BulkReadData[rxpacket[ID]];
+            int length = rxpacket[LENGTH] - 2;
+            if(data->read_address + length > MX28::MAXNUM_ADDRESS)
+                length = MX28::MAXNUM_ADDRESS - data->read_address;
+            if(length > 0)
+            {
+                memcpy(&data->table[data->read_address], &rxpacket[PARAMETER], length);
+                m_SensorSnapshot.Decode(rxpacket[ID], data->read_address, &rxpacket[PARAMETER], length, (int)rxpacket[ERRBIT]);
+            }
+            data->error = (int)rxpacket[ERRBIT];
+            num--;
+        }
+
+        if(num > 0 && m_Platform->IsPacketTimeout() == true)
+        {
+            if(get_length == 0)
+                res = RX_TIMEOUT;
+            else
+                res = RX_CORRUPT;
+            break;
+        }
+    }
+
+    m_SensorSnapshot.EndWrite();
+
+    return res;
+}
+
+int CM730::AddBulkReadRange(int id, int start_addr, int length)
 {
+    return AddBulkReadRange(id, start_addr, length, 1);
+}
+
+int CM730::AddBulkReadRange(int id, int start_addr, int length, int period)
+{
+    if(id < 0 || id >= ID_BROADCAST || length <= 0 || start_addr < 0
+        || start_addr + length > MX28::MAXNUM_ADDRESS)
+        return -1;
+
+    if(period < 1)
+        period = 1;
+
+    int handle = -1;
+
+    m_Platform->HighPriorityWait();
+    for(int i = 0; i < MAXNUM_BULKREAD_RANGE; i++)
+    {
+        if(m_BulkReadRange[i].length == 0)
+        {
+            m_BulkReadRange[i].id = id;
+            m_BulkReadRange[i].start_address = start_addr;
+            m_BulkReadRange[i].length = length;
+            m_BulkReadRange[i].period = period;
+            m_BulkReadPlanChanged = true;
+            handle = i;
+            break;
+        }
+    }
+    m_Platform->HighPriorityRelease();
+
+    return handle;
+}
+
+void CM730::RemoveBulkReadRange(int handle)
+{
+    if(handle < 0 || handle >= MAXNUM_BULKREAD_RANGE)
+        return;
+
+    m_Platform->HighPriorityWait();
+    if(m_BulkReadRange[handle].length != 0)
+    {
+        m_BulkReadRange[handle].length = 0;
+        m_BulkReadPlanChanged = true;
+    }
+    m_Platform->HighPriorityRelease();
+}
+
+void CM730::UpdateBulkReadPacket()
+{
+    bool rebuild = m_BulkReadPlanChanged;
+
+    for(int i = 0; i < MAXNUM_BULKREAD_RANGE; i++)
+    {
+        bool due = false;
+        // low rate ranges are staggered by handle so they do not land on the same tick
+        if(m_BulkReadRange[i].length != 0)
+            due = ((m_BulkReadCount + i) % m_BulkReadRange[i].period) == 0;
+
+        if(due != m_BulkReadDue[i])
+        {
+            m_BulkReadDue[i] = due;
+            rebuild = true;
+        }
+    }
+
+    if(rebuild == false)
+        return;
+
+    if(m_BulkReadPlanChanged == true)
+    {
+        // readable window of each ID is the union of everything subscribed
+        for(int id = 0; id < ID_BROADCAST; id++)
+        {
+            m_BulkReadData[id].start_address = 0;
+            m_BulkReadData[id].length = 0;
+        }
+
+        for(int i = 0; i < MAXNUM_BULKREAD_RANGE; i++)
+        {
+            if(m_BulkReadRange[i].length == 0)
+                continue;
+
+            BulkReadData *data = &m_BulkReadData[m_BulkReadRange[i].id];
+            int start = m_BulkReadRange[i].start_address;
+            int end = start + m_BulkReadRange[i].length;
+            if(data->length != 0)
+            {
+                if(data->start_address < start)
+                    start = data->start_address;
+                if(data->start_address + data->length > end)
+                    end = data->start_address + data->length;
+            }
+            data->start_address = start;
+            data->length = end - start;
+        }
+
+        m_BulkReadPlanChanged = false;
+    }
+
     int number = 0;
 
     m_BulkReadTxPacket[ID]              = (unsigned char)ID_BROADCAST;
     m_BulkReadTxPacket[INSTRUCTION]     = INST_BULK_READ;
     m_BulkReadTxPacket[PARAMETER]       = (unsigned char)0x0;
 
-    if(Ping(CM730::ID_CM, 0) == SUCCESS)
+    for(int i = 0; i < MAXNUM_BULKREAD_RANGE; i++)
     {
-        m_BulkReadTxPacket[PARAMETER+3*number+1] = 30;
-        m_BulkReadTxPacket[PARAMETER+3*number+2] = CM730::ID_CM;
-        m_BulkReadTxPacket[PARAMETER+3*number+3] = CM730::P_DXL_POWER;
-        number++;
+        if(m_BulkReadDue[i] == false)
+            continue;
+
+        int id = m_BulkReadRange[i].id;
+        int start = m_BulkReadRange[i].start_address;
+        int end = start + m_BulkReadRange[i].length;
+
+        // one range per ID in a bulk read, merge with an earlier entry
+        int n;
+        for(n = 0; n < number; n++)
+        {
+            if(m_BulkReadTxPacket[PARAMETER+3*n+2] == id)
+                break;
+        }
+
+        if(n < number)
+        {
+            int prev_start = m_BulkReadTxPacket[PARAMETER+3*n+3];
+            int prev_end = prev_start + m_BulkReadTxPacket[PARAMETER+3*n+1];
+            if(prev_start < start)
+                start = prev_start;
+            if(prev_end > end)
+                end = prev_end;
+        }
+        else if(3 * (number + 1) + 1 > MAXNUM_TXPARAM)
+            continue;
+        else
+            number++;
+
+        m_BulkReadTxPacket[PARAMETER+3*n+1] = (unsigned char)(end - start);  // length
+        m_BulkReadTxPacket[PARAMETER+3*n+2] = (unsigned char)id;             // id
+        m_BulkReadTxPacket[PARAMETER+3*n+3] = (unsigned char)start;          // start address
     }
 
-//    for(int id = 1; id < JointData::NUMBER_OF_JOINTS; id++)
-//    {
-//        if(MotionStatus::m_CurrentJoints.GetEnable(id))
-//        {
-//            m_BulkReadTxPacket[PARAMETER+3*number+1] = 2;   // length
-//            m_BulkReadTxPacket[PARAMETER+3*number+2] = id;  // id
-//            m_BulkReadTxPacket[PARAMETER+3*number+3] = MX28::P_PRESENT_POSITION_L; // start address
-//            number++;
-//        }
-//    }
+    m_BulkReadTxPacket[LENGTH]          = (number * 3) + 3;
+}
 
-    if(Ping(FSR::ID_L_FSR, 0) == SUCCESS)
+void CM730::MakeBulkReadPacket()
+{
+    for(int i = 0; i < 3; i++)
     {
-        m_BulkReadTxPacket[PARAMETER+3*number+1] = 10;               // length
-        m_BulkReadTxPacket[PARAMETER+3*number+2] = FSR::ID_L_FSR;   // id
-        m_BulkReadTxPacket[PARAMETER+3*number+3] = FSR::P_FSR1_L;    // start address
-        number++;
+        RemoveBulkReadRange(m_DeviceBulkReadRange[i]);
+        m_DeviceBulkReadRange[i] = -1;
     }
 
+    if(Ping(CM730::ID_CM, 0) == SUCCESS)
+        m_DeviceBulkReadRange[0] = AddBulkReadRange(CM730::ID_CM, CM730::P_DXL_POWER, 30);
+
+    if(Ping(FSR::ID_L_FSR, 0) == SUCCESS)
+        m_DeviceBulkReadRange[1] = AddBulkReadRange(FSR::ID_L_FSR, FSR::P_FSR1_L, 10);
+
     if(Ping(FSR::ID_R_FSR, 0) == SUCCESS)
-    {
-        m_BulkReadTxPacket[PARAMETER+3*number+1] = 10;               // length
-        m_BulkReadTxPacket[PARAMETER+3*number+2] = FSR::ID_R_FSR;   // id
-        m_BulkReadTxPacket[PARAMETER+3*number+3] = FSR::P_FSR1_L;    // start address
-        number++;
-    }
+        m_DeviceBulkReadRange[2] = AddBulkReadRange(FSR::ID_R_FSR, FSR::P_FSR1_L, 10);
 
-    m_BulkReadTxPacket[LENGTH]          = (number * 3) + 3;
+    m_Platform->HighPriorityWait();
+    UpdateBulkReadPacket();
+    m_Platform->HighPriorityRelease();
 }
 
 int CM730::BulkRead()
 {
-    unsigned char rxpacket[MAXNUM_RXPARAM + 10] = {0, };
+    if(m_BulkReadTxPacket[LENGTH] == 0)
+    {
+        MakeBulkReadPacket();
+        return TX_FAIL;
+    }
+
+    BulkReadStart();
+    return CollectBulkRead(true);
+}
 
-    if(m_BulkReadTxPacket[LENGTH] != 0)
-        return TxRxPacket(m_BulkReadTxPacket, rxpacket, 0);
-    else
+int CM730::BulkReadStart()
+{
+    if(m_BulkReadTxPacket[LENGTH] == 0)
     {
         MakeBulkReadPacket();
         return TX_FAIL;
     }
+
+    // the bus stays locked until BulkReadFinish() has collected the replies
+    m_Platform->HighPriorityWait();
+    m_BulkReadCount++;
+    UpdateBulkReadPacket();
+    m_BulkReadTxResult = TxPacket(m_BulkReadTxPacket);
+    m_BulkReadTxLength = m_TxLength;
+    m_BulkReadPending = true;
+
+    return m_BulkReadTxResult;
+}
+
+int CM730::BulkReadFinish()
+{
+    return CollectBulkRead(false);
+}
+
+int CM730::CollectBulkRead(bool timed)
+{
+    unsigned char rxpacket[MAXNUM_RXPARAM + 10];
+
+    if(m_BulkReadPending == false)
+        return TX_FAIL;
+
+    int res = m_BulkReadTxResult;
+    if(res == SUCCESS)
+    {
+        res = RxPacket(m_BulkReadTxPacket, rxpacket);
+        // a deferred collect also counts the caller's work, so it is not a reply time
+        if(res == SUCCESS && timed == true)
+            m_Platform->PacketReceived();
+    }
+    UpdateStatistics(m_BulkReadTxPacket, m_BulkReadTxLength, rxpacket, res, timed);
+
+    if(DEBUG_PRINT == true)
+        PrintResult(res);
+
+    m_BulkReadPending = false;
+    m_Platform->HighPriorityRelease();
+
+    return res;
 }
 
 int CM730::SyncWrite(int start_addr, int each_length, int number, int *pParam)
 {
-	unsigned char txpacket[MAXNUM_TXPARAM + 10] = {0, };
-	unsigned char rxpacket[MAXNUM_RXPARAM + 10] = {0, };
+	unsigned char txpacket[MAXNUM_TXPARAM + 10];
 	int n;
 
     txpacket[ID]                = (unsigned char)ID_BROADCAST;
@@ -460,7 +666,7 @@ int CM730::SyncWrite(int start_addr, int each_length, int number, int *pParam)
         txpacket[PARAMETER + 2 + n]   = (unsigned char)pParam[n];
     txpacket[LENGTH]            = n + 4;
 
-    return TxRxPacket(txpacket, rxpacket, 0);
+    return TxRxPacket(txpacket, 0, 0);
 }
 
 bool CM730::Connect()
@@ -486,15 +692,73 @@ bool CM730::ChangeBaud(int baud)
     return DXLPowerOn();
 }
 
+bool CM730::NegotiateBaud(int baud)
+{
+    int bps = m_Protocol->GetBaudrate(baud);
+    int old_bps = m_Platform->GetBaudrate();
+    int address = m_Protocol->GetBaudRateAddress();
+    int old_baud;
+
+    if(bps == 0 || old_bps == 0)
+        return false;
+
+    if(ReadByte(ID_CM, address, &old_baud, 0) != SUCCESS)
+        return false;
+
+    // The baud rate register is in EEPROM: only move the devices once the
+    // host is known to run at the new rate, or they are lost for good.
+    if(m_Platform->SetBaudrate(bps) == false)
+    {
+        fprintf(stderr, "\n The port does not support %d bps\n", bps);
+        m_Platform->SetBaudrate(old_bps);
+        return false;
+    }
+    if(m_Platform->SetBaudrate(old_bps) == false)
+        return false;
+
+    WriteByte(ID_BROADCAST, address, baud, 0);
+    m_Platform->Sleep(10);
+
+    if(m_Platform->SetBaudrate(bps) == true)
+    {
+        for(int i = 0; i < 3; i++)
+        {
+            if(Ping(ID_CM, 0) == SUCCESS)
+                return true;
+        }
+    }
+
+    fprintf(stderr, "\n Fail to change baudrate to %d bps, restoring %d bps\n", bps, old_bps);
+    WriteByte(ID_BROADCAST, address, old_baud, 0);
+    m_Platform->Sleep(10);
+    m_Platform->SetBaudrate(old_bps);
+    Ping(ID_CM, 0);
+
+    return false;
+}
+
+void CM730::SetProtocol(DynamixelProtocol *protocol)
+{
+    m_Platform->HighPriorityWait();
+    m_Protocol = (protocol != 0) ? protocol : &m_Protocol1;
+    m_Protocol->Reset();
+    m_Platform->HighPriorityRelease();
+}
+
 bool CM730::DXLPowerOn()
 {
+	int power = 0;
+	bool powered = (ReadByte(CM730::ID_CM, CM730::P_DXL_POWER, &power, 0) == CM730::SUCCESS && power == 1);
+
 	if(WriteByte(CM730::ID_CM, CM730::P_DXL_POWER, 1, 0) == CM730::SUCCESS)
 	{
 		if(DEBUG_PRINT == true)
 			fprintf(stderr, " Succeed to change Dynamixel power!\n");
 		
 		WriteWord(CM730::ID_CM, CM730::P_LED_HEAD_L, MakeColor(255, 128, 0), 0);
-		m_Platform->Sleep(300); // about 300msec
+		// servos that were already powered need no time to boot
+		if(powered == false)
+			m_Platform->Sleep(300); // about 300msec
 	}
 	else
 	{
@@ -511,7 +775,8 @@ void CM730::Disconnect()
     // Make the Head LED to green
 	//WriteWord(CM730::ID_CM, CM730::P_LED_HEAD_L, MakeColor(0, 255, 0), 0);
 	unsigned char txpacket[] = {0xFF, 0xFF, 0xC8, 0x05, 0x03, 0x1A, 0xE0, 0x03, 0x32};
-	m_Platform->WritePort(txpacket, 9);
+	unsigned char wire[32];
+	m_Platform->WritePort(wire, m_Protocol->Encode(txpacket, wire, sizeof(wire)));
 
 	m_Platform->ClosePort();
 }
@@ -528,8 +793,8 @@ int CM730::WriteWord(int address, int value, int *error)
 
 int CM730::Ping(int id, int *error)
 {
-	unsigned char txpacket[MAXNUM_TXPARAM + 10] = {0, };
-	unsigned char rxpacket[MAXNUM_RXPARAM + 10] = {0, };
+	unsigned char txpacket[MAXNUM_TXPARAM + 10];
+	unsigned char rxpacket[MAXNUM_RXPARAM + 10];
 	int result;
 
     txpacket[ID]           = (unsigned char)id;
@@ -548,8 +813,8 @@ int CM730::Ping(int id, int *error)
 
 int CM730::ReadByte(int id, int address, int *pValue, int *error)
 {
-	unsigned char txpacket[MAXNUM_TXPARAM + 10] = {0, };
-	unsigned char rxpacket[MAXNUM_RXPARAM + 10] = {0, };
+	unsigned char txpacket[MAXNUM_TXPARAM + 10];
+	unsigned char rxpacket[MAXNUM_RXPARAM + 10];
 	int result;
 
     txpacket[ID]           = (unsigned char)id;
@@ -571,8 +836,8 @@ int CM730::ReadByte(int id, int address, int *pValue, int *error)
 
 int CM730::ReadWord(int id, int address, int *pValue, int *error)
 {
-	unsigned char txpacket[MAXNUM_TXPARAM + 10] = {0, };
-	unsigned char rxpacket[MAXNUM_RXPARAM + 10] = {0, };
+	unsigned char txpacket[MAXNUM_TXPARAM + 10];
+	unsigned char rxpacket[MAXNUM_RXPARAM + 10];
 	int result;
 
     txpacket[ID]           = (unsigned char)id;
@@ -593,10 +858,32 @@ int CM730::ReadWord(int id, int address, int *pValue, int *error)
 	return result;
 }
 
+int CM730::BulkReadOnce(int number, int *id, int start_addr, int length)
+{
+	unsigned char txpacket[MAXNUM_TXPARAM + 10];
+	unsigned char rxpacket[MAXNUM_RXPARAM + 10];
+
+	if(number <= 0 || 3 * number + 1 > MAXNUM_TXPARAM)
+		return TX_CORRUPT;
+
+    txpacket[ID]           = (unsigned char)ID_BROADCAST;
+    txpacket[INSTRUCTION]  = INST_BULK_READ;
+    txpacket[PARAMETER]    = (unsigned char)0x0;
+	for(int n = 0; n < number; n++)
+	{
+		txpacket[PARAMETER+3*n+1] = (unsigned char)length;
+		txpacket[PARAMETER+3*n+2] = (unsigned char)id[n];
+		txpacket[PARAMETER+3*n+3] = (unsigned char)start_addr;
+	}
+    txpacket[LENGTH]       = (number * 3) + 3;
+
+	return TxRxPacket(txpacket, rxpacket, 2);
+}
+
 int CM730::ReadTable(int id, int start_addr, int end_addr, unsigned char *table, int *error)
 {
-	unsigned char txpacket[MAXNUM_TXPARAM + 10] = {0, };
-	unsigned char rxpacket[MAXNUM_RXPARAM + 10] = {0, };
+	unsigned char txpacket[MAXNUM_TXPARAM + 10];
+	unsigned char rxpacket[MAXNUM_RXPARAM + 10];
 	int result;
 	int length = end_addr - start_addr + 1;
 
@@ -621,8 +908,8 @@ int CM730::ReadTable(int id, int start_addr, int end_addr, unsigned char *table,
 
 int CM730::WriteByte(int id, int address, int value, int *error)
 {
-	unsigned char txpacket[MAXNUM_TXPARAM + 10] = {0, };
-	unsigned char rxpacket[MAXNUM_RXPARAM + 10] = {0, };
+	unsigned char txpacket[MAXNUM_TXPARAM + 10];
+	unsigned char rxpacket[MAXNUM_RXPARAM + 10];
 	int result;
 
     txpacket[ID]           = (unsigned char)id;
@@ -643,8 +930,8 @@ int CM730::WriteByte(int id, int address, int value, int *error)
 
 int CM730::WriteWord(int id, int address, int value, int *error)
 {
-	unsigned char txpacket[MAXNUM_TXPARAM + 10] = {0, };
-	unsigned char rxpacket[MAXNUM_RXPARAM + 10] = {0, };
+	unsigned char txpacket[MAXNUM_TXPARAM + 10];
+	unsigned char rxpacket[MAXNUM_RXPARAM + 10];
 	int result;
 
     txpacket[ID]           = (unsigned char)id;
@@ -702,28 +989,23 @@ int CM730::MakeColor(int red, int green, int blue)
 
 void CM730::MakeBulkReadPacketWb()
 {
-		int number = 0;
-
-		m_BulkReadTxPacket[ID] = (unsigned char)ID_BROADCAST;
-		m_BulkReadTxPacket[INSTRUCTION] = INST_BULK_READ;
-		m_BulkReadTxPacket[PARAMETER] = (unsigned char)0x0;
-
-		if(Ping(CM730::ID_CM, 0) == SUCCESS)
+		// the CM730 and the joints, no FSR boards
+		for(int i = 0; i < 3; i++)
 		{
-				m_BulkReadTxPacket[PARAMETER+3*number+1] = 30;
-				m_BulkReadTxPacket[PARAMETER+3*number+2] = CM730::ID_CM;
-				m_BulkReadTxPacket[PARAMETER+3*number+3] = CM730::P_DXL_POWER;
-				number++;
+				RemoveBulkReadRange(m_DeviceBulkReadRange[i]);
+				m_DeviceBulkReadRange[i] = -1;
 		}
 
+		if(Ping(CM730::ID_CM, 0) == SUCCESS)
+				m_DeviceBulkReadRange[0] = AddBulkReadRange(CM730::ID_CM, CM730::P_DXL_POWER, 30);
+
 		for(int id = 1; id < JointData::NUMBER_OF_JOINTS; id++)
 		{
-				m_BulkReadTxPacket[PARAMETER+3*number+1] = 6; // length (goal + speed + torque)
-				m_BulkReadTxPacket[PARAMETER+3*number+2] = id;	// id
-				m_BulkReadTxPacket[PARAMETER+3*number+3] = MX28::P_PRESENT_POSITION_L; // start address
-				number++;
+				RemoveBulkReadRange(m_JointBulkReadRange[id]);
+				m_JointBulkReadRange[id] = AddBulkReadRange(id, MX28::P_PRESENT_POSITION_L, 6); // position + speed + load
 		}
 
-		m_BulkReadTxPacket[LENGTH] = (number * 3) + 3;
+		m_Platform->HighPriorityWait();
+		UpdateBulkReadPacket();
+		m_Platform->HighPriorityRelease();
 }
-
@@ -0,0 +1,556 @@
+/*
+ *   DynamixelProtocol.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+#include <string.h>
+#include "DynamixelProtocol.h"
+
+using namespace Robot;
+
+
+#define ID					(2)
+#define LENGTH				(3)
+#define INSTRUCTION			(4)
+#define ERRBIT				(4)
+#define PARAMETER			(5)
+
+#define INST_READ			(2)
+#define INST_WRITE			(3)
+#define INST_REG_WRITE		(4)
+#define INST_RESET			(6)
+#define INST_SYNC_WRITE		(131)   // 0x83
+#define INST_BULK_READ      (146)   // 0x92
+#define INST_FAST_SYNC_READ (138)   // 0x8A, protocol 2.0
+#define INST_FAST_BULK_READ (154)   // 0x9A, protocol 2.0
+#define INST_STATUS         (85)    // 0x55, protocol 2.0
+
+
+//////////////////////////////// Protocol 1.0 ////////////////////////////////
+
+Protocol1::Protocol1()
+{
+    Reset();
+}
+
+void Protocol1::Reset()
+{
+    m_State = WAIT_HEADER1;
+    m_FrameIndex = 0;
+    m_FrameLength = 0;
+    m_Checksum = 0;
+}
+
+int Protocol1::Encode(unsigned char *txpacket, unsigned char *wire, int capacity)
+{
+    int length = txpacket[LENGTH] + 4;
+    if(length > capacity)
+        return 0;
+
+    unsigned char checksum = 0x00;
+    wire[0] = 0xFF;
+    wire[1] = 0xFF;
+    for(int i = ID; i < length - 1; i++)
+    {
+        wire[i] = txpacket[i];
+        checksum += txpacket[i];
+    }
+    wire[length - 1] = ~checksum;
+
+    return length;
+}
+
+int Protocol1::Parse(PacketRing *ring, unsigned char *frame, int capacity)
+{
+    unsigned char data;
+
+    while(ring->Pop(&data) == true)
+    {
+        switch(m_State)
+        {
+        case WAIT_HEADER1:
+            if(data == 0xFF)
+            {
+                ring->BeginFrame();
+                m_State = WAIT_HEADER2;
+            }
+            break;
+
+        case WAIT_HEADER2:
+            if(data == 0xFF)
+                m_State = WAIT_ID;
+            else
+            {
+                ring->EndFrame();
+                m_State = WAIT_HEADER1;
+            }
+            break;
+
+        case WAIT_ID:
+            if(data == 0xFF) // ID 255 is not valid, it is a longer header
+            {
+                ring->SkipFrameByte();
+                break;
+            }
+            frame[0] = 0xFF;
+            frame[1] = 0xFF;
+            frame[ID] = data;
+            m_Checksum = data;
+            m_State = WAIT_LENGTH;
+            break;
+
+        case WAIT_LENGTH:
+            if(data < 2 || data + 4 > capacity)
+            {
+                ring->Resync();
+                m_State = WAIT_HEADER1;
+                return FRAME_CORRUPT;
+            }
+            frame[LENGTH] = data;
+            m_Checksum += data;
+            m_FrameLength = data + 4;
+            m_FrameIndex = LENGTH + 1;
+            m_State = WAIT_BODY;
+            break;
+
+        case WAIT_BODY:
+            frame[m_FrameIndex] = data;
+            if(m_FrameIndex < m_FrameLength - 1)
+            {
+                m_Checksum += data;
+                m_FrameIndex++;
+                break;
+            }
+
+            m_State = WAIT_HEADER1;
+            if(data == (unsigned char)(~m_Checksum))
+            {
+                ring->EndFrame();
+                return FRAME_RECEIVED;
+            }
+
+            // resync from the byte after this header
+            ring->Resync();
+            return FRAME_CORRUPT;
+        }
+    }
+
+    return FRAME_INCOMPLETE;
+}
+
+int Protocol1::GetBaudrate(int baud_number)
+{
+    switch(baud_number)
+    {
+    case 250:   return 2250000;
+    case 251:   return 2500000;
+    case 252:   return 3000000;
+    }
+
+    if(baud_number < 0 || baud_number > 249)
+        return 0;
+
+    return 2000000 / (baud_number + 1);
+}
+
+//////////////////////////////// Protocol 2.0 ////////////////////////////////
+
+Protocol2::Protocol2()
+{
+    FAST_READ = true;
+    m_FastPending = false;
+    m_FastNum = 0;
+    MakeCRCTable();
+    Reset();
+}
+
+void Protocol2::MakeCRCTable()
+{
+    // CRC-16 (polynomial 0x8005, no reflection, initial value 0)
+    for(int i = 0; i < 256; i++)
+    {
+        unsigned short crc = (unsigned short)(i << 8);
+        for(int bit = 0; bit < 8; bit++)
+        {
+            if(crc & 0x8000)
+                crc = (unsigned short)((crc << 1) ^ 0x8005);
+            else
+                crc = (unsigned short)(crc << 1);
+        }
+        m_CRCTable[i] = crc;
+    }
+}
+
+unsigned short Protocol2::UpdateCRC(unsigned short crc, const unsigned char *data, int length)
+{
+    for(int i = 0; i < length; i++)
+        crc = (unsigned short)((crc << 8) ^ m_CRCTable[((crc >> 8) ^ data[i]) & 0xFF]);
+
+    return crc;
+}
+
+int Protocol2::Stuff(const unsigned char *param, int num_param, unsigned char *out, int capacity)
+{
+    int n = 0;
+    int match = 0;
+
+    for(int i = 0; i < num_param; i++)
+    {
+        if(n >= capacity)
+            return -1;
+        out[n++] = param[i];
+
+        if(param[i] == 0xFF)
+            match = (match == 1 || match == 2) ? 2 : 1;
+        else if(param[i] == 0xFD && match == 2)
+        {
+            if(n >= capacity)
+                return -1;
+            out[n++] = 0xFD;
+            match = 0;
+        }
+        else
+            match = 0;
+    }
+
+    return n;
+}
+
+int Protocol2::Encode(unsigned char *txpacket, unsigned char *wire, int capacity)
+{
+    unsigned char param[MAXNUM_BODY];
+    const unsigned char *p = &txpacket[PARAMETER];
+    int num = txpacket[LENGTH] - 2;
+    int inst = txpacket[INSTRUCTION];
+    int n = 0;
+
+    m_FastNum = 0;
+    m_FastPending = false;
+
+    switch(inst)
+    {
+    case INST_READ:
+        param[n++] = p[0];  param[n++] = 0;     // address
+        param[n++] = p[1];  param[n++] = 0;     // length
+        break;
+
+    case INST_WRITE:
+    case INST_REG_WRITE:
+        param[n++] = p[0];  param[n++] = 0;
+        memcpy(&param[n], &p[1], num - 1);
+        n += num - 1;
+        break;
+
+    case INST_RESET:
+        param[n++] = 0xFF;  // everything, as protocol 1.0 does
+        break;
+
+    case INST_SYNC_WRITE:
+        param[n++] = p[0];  param[n++] = 0;
+        param[n++] = p[1];  param[n++] = 0;
+        memcpy(&param[n], &p[2], num - 2);
+        n += num - 2;
+        break;
+
+    case INST_BULK_READ:
+        {
+            bool same = true;   // one address and length for every ID
+            for(int x = 0; x < (num - 1) / 3; x++)
+            {
+                int len = p[1 + 3*x];
+                param[n++] = p[1 + 3*x + 1];                // id
+                param[n++] = p[1 + 3*x + 2];  param[n++] = 0;  // address
+                param[n++] = (unsigned char)len;  param[n++] = 0;
+
+                if(len != p[1] || p[1 + 3*x + 2] != p[3])
+                    same = false;
+                if(FAST_READ == true && x < MAXNUM_FAST_ID)
+                    m_FastLength[m_FastNum++] = len;
+            }
+
+            if(FAST_READ == true && same == true && n > 0)
+            {
+                // Fast Sync Read: address and length once, then the IDs.
+                // Its reply has the same layout as a Fast Bulk Read one.
+                int ids = n / 5;
+                n = 0;
+                param[n++] = p[3];  param[n++] = 0;
+                param[n++] = p[1];  param[n++] = 0;
+                for(int x = 0; x < ids; x++)
+                    param[n++] = p[1 + 3*x + 1];
+                inst = INST_FAST_SYNC_READ;
+            }
+            else if(FAST_READ == true)
+                inst = INST_FAST_BULK_READ;
+        }
+        break;
+
+    default:
+        memcpy(param, p, num);
+        n = num;
+        break;
+    }
+
+    if(capacity < 10)
+        return 0;
+
+    int stuffed = Stuff(param, n, &wire[8], capacity - 10);
+    if(stuffed < 0)
+        return 0;
+
+    int length = stuffed + 3;
+    wire[0] = 0xFF;
+    wire[1] = 0xFF;
+    wire[2] = 0xFD;
+    wire[3] = 0x00;
+    wire[4] = txpacket[ID];
+    wire[5] = (unsigned char)(length & 0xFF);
+    wire[6] = (unsigned char)(length >> 8);
+    wire[7] = (unsigned char)inst;
+
+    unsigned short crc = UpdateCRC(0, wire, stuffed + 8);
+    wire[stuffed + 8] = (unsigned char)(crc & 0xFF);
+    wire[stuffed + 9] = (unsigned char)(crc >> 8);
+
+    return stuffed + 10;
+}
+
+int Protocol2::GetBulkStatusLength(int num, int num_param)
+{
+    if(num == 0)
+        return 0;
+
+    // one frame: header, ID, LEN, INST, then error, ID, data and CRC per ID
+    if(FAST_READ == true)
+        return 8 + num * 4 + num_param;
+
+    return num * 11 + num_param;
+}
+
+void Protocol2::Reset()
+{
+    m_State = WAIT_HEADER1;
+    m_ID = 0;
+    m_Length = 0;
+    m_Index = 0;
+    m_CRC = 0;
+    m_BodyLength = 0;
+    m_StuffMatch = 0;
+    m_CRCLow = 0;
+    m_FastPending = false;
+}
+
+int Protocol2::NextFastBlock(unsigned char *frame, int capacity)
+{
+    if(m_FastIndex >= m_FastNum)
+    {
+        m_FastPending = false;
+        return FRAME_INCOMPLETE;
+    }
+
+    int len = m_FastLength[m_FastIndex];
+    int o = m_FastOffset;
+    if(o + 2 + len > m_BodyLength || len + 6 > capacity)
+    {
+        m_FastPending = false;
+        return FRAME_CORRUPT;
+    }
+
+    unsigned char checksum = 0;
+    frame[0] = 0xFF;
+    frame[1] = 0xFF;
+    frame[ID] = m_Body[o + 1];
+    frame[LENGTH] = (unsigned char)(len + 2);
+    frame[ERRBIT] = m_Body[o];
+    memcpy(&frame[PARAMETER], &m_Body[o + 2], len);
+    for(int i = ID; i < PARAMETER + len; i++)
+        checksum += frame[i];
+    frame[PARAMETER + len] = ~checksum;
+
+    // the next block follows this block's own CRC
+    m_FastOffset = o + 2 + len + 2;
+    m_FastIndex++;
+
+    return FRAME_RECEIVED;
+}
+
+int Protocol2::Parse(PacketRing *ring, unsigned char *frame, int capacity)
+{
+    unsigned char data;
+
+    if(m_FastPending == true)
+    {
+        int res = NextFastBlock(frame, capacity);
+        if(res != FRAME_INCOMPLETE)
+            return res;
+    }
+
+    while(ring->Pop(&data) == true)
+    {
+        if(m_State != WAIT_BODY || m_Index < m_Length - 2)
+            m_CRC = UpdateCRC(m_CRC, &data, 1);
+
+        switch(m_State)
+        {
+        case WAIT_HEADER1:
+            if(data == 0xFF)
+            {
+                ring->BeginFrame();
+                m_CRC = UpdateCRC(0, &data, 1);
+                m_State = WAIT_HEADER2;
+            }
+            break;
+
+        case WAIT_HEADER2:
+            if(data == 0xFF)
+                m_State = WAIT_HEADER3;
+            else
+            {
+                ring->EndFrame();
+                m_State = WAIT_HEADER1;
+            }
+            break;
+
+        case WAIT_HEADER3:
+            if(data == 0xFD)
+                m_State = WAIT_RESERVED;
+            else if(data == 0xFF) // longer run of 0xFF, the header starts one byte later
+            {
+                ring->SkipFrameByte();
+                unsigned char header[2] = { 0xFF, 0xFF };
+                m_CRC = UpdateCRC(0, header, 2);
+            }
+            else
+            {
+                ring->EndFrame();
+                m_State = WAIT_HEADER1;
+            }
+            break;
+
+        case WAIT_RESERVED:
+            if(data == 0x00)
+                m_State = WAIT_ID;
+            else
+            {
+                ring->Resync();
+                m_State = WAIT_HEADER1;
+            }
+            break;
+
+        case WAIT_ID:
+            m_ID = data;
+            m_State = WAIT_LENGTH_L;
+            break;
+
+        case WAIT_LENGTH_L:
+            m_Length = data;
+            m_State = WAIT_LENGTH_H;
+            break;
+
+        case WAIT_LENGTH_H:
+            m_Length |= (int)data << 8;
+            if(m_Length < 4 || m_Length > MAXNUM_BODY + 2)
+            {
+                ring->Resync();
+                m_State = WAIT_HEADER1;
+                return FRAME_CORRUPT;
+            }
+            m_Index = 0;
+            m_BodyLength = 0;
+            m_StuffMatch = 0;
+            m_State = WAIT_BODY;
+            break;
+
+        case WAIT_BODY:
+            if(m_Index < m_Length - 2)
+            {
+                m_Index++;
+
+                // drop the 0xFD stuffed after FF FF FD inside the parameters
+                if(m_StuffMatch == 3 && data == 0xFD)
+                {
+                    m_StuffMatch = 0;
+                    break;
+                }
+                if(data == 0xFF)
+                    m_StuffMatch = (m_StuffMatch == 1 || m_StuffMatch == 2) ? 2 : 1;
+                else if(data == 0xFD && m_StuffMatch == 2)
+                    m_StuffMatch = 3;
+                else
+                    m_StuffMatch = 0;
+
+                if(m_BodyLength < MAXNUM_BODY)
+                    m_Body[m_BodyLength++] = data;
+                break;
+            }
+
+            if(m_Index == m_Length - 2)
+            {
+                m_CRCLow = data;
+                m_Index++;
+                break;
+            }
+
+            m_State = WAIT_HEADER1;
+            if(m_CRC != (unsigned short)(m_CRCLow | (data << 8)))
+            {
+                ring->Resync();
+                return FRAME_CORRUPT;
+            }
+            ring->EndFrame();
+
+            // only status packets are answers; anything else is skipped
+            if(m_BodyLength < 2 || m_Body[0] != INST_STATUS)
+                break;
+
+            if(m_FastNum > 0 && m_ID == 0xFE)
+            {
+                m_FastPending = true;
+                m_FastIndex = 0;
+                m_FastOffset = 1;
+                int res = NextFastBlock(frame, capacity);
+                if(res != FRAME_INCOMPLETE)
+                    return res;
+                break;
+            }
+
+            {
+                int num_param = m_BodyLength - 2;
+                if(num_param > 253 || num_param + 6 > capacity)
+                    return FRAME_CORRUPT;
+
+                unsigned char checksum = 0;
+                frame[0] = 0xFF;
+                frame[1] = 0xFF;
+                frame[ID] = (unsigned char)m_ID;
+                frame[LENGTH] = (unsigned char)(num_param + 2);
+                frame[ERRBIT] = m_Body[1];
+                memcpy(&frame[PARAMETER], &m_Body[2], num_param);
+                for(int i = ID; i < PARAMETER + num_param; i++)
+                    checksum += frame[i];
+                frame[PARAMETER + num_param] = ~checksum;
+            }
+            return FRAME_RECEIVED;
+        }
+    }
+
+    return FRAME_INCOMPLETE;
+}
+
+int Protocol2::GetBaudrate(int baud_number)
+{
+    switch(baud_number)
+    {
+    case 0:     return 9600;
+    case 1:     return 57600;
+    case 2:     return 115200;
+    case 3:     return 1000000;
+    case 4:     return 2000000;
+    case 5:     return 3000000;
+    case 6:     return 4000000;
+    case 7:     return 4500000;
+    }
+
+    return 0;
+}
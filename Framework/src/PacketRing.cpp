@@ -0,0 +1,76 @@
+/*
+ *   PacketRing.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+#include "PacketRing.h"
+
+using namespace Robot;
+
+
+PacketRing::PacketRing()
+{
+    Reset();
+}
+
+void PacketRing::Reset()
+{
+    m_Head = 0;
+    m_Tail = 0;
+    m_FrameStart = 0;
+    m_InFrame = false;
+}
+
+int PacketRing::GetWritable(unsigned char **ptr)
+{
+    // everything has been parsed, restart at the beginning of the ring
+    if(m_Head == m_Tail && m_InFrame == false)
+        m_Head = m_Tail = m_FrameStart = 0;
+
+    // bytes of a partially parsed frame are kept so it can be rewound
+    unsigned int keep = (m_InFrame == false) ? m_Head : m_FrameStart;
+    int space = RING_SIZE - (int)(m_Tail - keep);
+    int linear = RING_SIZE - (int)(m_Tail & RING_MASK);
+
+    *ptr = &m_Ring[m_Tail & RING_MASK];
+    return (space < linear) ? space : linear;
+}
+
+void PacketRing::Commit(int length)
+{
+    if(length > 0)
+        m_Tail += length;
+}
+
+bool PacketRing::Pop(unsigned char *data)
+{
+    if(m_Head == m_Tail)
+        return false;
+
+    *data = m_Ring[m_Head & RING_MASK];
+    m_Head++;
+    return true;
+}
+
+void PacketRing::BeginFrame()
+{
+    m_FrameStart = m_Head - 1;
+    m_InFrame = true;
+}
+
+void PacketRing::SkipFrameByte()
+{
+    m_FrameStart++;
+}
+
+void PacketRing::EndFrame()
+{
+    m_InFrame = false;
+}
+
+void PacketRing::Resync()
+{
+    m_Head = m_FrameStart + 1;
+    m_InFrame = false;
+}
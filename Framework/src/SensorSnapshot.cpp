@@ -0,0 +1,149 @@
+/*
+ *   SensorSnapshot.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+#include <string.h>
+#include "FSR.h"
+#include "MX28.h"
+#include "CM730.h"
+#include "SensorSnapshot.h"
+
+using namespace Robot;
+
+
+SensorFrame::SensorFrame()
+{
+    tick = 0;
+
+    for(int id = 0; id < JointData::NUMBER_OF_JOINTS; id++)
+    {
+        joint_error[id] = -1;
+        position[id] = 0;
+        speed[id] = 0;
+        load[id] = 0;
+        voltage[id] = 0;
+        temperature[id] = 0;
+    }
+
+    cm_error = -1;
+    for(int i = 0; i < NUMBER_OF_AXIS; i++)
+    {
+        gyro[i] = 512;
+        accel[i] = 512;
+    }
+    button = 0;
+    cm_voltage = 0;
+
+    for(int i = 0; i < NUMBER_OF_FSR; i++)
+    {
+        fsr_error[i] = -1;
+        for(int j = 0; j < 4; j++)
+            fsr[i][j] = 0;
+        fsr_x[i] = 0;
+        fsr_y[i] = 0;
+    }
+}
+
+SensorSnapshot::SensorSnapshot() :
+        m_Sequence(0)
+{
+    m_Back = &m_Frame[1];
+}
+
+void SensorSnapshot::BeginWrite()
+{
+    // start from the published tick so unread ranges keep their last values
+    *m_Back = m_Frame[m_Sequence & 1];
+    m_Back->tick = m_Sequence + 1;
+
+    for(int id = 0; id < JointData::NUMBER_OF_JOINTS; id++)
+        m_Back->joint_error[id] = -1;
+    m_Back->cm_error = -1;
+    for(int i = 0; i < SensorFrame::NUMBER_OF_FSR; i++)
+        m_Back->fsr_error[i] = -1;
+}
+
+// true if [address, address+size) lies inside the received range
+#define COVERS(address, size)   ((address) >= start && (address) + (size) <= end)
+#define WORD_AT(address)        CM730::MakeWord(data[(address) - start], data[(address) - start + 1])
+#define BYTE_AT(address)        ((int)data[(address) - start])
+
+void SensorSnapshot::Decode(int id, int start, const unsigned char *data, int length, int error)
+{
+    int end = start + length;
+    SensorFrame *f = m_Back;
+
+    if(id > 0 && id < JointData::NUMBER_OF_JOINTS)
+    {
+        f->joint_error[id] = error;
+        if(COVERS(MX28::P_PRESENT_POSITION_L, 2))
+            f->position[id] = WORD_AT(MX28::P_PRESENT_POSITION_L);
+        if(COVERS(MX28::P_PRESENT_SPEED_L, 2))
+            f->speed[id] = WORD_AT(MX28::P_PRESENT_SPEED_L);
+        if(COVERS(MX28::P_PRESENT_LOAD_L, 2))
+            f->load[id] = WORD_AT(MX28::P_PRESENT_LOAD_L);
+        if(COVERS(MX28::P_PRESENT_VOLTAGE, 1))
+            f->voltage[id] = BYTE_AT(MX28::P_PRESENT_VOLTAGE);
+        if(COVERS(MX28::P_PRESENT_TEMPERATURE, 1))
+            f->temperature[id] = BYTE_AT(MX28::P_PRESENT_TEMPERATURE);
+    }
+    else if(id == CM730::ID_CM)
+    {
+        f->cm_error = error;
+        if(COVERS(CM730::P_BUTTON, 1))
+            f->button = BYTE_AT(CM730::P_BUTTON);
+        if(COVERS(CM730::P_GYRO_Z_L, 6))
+        {
+            f->gyro[SensorFrame::GYRO_Z] = WORD_AT(CM730::P_GYRO_Z_L);
+            f->gyro[SensorFrame::GYRO_Y] = WORD_AT(CM730::P_GYRO_Y_L);
+            f->gyro[SensorFrame::GYRO_X] = WORD_AT(CM730::P_GYRO_X_L);
+        }
+        if(COVERS(CM730::P_ACCEL_X_L, 6))
+        {
+            f->accel[SensorFrame::ACCEL_X] = WORD_AT(CM730::P_ACCEL_X_L);
+            f->accel[SensorFrame::ACCEL_Y] = WORD_AT(CM730::P_ACCEL_Y_L);
+            f->accel[SensorFrame::ACCEL_Z] = WORD_AT(CM730::P_ACCEL_Z_L);
+        }
+        if(COVERS(CM730::P_VOLTAGE, 1))
+            f->cm_voltage = BYTE_AT(CM730::P_VOLTAGE);
+    }
+    else if(id == FSR::ID_L_FSR || id == FSR::ID_R_FSR)
+    {
+        int n = (id == FSR::ID_L_FSR) ? SensorFrame::FSR_LEFT : SensorFrame::FSR_RIGHT;
+
+        f->fsr_error[n] = error;
+        if(COVERS(FSR::P_FSR1_L, 8))
+        {
+            f->fsr[n][0] = WORD_AT(FSR::P_FSR1_L);
+            f->fsr[n][1] = WORD_AT(FSR::P_FSR2_L);
+            f->fsr[n][2] = WORD_AT(FSR::P_FSR3_L);
+            f->fsr[n][3] = WORD_AT(FSR::P_FSR4_L);
+        }
+        if(COVERS(FSR::P_FSR_X, 2))
+        {
+            f->fsr_x[n] = BYTE_AT(FSR::P_FSR_X);
+            f->fsr_y[n] = BYTE_AT(FSR::P_FSR_Y);
+        }
+    }
+}
+
+void SensorSnapshot::EndWrite()
+{
+    __sync_synchronize();
+    m_Sequence++;
+    m_Back = &m_Frame[(m_Sequence + 1) & 1];
+}
+
+void SensorSnapshot::Read(SensorFrame *frame)
+{
+    unsigned int seq;
+
+    do {
+        seq = m_Sequence;
+        __sync_synchronize();
+        memcpy(frame, &m_Frame[seq & 1], sizeof(SensorFrame));
+        __sync_synchronize();
+    } while(seq != m_Sequence);
+}
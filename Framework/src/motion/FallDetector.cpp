@@ -0,0 +1,63 @@
+/*
+ *   FallDetector.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include "MotionStatus.h"
+#include "MotionModule.h"
+#include "FallDetector.h"
+
+using namespace Robot;
+
+
+FallDetector::FallDetector() :
+		m_TimeUnit(MotionModule::TIME_UNIT),
+		WINDOW_TIME(240)
+{
+	Reset();
+}
+
+void FallDetector::Reset()
+{
+	m_WindowSize = (int)(WINDOW_TIME / m_TimeUnit + 0.5);
+	if(m_WindowSize < 1)
+		m_WindowSize = 1;
+	else if(m_WindowSize > MAX_WINDOW_SIZE)
+		m_WindowSize = MAX_WINDOW_SIZE;
+
+	for(int i = 0; i < m_WindowSize; i++)
+		m_Window[i] = 512;
+	m_Index = 0;
+	m_Sum = 512 * m_WindowSize;
+}
+
+void FallDetector::SetTimeUnit(double msec)
+{
+	if(msec <= 0)
+		return;
+
+	m_TimeUnit = msec;
+	Reset();
+}
+
+void FallDetector::AddSample(int fb_accel)
+{
+	m_Sum += fb_accel - m_Window[m_Index];
+	m_Window[m_Index] = fb_accel;
+	if(++m_Index >= m_WindowSize)
+		m_Index = 0;
+}
+
+int FallDetector::GetState()
+{
+	int avr = GetAverage();
+
+	if(avr < MotionStatus::FALLEN_F_LIMIT)
+		return FORWARD;
+	else if(avr > MotionStatus::FALLEN_B_LIMIT)
+		return BACKWARD;
+
+	return STANDUP;
+}
@@ -0,0 +1,133 @@
+/*
+ *   GyroCalibration.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <math.h>
+#include "MotionModule.h"
+#include "GyroCalibration.h"
+
+using namespace Robot;
+
+
+GyroCalibration::GyroCalibration() :
+		m_TimeUnit(MotionModule::TIME_UNIT),
+		MARGIN_OF_SD(2.0),
+		BIAS_TRACKING(true),
+		WINDOW_TIME(800),
+		TRACKING_TIME(800),
+		BIAS_TIME(8000)
+{
+	Reset();
+}
+
+void GyroCalibration::SetTimeUnit(double msec)
+{
+	if(msec > 0)
+		m_TimeUnit = msec;
+}
+
+void GyroCalibration::Reset()
+{
+	m_Status = 0;
+	m_Count = 0;
+	for(int i = 0; i < NUMBER_OF_AXIS; i++)
+	{
+		m_Mean[i] = 0;
+		m_M2[i] = 0;
+		m_Center[i] = 512;
+		m_TrackMean[i] = 512;
+		m_TrackVar[i] = 0;
+	}
+}
+
+void GyroCalibration::AddSample(int fb, int rl, int yaw)
+{
+	double sample[NUMBER_OF_AXIS];
+	sample[FB_AXIS] = fb;
+	sample[RL_AXIS] = rl;
+	sample[YAW_AXIS] = yaw;
+
+	if(m_Status != 1)
+	{
+		m_Count++;
+		for(int i = 0; i < NUMBER_OF_AXIS; i++)
+		{
+			double diff = sample[i] - m_Mean[i];
+			m_Mean[i] += diff / m_Count;
+			m_M2[i] += diff * (sample[i] - m_Mean[i]);
+		}
+
+		if(m_Count < WINDOW_TIME / m_TimeUnit)
+			return;
+
+		// the yaw center is taken along, stillness is judged on pitch and roll
+		if(GetDeviation(FB_AXIS) < MARGIN_OF_SD && GetDeviation(RL_AXIS) < MARGIN_OF_SD)
+		{
+			m_Status = 1;
+			for(int i = 0; i < NUMBER_OF_AXIS; i++)
+			{
+				m_Center[i] = m_Mean[i];
+				m_TrackMean[i] = m_Mean[i];
+				m_TrackVar[i] = m_M2[i] / m_Count;
+			}
+		}
+		else
+		{
+			m_Status = -1;
+			for(int i = 0; i < NUMBER_OF_AXIS; i++)
+			{
+				m_Center[i] = 512;
+				m_Mean[i] = 0;
+				m_M2[i] = 0;
+			}
+			m_Count = 0;
+		}
+		return;
+	}
+
+	if(BIAS_TRACKING == false)
+		return;
+
+	// weight of one sample
+	double tracking_rate = m_TimeUnit / TRACKING_TIME;
+	double bias_rate = m_TimeUnit / BIAS_TIME;
+
+	for(int i = 0; i < NUMBER_OF_AXIS; i++)
+	{
+		double diff = sample[i] - m_TrackMean[i];
+		double incr = tracking_rate * diff;
+		m_TrackMean[i] += incr;
+		m_TrackVar[i] = (1.0 - tracking_rate) * (m_TrackVar[i] + diff * incr);
+	}
+
+	if(IsStill() == true)
+	{
+		for(int i = 0; i < NUMBER_OF_AXIS; i++)
+			m_Center[i] += bias_rate * (sample[i] - m_Center[i]);
+	}
+}
+
+double GyroCalibration::GetDeviation(int axis)
+{
+	if(m_Status == 1)
+		return sqrt(m_TrackVar[axis]);
+
+	if(m_Count == 0)
+		return 0;
+	return sqrt(m_M2[axis] / m_Count);
+}
+
+bool GyroCalibration::IsStill()
+{
+	return m_Status == 1
+		&& sqrt(m_TrackVar[FB_AXIS]) < MARGIN_OF_SD
+		&& sqrt(m_TrackVar[RL_AXIS]) < MARGIN_OF_SD;
+}
+
+int GyroCalibration::Correct(int axis, int value)
+{
+	return (int)floor(value - m_Center[axis] + 0.5);
+}
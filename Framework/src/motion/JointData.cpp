@@ -23,6 +23,7 @@ JointData::JointData()
         m_PGain[i] = P_GAIN_DEFAULT;
         m_IGain[i] = I_GAIN_DEFAULT;
         m_DGain[i] = D_GAIN_DEFAULT;
+        m_Changed[i] = CHANGED_ALL;
     }
 }
 
@@ -32,6 +33,8 @@ JointData::~JointData()
 
 void JointData::SetEnable(int id, bool enable)
 {
+    if(enable == true && m_Enable[id] == false)
+        m_Changed[id] = CHANGED_ALL;
     m_Enable[id] = enable;
 }
 
@@ -40,7 +43,7 @@ void JointData::SetEnable(int id, bool enable, bool exclusive)
 #ifndef WEBOTS // Because MotionManager is not included in the lite version of the Framework used in the simulation
     if(enable && exclusive) MotionManager::GetInstance()->SetJointDisable(id);
 #endif
-    m_Enable[id] = enable;
+    SetEnable(id, enable);
 }
 
 void JointData::SetEnableHeadOnly(bool enable)
@@ -166,6 +169,8 @@ void JointData::SetValue(int id, int value)
     else if(value >= MX28::MAX_VALUE)
         value = MX28::MAX_VALUE;
 
+    if(m_Value[id] != value)
+        m_Changed[id] |= CHANGED_VALUE;
     m_Value[id] = value;
     m_Angle[id] = MX28::Value2Angle(value);
 }
@@ -182,8 +187,11 @@ void JointData::SetAngle(int id, double angle)
     else if(angle > MX28::MAX_ANGLE)
         angle = MX28::MAX_ANGLE;
 
+    int value = MX28::Angle2Value(angle);
+    if(m_Value[id] != value)
+        m_Changed[id] |= CHANGED_VALUE;
     m_Angle[id] = angle;
-    m_Value[id] = MX28::Angle2Value(angle);
+    m_Value[id] = value;
 }
 
 double JointData::GetAngle(int id)
@@ -209,6 +217,8 @@ void JointData::SetSlope(int id, int cwSlope, int ccwSlope)
 
 void JointData::SetCWSlope(int id, int cwSlope)
 {
+    if(m_CWSlope[id] != cwSlope)
+        m_Changed[id] |= CHANGED_GAIN;
     m_CWSlope[id] = cwSlope;
 }
 
@@ -219,6 +229,8 @@ int JointData::GetCWSlope(int id)
 
 void JointData::SetCCWSlope(int id, int ccwSlope)
 {
+    if(m_CCWSlope[id] != ccwSlope)
+        m_Changed[id] |= CHANGED_GAIN;
     m_CCWSlope[id] = ccwSlope;
 }
 
@@ -226,3 +238,24 @@ int JointData::GetCCWSlope(int id)
 {
     return m_CCWSlope[id];
 }
+
+void JointData::SetPGain(int id, int pgain)
+{
+    if(m_PGain[id] != pgain)
+        m_Changed[id] |= CHANGED_GAIN;
+    m_PGain[id] = pgain;
+}
+
+void JointData::SetIGain(int id, int igain)
+{
+    if(m_IGain[id] != igain)
+        m_Changed[id] |= CHANGED_GAIN;
+    m_IGain[id] = igain;
+}
+
+void JointData::SetDGain(int id, int dgain)
+{
+    if(m_DGain[id] != dgain)
+        m_Changed[id] |= CHANGED_GAIN;
+    m_DGain[id] = dgain;
+}
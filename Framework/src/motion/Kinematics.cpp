@@ -6,6 +6,7 @@
  */
 
 #include <math.h>
+#include <cmath>
 #include "Kinematics.h"
 
 
@@ -28,3 +29,152 @@ Kinematics::Kinematics()
 Kinematics::~Kinematics()
 {
 }
+
+template<typename T>
+static bool SolveLeg(T *out, T x, T y, T z, T a, T b, T c)
+{
+	const T THIGH_LENGTH = (T)Kinematics::THIGH_LENGTH;
+	const T CALF_LENGTH = (T)Kinematics::CALF_LENGTH;
+	const T ANKLE_LENGTH = (T)Kinematics::ANKLE_LENGTH;
+	const T LEG_LENGTH = (T)Kinematics::LEG_LENGTH;
+
+	T sa = std::sin(a), ca = std::cos(a);
+	T sb = std::sin(b), cb = std::cos(b);
+	T sc = std::sin(c), cc = std::cos(c);
+
+	// foot orientation, Rz(c) * Ry(b) * Rx(a) as Matrix3D::SetTransform()
+	T r00 = cc * cb;
+	T r01 = cc * sb * sa - sc * ca;
+	T r02 = cc * sb * ca + sc * sa;
+	T r10 = sc * cb;
+	T r11 = sc * sb * sa + cc * ca;
+	T r12 = sc * sb * ca - cc * sa;
+	T r21 = cb * sa;
+	T r22 = cb * ca;
+	T px = x;
+	T py = y;
+	T pz = z - LEG_LENGTH;
+
+	// ankle joint seen from the hip
+	T vx = px + r02 * ANKLE_LENGTH;
+	T vy = py + r12 * ANKLE_LENGTH;
+	T vz = pz + r22 * ANKLE_LENGTH;
+
+	// Knee
+	T knee = (vx * vx + vy * vy + vz * vz - THIGH_LENGTH * THIGH_LENGTH - CALF_LENGTH * CALF_LENGTH) / (2 * THIGH_LENGTH * CALF_LENGTH);
+	if(!(knee >= -1 && knee <= 1))
+		return false;
+	T knee_s = std::sqrt(1 - knee * knee);
+	T knee_c = knee;
+	out[3] = std::acos(knee);
+
+	// Ankle roll, from the hip seen in the foot frame
+	T dy = -(r01 * px + r11 * py + r21 * pz);
+	T dz = -(r02 * px + r12 * py + r22 * pz) - ANKLE_LENGTH;
+	T l = std::sqrt(dy * dy + dz * dz);
+	if(!(l > 0))
+		return false;
+	T roll_c = dz / l;
+	if(roll_c > 1)
+		roll_c = 1;
+	else if(roll_c < -1)
+		roll_c = -1;
+	T roll_s = dy / l;
+	out[5] = (dy < 0) ? -std::acos(roll_c) : std::acos(roll_c);
+
+	// hip orientation: foot orientation without the ankle roll. The gait was
+	// tuned on a product that Matrix3D::operator* starts from the identity,
+	// the diagonal keeps that extra 1 so Walking moves exactly as before.
+	T m0 = r00 + 1;
+	T m4 = r10;
+	T m1 = r01 * roll_c - r02 * roll_s;
+	T m5 = r11 * roll_c - r12 * roll_s + 1;
+	T m9 = r21 * roll_c - r22 * roll_s;
+	T m2 = r01 * roll_s + r02 * roll_c;
+	T m6 = r11 * roll_s + r12 * roll_c;
+
+	// Hip yaw
+	T h = std::sqrt(m1 * m1 + m5 * m5);
+	T yaw_s = (h > 0) ? -m1 / h : 0;
+	T yaw_c = (h > 0) ? m5 / h : 1;
+	out[0] = std::atan2(-m1, m5);
+
+	// Hip roll
+	T q = -m1 * yaw_s + m5 * yaw_c;
+	h = std::sqrt(m9 * m9 + q * q);
+	T hip_s = (h > 0) ? m9 / h : 0;
+	T hip_c = (h > 0) ? q / h : 1;
+	out[1] = std::atan2(m9, q);
+
+	// Hip pitch and ankle pitch
+	T theta = std::atan2(m2 * yaw_c + m6 * yaw_s, m0 * yaw_c + m4 * yaw_s);
+	T k = knee_s * CALF_LENGTH;
+	l = -THIGH_LENGTH - knee_c * CALF_LENGTH;
+	T m = yaw_c * vx + yaw_s * vy;
+	T n = hip_c * vz + yaw_s * hip_s * vx - yaw_c * hip_s * vy;
+	T s = (k * n + l * m) / (k * k + l * l);
+	T co = (n - k * s) / l;
+	out[2] = std::atan2(s, co);
+	out[4] = theta - out[3] - out[2];
+
+	return true;
+}
+
+template<typename T>
+static int SolveLegs(const LegIKBatch<T> &batch)
+{
+	int solved = 0;
+	T out[6];
+
+	for(int i = 0; i < batch.number; i++)
+	{
+		bool valid = SolveLeg(out, batch.x[i], batch.y[i], batch.z[i], batch.a[i], batch.b[i], batch.c[i]);
+		if(valid == true)
+		{
+			for(int j = 0; j < 6; j++)
+				batch.angle[j][i] = out[j];
+			solved++;
+		}
+		if(batch.valid != 0)
+			batch.valid[i] = valid;
+	}
+
+	return solved;
+}
+
+bool Kinematics::LegIK(double *out, double x, double y, double z, double a, double b, double c)
+{
+	return SolveLeg<double>(out, x, y, z, a, b, c);
+}
+
+bool Kinematics::LegIK(float *out, float x, float y, float z, float a, float b, float c)
+{
+	return SolveLeg<float>(out, x, y, z, a, b, c);
+}
+
+int Kinematics::LegIK(const LegIKBatch<double> &batch)
+{
+	return SolveLegs<double>(batch);
+}
+
+int Kinematics::LegIK(const LegIKBatch<float> &batch)
+{
+	return SolveLegs<float>(batch);
+}
+
+double Kinematics::LegReachMargin(double x, double y, double z, double a, double b, double c)
+{
+	double sa = sin(a), ca = cos(a);
+	double sb = sin(b), cb = cos(b);
+	double sc = sin(c), cc = cos(c);
+
+	// ankle joint seen from the hip, as SolveLeg()
+	double vx = x + (cc * sb * ca + sc * sa) * ANKLE_LENGTH;
+	double vy = y + (sc * sb * ca - cc * sa) * ANKLE_LENGTH;
+	double vz = z - LEG_LENGTH + cb * ca * ANKLE_LENGTH;
+	double reach = sqrt(vx * vx + vy * vy + vz * vz);
+
+	double stretched = (THIGH_LENGTH + CALF_LENGTH) - reach;
+	double folded = reach - fabs(THIGH_LENGTH - CALF_LENGTH);
+	return (stretched < folded) ? stretched : folded;
+}
@@ -0,0 +1,43 @@
+/*
+ *   MotionContext.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include "MotionContext.h"
+
+using namespace Robot;
+
+
+MotionContext::MotionContext(PlatformCM730 *platform)
+{
+	m_CM730 = new CM730(platform);
+	m_Manager = new MotionManager(&m_Status);
+	m_Walking = new Walking();
+	m_Action = new Action();
+	m_Head = new Head();
+}
+
+MotionContext::~MotionContext()
+{
+	if(m_Manager->GetEnable() == true)
+		m_Manager->SetEnable(false);
+
+	delete m_Head;
+	delete m_Action;
+	delete m_Walking;
+	delete m_Manager;
+	delete m_CM730;
+}
+
+bool MotionContext::Initialize()
+{
+	if(m_Manager->Initialize(m_CM730) == false)
+		return false;
+
+	m_Manager->AddModule((MotionModule*)m_Action);
+	m_Manager->AddModule((MotionModule*)m_Head);
+	m_Manager->AddModule((MotionModule*)m_Walking);
+	return true;
+}
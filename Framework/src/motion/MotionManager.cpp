@@ -7,25 +7,43 @@
 
 #include <stdio.h>
 #include <math.h>
-#include "FSR.h"
+#include <time.h>
 #include "MX28.h"
 #include "MotionManager.h"
 
 using namespace Robot;
 
-MotionManager* MotionManager::m_UniqueInstance = new MotionManager();
+MotionManager* MotionManager::m_UniqueInstance = new MotionManager(MotionStatus::GetDefault());
 
-MotionManager::MotionManager() :
+MotionManager::MotionManager(MotionStatus *status) :
+        m_Status(status),
         m_CM730(0),
         m_ProcessEnable(false),
         m_Enabled(false),
         m_IsRunning(false),
         m_IsThreadRunning(false),
         m_IsLogging(false),
+        m_BusPipelining(true),
+        m_TimeUnit(MotionModule::TIME_UNIT),
+        m_DeltaWrite(true),
+        m_FullWritePeriod(1000),
+        m_FullWriteElapsed(1000),
+        m_WriteBytes(0),
+        m_LogStartTime(0),
         DEBUG_PRINT(false)
 {
     for(int i = 0; i < JointData::NUMBER_OF_JOINTS; i++)
+    {
         m_Offset[i] = 0;
+        m_JointBulkReadRange[i] = -1;
+        m_JointStatusBulkReadRange[i] = -1;
+        m_JointOwner[i] = 0;
+        m_FadeStart[i] = 0;
+        m_FadeElapsed[i] = -1;
+        m_FadeDuration[i] = 0;
+        m_WrittenOffset[i] = 0;
+        m_JointFound[i] = true;
+    }
 }
 
 MotionManager::~MotionManager()
@@ -34,8 +52,6 @@ MotionManager::~MotionManager()
 
 bool MotionManager::Initialize(CM730 *cm730)
 {
-	int value, error;
-
 	m_CM730 = cm730;
 	m_Enabled = false;
 	m_ProcessEnable = true;
@@ -47,31 +63,13 @@ bool MotionManager::Initialize(CM730 *cm730)
 		return false;
 	}
 
-	for(int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++)
-	{
-		if(DEBUG_PRINT == true)
-			fprintf(stderr, "ID:%d initializing...", id);
-		
-		if(m_CM730->ReadWord(id, MX28::P_PRESENT_POSITION_L, &value, &error) == CM730::SUCCESS)
-		{
-			MotionStatus::m_CurrentJoints.SetValue(id, value);
-			MotionStatus::m_CurrentJoints.SetEnable(id, true);
-
-			if(DEBUG_PRINT == true)
-				fprintf(stderr, "[%d] Success\n", value);
-		}
-		else
-		{
-			MotionStatus::m_CurrentJoints.SetEnable(id, false);
-
-			if(DEBUG_PRINT == true)
-				fprintf(stderr, " Fail\n");
-		}
-	}
+	DiscoverJoints();
+	SubscribeJointBulkRead();
+	InvalidateJoints();
 
-	m_CalibrationStatus = 0;
-	m_FBGyroCenter = 512;
-	m_RLGyroCenter = 512;
+	m_GyroCalibration.Reset();
+	m_FallDetector.Reset();
+	m_OrientationFilter.Reset();
 
 	return true;
 }
@@ -82,59 +80,117 @@ bool MotionManager::Reinitialize()
 
 	m_CM730->DXLPowerOn();
 
-	int value, error;
+	DiscoverJoints();
+	SubscribeJointBulkRead();
+
+	m_ProcessEnable = true;
+	return true;
+}
+
+void MotionManager::SetJointFound(int id, int value)
+{
+	m_JointFound[id] = true;
+	m_Status->m_Joints.SetValue(id, value);
+	m_Status->m_Joints.SetEnable(id, true);
+
+	if(DEBUG_PRINT == true)
+		fprintf(stderr, "ID:%d [%d] Success\n", id, value);
+}
+
+void MotionManager::DiscoverJoints()
+{
+	int list[JointData::NUMBER_OF_JOINTS];
+	int number = 0;
+	int probe[JointData::NUMBER_OF_JOINTS];
+	int probe_num = 0;
+
+	// joints found last time are asked in one bulk read, the others one by one
 	for(int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++)
 	{
-		if(DEBUG_PRINT == true)
-			fprintf(stderr, "ID:%d initializing...", id);
-		
-		if(m_CM730->ReadWord(id, MX28::P_PRESENT_POSITION_L, &value, &error) == CM730::SUCCESS)
-		{
-			MotionStatus::m_CurrentJoints.SetValue(id, value);
-			MotionStatus::m_CurrentJoints.SetEnable(id, true);
+		if(m_JointFound[id] == true)
+			list[number++] = id;
+		else
+			probe[probe_num++] = id;
+	}
 
-			if(DEBUG_PRINT == true)
-				fprintf(stderr, "[%d] Success\n", value);
+	int first = 0;
+	while(first < number)
+	{
+		m_CM730->BulkReadOnce(number - first, &list[first], MX28::P_PRESENT_POSITION_L, 2);
+
+		// the replies stop at the first servo that did not answer
+		while(first < number && m_CM730->m_BulkReadData[list[first]].error != -1)
+		{
+			unsigned char *table = m_CM730->m_BulkReadData[list[first]].table;
+			SetJointFound(list[first], CM730::MakeWord(table[MX28::P_PRESENT_POSITION_L], table[MX28::P_PRESENT_POSITION_H]));
+			first++;
 		}
+
+		if(first < number)
+			probe[probe_num++] = list[first++];
+	}
+
+	for(int i = 0; i < probe_num; i++)
+	{
+		int id = probe[i];
+		int value, error;
+
+		if(m_CM730->ReadWord(id, MX28::P_PRESENT_POSITION_L, &value, &error) == CM730::SUCCESS)
+			SetJointFound(id, value);
 		else
 		{
-			MotionStatus::m_CurrentJoints.SetEnable(id, false);
+			m_JointFound[id] = false;
+			m_Status->m_Joints.SetEnable(id, false);
 
 			if(DEBUG_PRINT == true)
-				fprintf(stderr, " Fail\n");
+				fprintf(stderr, "ID:%d Fail\n", id);
 		}
 	}
+}
 
-	m_ProcessEnable = true;
-	return true;
+#define JOINT_STATUS_READ_TIME      1000 // msec, voltage and temperature
+
+// ticks between two reads of the joint status
+static int GetJointStatusReadPeriod(double time_unit)
+{
+	return (int)(JOINT_STATUS_READ_TIME / time_unit + 0.5);
 }
 
-void MotionManager::StartLogging()
+void MotionManager::SubscribeJointBulkRead()
 {
-    char szFile[32] = {0,};
+	for(int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++)
+	{
+		m_CM730->RemoveBulkReadRange(m_JointBulkReadRange[id]);
+		m_CM730->RemoveBulkReadRange(m_JointStatusBulkReadRange[id]);
+		m_JointBulkReadRange[id] = -1;
+		m_JointStatusBulkReadRange[id] = -1;
 
-    int count = 0;
-    while(1)
-    {
-        sprintf(szFile, "Logs/Log%d.csv", count);
-        if(0 != access(szFile, F_OK))
-            break;
-        count++;
-		if(count > 256) return;
-    }
+		if(m_Status->m_Joints.GetEnable(id) == true)
+		{
+			// present position, speed and load every tick
+			m_JointBulkReadRange[id] = m_CM730->AddBulkReadRange(id, MX28::P_PRESENT_POSITION_L, 6);
+			m_JointStatusBulkReadRange[id] = m_CM730->AddBulkReadRange(id, MX28::P_PRESENT_VOLTAGE, 2, GetJointStatusReadPeriod(m_TimeUnit));
+		}
+	}
+}
 
-    m_LogFileStream.open(szFile, std::ios::out);
-    for(int id = 1; id < JointData::NUMBER_OF_JOINTS; id++)
-        m_LogFileStream << "ID_" << id << "_GP,ID_" << id << "_PP,";
-    m_LogFileStream << "GyroFB,GyroRL,AccelFB,AccelRL,L_FSR_X,L_FSR_Y,R_FSR_X,R_FSR_Y" << std::endl;
+// msec, monotonic
+static double GetTime()
+{
+    struct timespec tv;
+    clock_gettime(CLOCK_MONOTONIC, &tv);
+    return (double)tv.tv_sec * 1000.0 + (double)tv.tv_nsec / 1000000.0;
+}
 
+void MotionManager::StartLogging()
+{
+    m_LogStartTime = GetTime();
     m_IsLogging = true;
 }
 
 void MotionManager::StopLogging()
 {
     m_IsLogging = false;
-    m_LogFileStream.close();
 }
 
 void MotionManager::LoadINISettings(minIni* ini)
@@ -166,190 +222,238 @@ void MotionManager::SaveINISettings(minIni* ini, const std::string &section)
     }
 }
 
-#define GYRO_WINDOW_SIZE    100
-#define ACCEL_WINDOW_SIZE   30
-#define MARGIN_OF_SD        2.0
 void MotionManager::Process()
 {
-    if(m_ProcessEnable == false || m_IsRunning == true)
+    // the timer thread and a caller may both get here, only one runs the tick
+    if(m_ProcessEnable == false || __sync_lock_test_and_set(&m_IsRunning, true) == true)
         return;
 
-    m_IsRunning = true;
+    double start_time = 0;
+    if(m_IsLogging == true)
+        start_time = GetTime();
+
+    SensorFrame sensor;
+    m_CM730->GetSensorSnapshot()->Read(&sensor);
+
+    // Send the bulk read request first so the servos answer while the
+    // modules run on the previous tick's readings.
+    if(m_BusPipelining == true)
+        m_CM730->BulkReadStart();
+
+    bool write_joints = false;
+
+    // calibrate gyro sensor, then keep tracking its bias
+    if(sensor.cm_error == 0)
+    {
+        int status = m_GyroCalibration.GetStatus();
+        m_GyroCalibration.AddSample(sensor.gyro[SensorFrame::GYRO_Y], sensor.gyro[SensorFrame::GYRO_X], sensor.gyro[SensorFrame::GYRO_Z]);
+        if(status != 1 && m_GyroCalibration.GetStatus() == 1 && DEBUG_PRINT == true)
+            fprintf(stderr, "FBGyroCenter:%.1f , RLGyroCenter:%.1f \n",
+                    m_GyroCalibration.GetCenter(GyroCalibration::FB_AXIS), m_GyroCalibration.GetCenter(GyroCalibration::RL_AXIS));
+    }
 
-    // calibrate gyro sensor
-    if(m_CalibrationStatus == 0 || m_CalibrationStatus == -1)
+    if(m_GyroCalibration.GetStatus() == 1 && m_Enabled == true)
     {
-        static int fb_gyro_array[GYRO_WINDOW_SIZE] = {512,};
-        static int rl_gyro_array[GYRO_WINDOW_SIZE] = {512,};
-        static int buf_idx = 0;
+        if(sensor.cm_error == 0)
+        {
+            m_Status->m_FBGyro = m_GyroCalibration.Correct(GyroCalibration::FB_AXIS, sensor.gyro[SensorFrame::GYRO_Y]);
+            m_Status->m_RLGyro = m_GyroCalibration.Correct(GyroCalibration::RL_AXIS, sensor.gyro[SensorFrame::GYRO_X]);
+            m_Status->m_RLAccel = sensor.accel[SensorFrame::ACCEL_X];
+            m_Status->m_FBAccel = sensor.accel[SensorFrame::ACCEL_Y];
+            m_FallDetector.AddSample(m_Status->m_FBAccel);
+
+            m_OrientationFilter.Process(m_TimeUnit / 1000.0, m_Status->m_FBGyro, m_Status->m_RLGyro,
+                                        m_GyroCalibration.Correct(GyroCalibration::YAW_AXIS, sensor.gyro[SensorFrame::GYRO_Z]),
+                                        sensor.accel[SensorFrame::ACCEL_Y], sensor.accel[SensorFrame::ACCEL_X], sensor.accel[SensorFrame::ACCEL_Z]);
+            m_Status->m_Pitch = m_OrientationFilter.GetPitch();
+            m_Status->m_Roll = m_OrientationFilter.GetRoll();
+            m_Status->m_YawRate = m_OrientationFilter.GetYawRate();
+        }
 
-        if(buf_idx < GYRO_WINDOW_SIZE)
+        m_Status->m_Fallen = m_FallDetector.GetState();
+        m_Status->m_FallPrediction = m_OrientationFilter.GetFallPrediction();
+
+        if(m_Modules.size() != 0)
         {
-            if(m_CM730->m_BulkReadData[CM730::ID_CM].error == 0)
-            {
-                fb_gyro_array[buf_idx] = m_CM730->m_BulkReadData[CM730::ID_CM].ReadWord(CM730::P_GYRO_Y_L);
-                rl_gyro_array[buf_idx] = m_CM730->m_BulkReadData[CM730::ID_CM].ReadWord(CM730::P_GYRO_X_L);
-                buf_idx++;
-            }
+            for(std::list<MotionModule*>::iterator i = m_Modules.begin(); i != m_Modules.end(); i++)
+                (*i)->Process();
+
+            ArbitrateJoints();
         }
-        else
+
+        if(DEBUG_PRINT == true)
         {
-            double fb_sum = 0.0, rl_sum = 0.0;
-            double fb_sd = 0.0, rl_sd = 0.0;
-            double fb_diff, rl_diff;
-            double fb_mean = 0.0, rl_mean = 0.0;
+            for(int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++)
+                fprintf(stderr, "ID[%d] : %d \n", id, m_Status->m_Joints.GetValue(id));
+        }
 
-            buf_idx = 0;
+        write_joints = true;
+    }
 
-            for(int i = 0; i < GYRO_WINDOW_SIZE; i++)
-            {
-                fb_sum += fb_gyro_array[i];
-                rl_sum += rl_gyro_array[i];
-            }
-            fb_mean = fb_sum / GYRO_WINDOW_SIZE;
-            rl_mean = rl_sum / GYRO_WINDOW_SIZE;
+    if(m_BusPipelining == true)
+        m_CM730->BulkReadFinish();
+
+    m_WriteBytes = 0;
+    if(write_joints == true)
+        WriteJoints();
+
+    if(m_BusPipelining == false)
+        m_CM730->BulkRead();
 
-            fb_sum = 0.0; rl_sum = 0.0;
-            for(int i = 0; i < GYRO_WINDOW_SIZE; i++)
+    m_CM730->GetSensorSnapshot()->Read(&sensor);
+
+    if(m_IsLogging == true && start_time > 0)
+    {
+        TelemetryRecord *record = m_Telemetry.BeginPush();
+        if(record != 0)
+        {
+            double now = GetTime();
+            record->time = start_time - m_LogStartTime;
+            record->process_time = (float)(now - start_time);
+            record->tick = sensor.tick;
+
+            record->goal_position[0] = 0;
+            record->present_position[0] = 0;
+            for(int id = 1; id < JointData::NUMBER_OF_JOINTS; id++)
             {
-                fb_diff = fb_gyro_array[i] - fb_mean;
-                rl_diff = rl_gyro_array[i] - rl_mean;
-                fb_sum += fb_diff * fb_diff;
-                rl_sum += rl_diff * rl_diff;
+                record->goal_position[id] = m_Status->m_Joints.GetValue(id);
+                record->present_position[id] = sensor.position[id];
             }
-            fb_sd = sqrt(fb_sum / GYRO_WINDOW_SIZE);
-            rl_sd = sqrt(rl_sum / GYRO_WINDOW_SIZE);
 
-            if(fb_sd < MARGIN_OF_SD && rl_sd < MARGIN_OF_SD)
+            for(int i = 0; i < SensorFrame::NUMBER_OF_AXIS; i++)
             {
-                m_FBGyroCenter = (int)fb_mean;
-                m_RLGyroCenter = (int)rl_mean;
-                m_CalibrationStatus = 1;
-                if(DEBUG_PRINT == true)
-                    fprintf(stderr, "FBGyroCenter:%d , RLGyroCenter:%d \n", m_FBGyroCenter, m_RLGyroCenter);
+                record->gyro[i] = sensor.gyro[i];
+                record->accel[i] = sensor.accel[i];
             }
-            else
+
+            for(int i = 0; i < SensorFrame::NUMBER_OF_FSR; i++)
             {
-                m_FBGyroCenter = 512;
-                m_RLGyroCenter = 512;
-                m_CalibrationStatus = -1;
+                record->fsr_x[i] = sensor.fsr_x[i];
+                record->fsr_y[i] = sensor.fsr_y[i];
             }
+
+            record->write_bytes = m_WriteBytes;
+            record->cm_error = sensor.cm_error;
+            record->reserved[0] = 0;
+            record->reserved[1] = 0;
+
+            m_Telemetry.EndPush();
         }
     }
 
-    if(m_CalibrationStatus == 1 && m_Enabled == true)
+    if(sensor.cm_error == 0)
+        m_Status->m_Button = sensor.button;
+
+    m_Status->PublishState();
+
+    __sync_lock_release(&m_IsRunning);
+}
+
+void MotionManager::SetEnable(bool enable)
+{
+	m_Enabled = enable;
+	if(m_Enabled == true)
+	{
+		m_CM730->WriteWord(CM730::ID_BROADCAST, MX28::P_MOVING_SPEED_L, 0, 0);
+		InvalidateJoints();
+		m_OrientationFilter.Reset();
+	}
+}
+
+void MotionManager::WriteJoints()
+{
+    JointData *joints = &m_Status->m_Joints;
+    DynamixelProtocol *protocol = m_CM730->GetProtocol();
+    int full_id[JointData::NUMBER_OF_JOINTS], full_num = 0;
+    int goal_id[JointData::NUMBER_OF_JOINTS], goal_num = 0;
+
+    bool refresh = (m_DeltaWrite == false);
+    m_FullWriteElapsed += m_TimeUnit;
+    if(m_FullWriteElapsed >= m_FullWritePeriod)
     {
-        static int fb_array[ACCEL_WINDOW_SIZE] = {512,};
-        static int buf_idx = 0;
-        if(m_CM730->m_BulkReadData[CM730::ID_CM].error == 0)
-        {
-            MotionStatus::FB_GYRO = m_CM730->m_BulkReadData[CM730::ID_CM].ReadWord(CM730::P_GYRO_Y_L) - m_FBGyroCenter;
-            MotionStatus::RL_GYRO = m_CM730->m_BulkReadData[CM730::ID_CM].ReadWord(CM730::P_GYRO_X_L) - m_RLGyroCenter;
-            MotionStatus::RL_ACCEL = m_CM730->m_BulkReadData[CM730::ID_CM].ReadWord(CM730::P_ACCEL_X_L);
-            MotionStatus::FB_ACCEL = m_CM730->m_BulkReadData[CM730::ID_CM].ReadWord(CM730::P_ACCEL_Y_L);
-            fb_array[buf_idx] = MotionStatus::FB_ACCEL;
-            if(++buf_idx >= ACCEL_WINDOW_SIZE) buf_idx = 0;
-        }
+        m_FullWriteElapsed = 0;
+        refresh = true;
+    }
 
-        int sum = 0, avr = 512;
-        for(int idx = 0; idx < ACCEL_WINDOW_SIZE; idx++)
-            sum += fb_array[idx];
-        avr = sum / ACCEL_WINDOW_SIZE;
+    for(int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++)
+    {
+        if(joints->GetEnable(id) == false)
+            continue;
+
+        int changed = joints->GetChanged(id);
+        if(m_Offset[id] != m_WrittenOffset[id])
+            changed |= JointData::CHANGED_VALUE;
+        if(refresh == true)
+            changed = JointData::CHANGED_ALL;
+
+        if(changed & JointData::CHANGED_GAIN)
+            full_id[full_num++] = id;
+        else if(changed & JointData::CHANGED_VALUE)
+            goal_id[goal_num++] = id;
+
+        joints->ClearChanged(id);
+        m_WrittenOffset[id] = m_Offset[id];
+    }
 
-        if(avr < MotionStatus::FALLEN_F_LIMIT)
-            MotionStatus::FALLEN = FORWARD;
-        else if(avr > MotionStatus::FALLEN_B_LIMIT)
-            MotionStatus::FALLEN = BACKWARD;
-        else
-            MotionStatus::FALLEN = STANDUP;
+    // A second, goal only packet pays its header back after a few joints;
+    // below that the goals ride along in the full window.
+    if(full_num > 0 && goal_num > 0
+        && protocol->GetSyncWriteLength(MX28::PARAM_BYTES, full_num + goal_num)
+           <= protocol->GetSyncWriteLength(MX28::PARAM_BYTES, full_num) + protocol->GetSyncWriteLength(3, goal_num))
+    {
+        for(int i = 0; i < goal_num; i++)
+            full_id[full_num++] = goal_id[i];
+        goal_num = 0;
+    }
 
-        if(m_Modules.size() != 0)
-        {
-            for(std::list<MotionModule*>::iterator i = m_Modules.begin(); i != m_Modules.end(); i++)
-            {
-                (*i)->Process();
-                for(int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++)
-                {
-                    if((*i)->m_Joint.GetEnable(id) == true)
-                    {
-                        MotionStatus::m_CurrentJoints.SetSlope(id, (*i)->m_Joint.GetCWSlope(id), (*i)->m_Joint.GetCCWSlope(id));
-                        MotionStatus::m_CurrentJoints.SetValue(id, (*i)->m_Joint.GetValue(id));
-
-                        MotionStatus::m_CurrentJoints.SetPGain(id, (*i)->m_Joint.GetPGain(id));
-                        MotionStatus::m_CurrentJoints.SetIGain(id, (*i)->m_Joint.GetIGain(id));
-                        MotionStatus::m_CurrentJoints.SetDGain(id, (*i)->m_Joint.GetDGain(id));
-                    }
-                }
-            }
-        }
+    int param[JointData::NUMBER_OF_JOINTS * MX28::PARAM_BYTES];
+    int n = 0;
 
-        int param[JointData::NUMBER_OF_JOINTS * MX28::PARAM_BYTES];
-        int n = 0;
-        int joint_num = 0;
-        for(int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++)
+    if(full_num > 0)
+    {
+        for(int i = 0; i < full_num; i++)
         {
-            if(MotionStatus::m_CurrentJoints.GetEnable(id) == true)
-            {
-                param[n++] = id;
+            int id = full_id[i];
+            param[n++] = id;
 #ifdef MX28_1024
-                param[n++] = MotionStatus::m_CurrentJoints.GetCWSlope(id);
-                param[n++] = MotionStatus::m_CurrentJoints.GetCCWSlope(id);
+            param[n++] = joints->GetCWSlope(id);
+            param[n++] = joints->GetCCWSlope(id);
 #else
-                param[n++] = MotionStatus::m_CurrentJoints.GetDGain(id);
-                param[n++] = MotionStatus::m_CurrentJoints.GetIGain(id);
-                param[n++] = MotionStatus::m_CurrentJoints.GetPGain(id);
-                param[n++] = 0;
+            param[n++] = joints->GetDGain(id);
+            param[n++] = joints->GetIGain(id);
+            param[n++] = joints->GetPGain(id);
+            param[n++] = 0;
 #endif
-                param[n++] = CM730::GetLowByte(MotionStatus::m_CurrentJoints.GetValue(id) + m_Offset[id]);
-                param[n++] = CM730::GetHighByte(MotionStatus::m_CurrentJoints.GetValue(id) + m_Offset[id]);
-                joint_num++;
-            }
-
-            if(DEBUG_PRINT == true)
-                fprintf(stderr, "ID[%d] : %d \n", id, MotionStatus::m_CurrentJoints.GetValue(id));
+            param[n++] = CM730::GetLowByte(joints->GetValue(id) + m_Offset[id]);
+            param[n++] = CM730::GetHighByte(joints->GetValue(id) + m_Offset[id]);
         }
-
-        if(joint_num > 0)
 #ifdef MX28_1024
-            m_CM730->SyncWrite(MX28::P_CW_COMPLIANCE_SLOPE, MX28::PARAM_BYTES, joint_num, param);
+        m_CM730->SyncWrite(MX28::P_CW_COMPLIANCE_SLOPE, MX28::PARAM_BYTES, full_num, param);
 #else
-            m_CM730->SyncWrite(MX28::P_D_GAIN, MX28::PARAM_BYTES, joint_num, param);
+        m_CM730->SyncWrite(MX28::P_D_GAIN, MX28::PARAM_BYTES, full_num, param);
 #endif
+        m_WriteBytes += protocol->GetSyncWriteLength(MX28::PARAM_BYTES, full_num);
     }
 
-    m_CM730->BulkRead();
-
-    if(m_IsLogging)
+    if(goal_num > 0)
     {
-        for(int id = 1; id < JointData::NUMBER_OF_JOINTS; id++)
-            m_LogFileStream << MotionStatus::m_CurrentJoints.GetValue(id) << "," << m_CM730->m_BulkReadData[id].ReadWord(MX28::P_PRESENT_POSITION_L) << ",";
-
-        m_LogFileStream << m_CM730->m_BulkReadData[CM730::ID_CM].ReadWord(CM730::P_GYRO_Y_L) << ",";
-        m_LogFileStream << m_CM730->m_BulkReadData[CM730::ID_CM].ReadWord(CM730::P_GYRO_X_L) << ",";
-        m_LogFileStream << m_CM730->m_BulkReadData[CM730::ID_CM].ReadWord(CM730::P_ACCEL_Y_L) << ",";
-        m_LogFileStream << m_CM730->m_BulkReadData[CM730::ID_CM].ReadWord(CM730::P_ACCEL_X_L) << ",";
-        m_LogFileStream << m_CM730->m_BulkReadData[FSR::ID_L_FSR].ReadByte(FSR::P_FSR_X) << ",";
-        m_LogFileStream << m_CM730->m_BulkReadData[FSR::ID_L_FSR].ReadByte(FSR::P_FSR_Y) << ",";
-        m_LogFileStream << m_CM730->m_BulkReadData[FSR::ID_R_FSR].ReadByte(FSR::P_FSR_X) << ",";
-        m_LogFileStream << m_CM730->m_BulkReadData[FSR::ID_R_FSR].ReadByte(FSR::P_FSR_Y) << ",";
-        m_LogFileStream << std::endl;
+        n = 0;
+        for(int i = 0; i < goal_num; i++)
+        {
+            int id = goal_id[i];
+            param[n++] = id;
+            param[n++] = CM730::GetLowByte(joints->GetValue(id) + m_Offset[id]);
+            param[n++] = CM730::GetHighByte(joints->GetValue(id) + m_Offset[id]);
+        }
+        m_CM730->SyncWrite(MX28::P_GOAL_POSITION_L, 3, goal_num, param);
+        m_WriteBytes += protocol->GetSyncWriteLength(3, goal_num);
     }
-
-    if(m_CM730->m_BulkReadData[CM730::ID_CM].error == 0)
-        MotionStatus::BUTTON = m_CM730->m_BulkReadData[CM730::ID_CM].ReadByte(CM730::P_BUTTON);
-
-    m_IsRunning = false;
-}
-
-void MotionManager::SetEnable(bool enable)
-{
-	m_Enabled = enable;
-	if(m_Enabled == true)
-		m_CM730->WriteWord(CM730::ID_BROADCAST, MX28::P_MOVING_SPEED_L, 0, 0);
 }
 
 void MotionManager::AddModule(MotionModule *module)
 {
+	module->SetMotionStatus(m_Status);
+	module->SetTimeUnit(m_TimeUnit);
 	module->Initialize();
 	m_Modules.push_back(module);
 }
@@ -357,6 +461,97 @@ void MotionManager::AddModule(MotionModule *module)
 void MotionManager::RemoveModule(MotionModule *module)
 {
 	m_Modules.remove(module);
+
+	for(int id = 0; id < JointData::NUMBER_OF_JOINTS; id++)
+	{
+		if(m_JointOwner[id] == module)
+			m_JointOwner[id] = 0;
+	}
+}
+
+void MotionManager::ArbitrateJoints()
+{
+    for(int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++)
+    {
+        MotionModule *owner = 0;
+        MotionModule *idle = 0;
+        for(std::list<MotionModule*>::iterator i = m_Modules.begin(); i != m_Modules.end(); i++)
+        {
+            if((*i)->m_Joint.GetEnable(id) == false)
+                continue;
+
+            if((*i)->IsActive() == true)
+            {
+                if(owner == 0 || (*i)->GetPriority(id) >= owner->GetPriority(id))
+                    owner = *i;
+            }
+            else
+            {
+                if(idle == 0 || (*i)->GetPriority(id) >= idle->GetPriority(id))
+                    idle = *i;
+            }
+        }
+
+        if(owner == 0)
+            owner = idle;
+        if(owner == 0)
+            continue;
+
+        if(owner != m_JointOwner[id])
+        {
+            // blend from what the servo was last given, so handing over in the
+            // middle of another fade does not jump
+            if(m_JointOwner[id] != 0 && owner->GetFadeTime() > 0)
+            {
+                m_FadeStart[id] = m_Status->m_Joints.GetValue(id);
+                m_FadeElapsed[id] = 0;
+                m_FadeDuration[id] = owner->GetFadeTime();
+            }
+            else
+                m_FadeElapsed[id] = -1;
+
+            m_JointOwner[id] = owner;
+        }
+
+        int value = owner->m_Joint.GetValue(id);
+        if(m_FadeElapsed[id] >= 0)
+        {
+            m_FadeElapsed[id] += m_TimeUnit;
+            if(m_FadeElapsed[id] >= m_FadeDuration[id])
+                m_FadeElapsed[id] = -1;
+            else
+                value = m_FadeStart[id] + (int)((value - m_FadeStart[id]) * m_FadeElapsed[id] / m_FadeDuration[id]);
+        }
+
+        m_Status->m_Joints.SetSlope(id, owner->m_Joint.GetCWSlope(id), owner->m_Joint.GetCCWSlope(id));
+        m_Status->m_Joints.SetValue(id, value);
+
+        m_Status->m_Joints.SetPGain(id, owner->m_Joint.GetPGain(id));
+        m_Status->m_Joints.SetIGain(id, owner->m_Joint.GetIGain(id));
+        m_Status->m_Joints.SetDGain(id, owner->m_Joint.GetDGain(id));
+    }
+}
+
+void MotionManager::SetTimeUnit(double msec)
+{
+	if(msec <= 0)
+		return;
+
+	m_TimeUnit = msec;
+	for(std::list<MotionModule*>::iterator i = m_Modules.begin(); i != m_Modules.end(); i++)
+		(*i)->SetTimeUnit(msec);
+
+	m_GyroCalibration.SetTimeUnit(msec);
+	m_FallDetector.SetTimeUnit(msec);
+
+	// the position ranges stay, only the status read period follows the tick
+	for(int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++)
+	{
+		if(m_CM730 == 0 || m_JointStatusBulkReadRange[id] == -1)
+			continue;
+		m_CM730->RemoveBulkReadRange(m_JointStatusBulkReadRange[id]);
+		m_JointStatusBulkReadRange[id] = m_CM730->AddBulkReadRange(id, MX28::P_PRESENT_VOLTAGE, 2, GetJointStatusReadPeriod(msec));
+	}
 }
 
 void MotionManager::SetJointDisable(int index)
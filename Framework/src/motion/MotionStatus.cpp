@@ -9,11 +9,58 @@
 
 using namespace Robot;
 
-JointData MotionStatus::m_CurrentJoints;
-int MotionStatus::FB_GYRO(0);
-int MotionStatus::RL_GYRO(0);
-int MotionStatus::FB_ACCEL(0);
-int MotionStatus::RL_ACCEL(0);
-
-int MotionStatus::BUTTON(0);
-int MotionStatus::FALLEN(0);
+MotionStatus MotionStatus::m_Default;
+
+JointData &MotionStatus::m_CurrentJoints(m_Default.m_Joints);
+int &MotionStatus::FB_GYRO(m_Default.m_FBGyro);
+int &MotionStatus::RL_GYRO(m_Default.m_RLGyro);
+int &MotionStatus::FB_ACCEL(m_Default.m_FBAccel);
+int &MotionStatus::RL_ACCEL(m_Default.m_RLAccel);
+
+int &MotionStatus::BUTTON(m_Default.m_Button);
+int &MotionStatus::FALLEN(m_Default.m_Fallen);
+
+double &MotionStatus::PITCH(m_Default.m_Pitch);
+double &MotionStatus::ROLL(m_Default.m_Roll);
+double &MotionStatus::YAW_RATE(m_Default.m_YawRate);
+int &MotionStatus::FALL_PREDICTION(m_Default.m_FallPrediction);
+
+MotionStatus::MotionStatus() :
+    m_FBGyro(0),
+    m_RLGyro(0),
+    m_FBAccel(0),
+    m_RLAccel(0),
+    m_Button(0),
+    m_Fallen(0),
+    m_Pitch(0),
+    m_Roll(0),
+    m_YawRate(0),
+    m_FallPrediction(0)
+{
+}
+
+void MotionStatus::PublishState()
+{
+    MotionState *state = m_State.BeginWrite();
+
+    state->tick++;
+    for(int id = 0; id < JointData::NUMBER_OF_JOINTS; id++)
+        state->joint_value[id] = m_Joints.GetValue(id);
+    state->fb_gyro = m_FBGyro;
+    state->rl_gyro = m_RLGyro;
+    state->fb_accel = m_FBAccel;
+    state->rl_accel = m_RLAccel;
+    state->button = m_Button;
+    state->fallen = m_Fallen;
+    state->pitch = m_Pitch;
+    state->roll = m_Roll;
+    state->yaw_rate = m_YawRate;
+    state->fall_prediction = m_FallPrediction;
+
+    m_State.EndWrite();
+}
+
+void MotionStatus::ReadState(MotionState *state)
+{
+    m_State.Read(state);
+}
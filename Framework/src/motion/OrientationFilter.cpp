@@ -0,0 +1,99 @@
+/*
+ *   OrientationFilter.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <math.h>
+#include "MotionStatus.h"
+#include "OrientationFilter.h"
+
+using namespace Robot;
+
+#define RAD2DEG     (180.0 / 3.141592)
+
+
+OrientationFilter::OrientationFilter() :
+		GYRO_SCALE(1600.0 / 512.0),
+		ACCEL_SCALE(128.0),
+		FB_GYRO_SIGN(1),
+		RL_GYRO_SIGN(1),
+		TIME_CONSTANT(0.5),
+		ACCEL_MARGIN(0.3),
+		FALLEN_ANGLE(60.0),
+		PREDICTION_TIME(0.2)
+{
+	Reset();
+}
+
+void OrientationFilter::Reset()
+{
+	m_Pitch = 0;
+	m_Roll = 0;
+	m_PitchRate = 0;
+	m_RollRate = 0;
+	m_YawRate = 0;
+	m_Initialized = false;
+}
+
+void OrientationFilter::Process(double dt, int fb_gyro, int rl_gyro, int yaw_gyro,
+								int fb_accel, int rl_accel, int z_accel)
+{
+	m_PitchRate = FB_GYRO_SIGN * fb_gyro * GYRO_SCALE;
+	m_RollRate = RL_GYRO_SIGN * rl_gyro * GYRO_SCALE;
+	m_YawRate = yaw_gyro * GYRO_SCALE;
+
+	// in g, the robot leaning forward sees gravity pull towards its front
+	double ax = (rl_accel - 512) / ACCEL_SCALE;
+	double ay = (512 - fb_accel) / ACCEL_SCALE;
+	double az = (z_accel - 512) / ACCEL_SCALE;
+	double norm = sqrt(ax * ax + ay * ay + az * az);
+
+	double accel_pitch = atan2(ay, sqrt(ax * ax + az * az)) * RAD2DEG;
+	double accel_roll = atan2(ax, sqrt(ay * ay + az * az)) * RAD2DEG;
+	if(az < 0)
+	{
+		// upside down, keep the angles continuous past 90 degrees
+		accel_pitch = (ay >= 0 ? 180.0 : -180.0) - accel_pitch;
+	}
+
+	bool accel_valid = (fabs(norm - 1.0) < ACCEL_MARGIN);
+
+	// start from the first reading that shows gravity alone
+	if(m_Initialized == false)
+	{
+		if(accel_valid == true)
+		{
+			m_Pitch = accel_pitch;
+			m_Roll = accel_roll;
+			m_Initialized = true;
+		}
+		return;
+	}
+
+	m_Pitch += m_PitchRate * dt;
+	m_Roll += m_RollRate * dt;
+
+	if(accel_valid == true)
+	{
+		double alpha = dt / (TIME_CONSTANT + dt);
+		m_Pitch += alpha * (accel_pitch - m_Pitch);
+		m_Roll += alpha * (accel_roll - m_Roll);
+	}
+}
+
+int OrientationFilter::GetFallPrediction()
+{
+	if(m_Initialized == false)
+		return STANDUP;
+
+	double pitch = m_Pitch + m_PitchRate * PREDICTION_TIME;
+
+	if(m_Pitch >= FALLEN_ANGLE || pitch >= FALLEN_ANGLE)
+		return FORWARD;
+	if(m_Pitch <= -FALLEN_ANGLE || pitch <= -FALLEN_ANGLE)
+		return BACKWARD;
+
+	return STANDUP;
+}
@@ -0,0 +1,120 @@
+/*
+ *   WalkEvaluator.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <math.h>
+#include "Kinematics.h"
+#include "WalkEvaluator.h"
+
+using namespace Robot;
+
+
+void WalkParameters::Get(Walking *walking)
+{
+	X_OFFSET = walking->X_OFFSET;
+	Y_OFFSET = walking->Y_OFFSET;
+	Z_OFFSET = walking->Z_OFFSET;
+	A_OFFSET = walking->A_OFFSET;
+	P_OFFSET = walking->P_OFFSET;
+	R_OFFSET = walking->R_OFFSET;
+	PERIOD_TIME = walking->PERIOD_TIME;
+	DSP_RATIO = walking->DSP_RATIO;
+	STEP_FB_RATIO = walking->STEP_FB_RATIO;
+	X_MOVE_AMPLITUDE = walking->X_MOVE_AMPLITUDE;
+	Y_MOVE_AMPLITUDE = walking->Y_MOVE_AMPLITUDE;
+	Z_MOVE_AMPLITUDE = walking->Z_MOVE_AMPLITUDE;
+	A_MOVE_AMPLITUDE = walking->A_MOVE_AMPLITUDE;
+	A_MOVE_AIM_ON = walking->A_MOVE_AIM_ON;
+	Y_SWAP_AMPLITUDE = walking->Y_SWAP_AMPLITUDE;
+	Z_SWAP_AMPLITUDE = walking->Z_SWAP_AMPLITUDE;
+	ARM_SWING_GAIN = walking->ARM_SWING_GAIN;
+	PELVIS_OFFSET = walking->PELVIS_OFFSET;
+	HIP_PITCH_OFFSET = walking->HIP_PITCH_OFFSET;
+}
+
+void WalkParameters::Set(Walking *walking) const
+{
+	walking->X_OFFSET = X_OFFSET;
+	walking->Y_OFFSET = Y_OFFSET;
+	walking->Z_OFFSET = Z_OFFSET;
+	walking->A_OFFSET = A_OFFSET;
+	walking->P_OFFSET = P_OFFSET;
+	walking->R_OFFSET = R_OFFSET;
+	walking->PERIOD_TIME = PERIOD_TIME;
+	walking->DSP_RATIO = DSP_RATIO;
+	walking->STEP_FB_RATIO = STEP_FB_RATIO;
+	walking->X_MOVE_AMPLITUDE = X_MOVE_AMPLITUDE;
+	walking->Y_MOVE_AMPLITUDE = Y_MOVE_AMPLITUDE;
+	walking->Z_MOVE_AMPLITUDE = Z_MOVE_AMPLITUDE;
+	walking->A_MOVE_AMPLITUDE = A_MOVE_AMPLITUDE;
+	walking->A_MOVE_AIM_ON = A_MOVE_AIM_ON;
+	walking->Y_SWAP_AMPLITUDE = Y_SWAP_AMPLITUDE;
+	walking->Z_SWAP_AMPLITUDE = Z_SWAP_AMPLITUDE;
+	walking->ARM_SWING_GAIN = ARM_SWING_GAIN;
+	walking->PELVIS_OFFSET = PELVIS_OFFSET;
+	walking->HIP_PITCH_OFFSET = HIP_PITCH_OFFSET;
+}
+
+WalkEvaluator::WalkEvaluator(double time_unit)
+{
+	m_TimeUnit = time_unit;
+	m_Walking = new Walking();
+	m_Walking->SetMotionStatus(&m_Status);
+	m_Walking->SetTimeUnit(m_TimeUnit);
+	m_Walking->BALANCE_ENABLE = false; // no gyro
+}
+
+WalkEvaluator::~WalkEvaluator()
+{
+	delete m_Walking;
+}
+
+int WalkEvaluator::GetTicks(const WalkParameters &param, int cycles)
+{
+	return (int)ceil(cycles * param.PERIOD_TIME / m_TimeUnit);
+}
+
+void WalkEvaluator::Evaluate(WalkCandidate *candidate)
+{
+	const WalkParameters &param = candidate->param;
+	int ticks = GetTicks(param, candidate->cycles);
+
+	// Initialize() stands the robot up and clears the move amplitudes
+	param.Set(m_Walking);
+	m_Walking->Initialize();
+	m_Walking->X_MOVE_AMPLITUDE = param.X_MOVE_AMPLITUDE;
+	m_Walking->Y_MOVE_AMPLITUDE = param.Y_MOVE_AMPLITUDE;
+	m_Walking->A_MOVE_AMPLITUDE = param.A_MOVE_AMPLITUDE;
+	m_Walking->Start();
+
+	unsigned int ik_fail = m_Walking->GetIKFailCount();
+	double margin = Kinematics::THIGH_LENGTH + Kinematics::CALF_LENGTH;
+	int *joint = candidate->trajectory;
+
+	for(int t = 0; t < ticks; t++)
+	{
+		m_Walking->Process();
+
+		for(int leg = 0; leg < 12; leg += 6)
+		{
+			double m = Kinematics::LegReachMargin(m_Walking->GetEndpoint(leg), m_Walking->GetEndpoint(leg + 1),
+					m_Walking->GetEndpoint(leg + 2), m_Walking->GetEndpoint(leg + 3),
+					m_Walking->GetEndpoint(leg + 4), m_Walking->GetEndpoint(leg + 5));
+			if(m < margin)
+				margin = m;
+		}
+
+		if(joint != 0)
+		{
+			for(int id = 0; id < JointData::NUMBER_OF_JOINTS; id++)
+				*joint++ = m_Walking->m_Joint.GetValue(id);
+		}
+	}
+
+	candidate->ticks = ticks;
+	candidate->ik_failures = (int)(m_Walking->GetIKFailCount() - ik_fail);
+	candidate->reach_margin = margin;
+}
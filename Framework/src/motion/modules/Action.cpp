@@ -19,6 +19,27 @@ Action::Action()
 	DEBUG_PRINT = false;
 	m_ActionFile = 0;
 	m_Playing = false;
+	m_FirstDrivingStart = false;
+	m_PlayTime = 0;
+	m_UnitTime = 0;
+
+	memset(wpStartAngle1024, 0, sizeof(wpStartAngle1024));
+	memset(wpTargetAngle1024, 0, sizeof(wpTargetAngle1024));
+	memset(ipMovingAngle1024, 0, sizeof(ipMovingAngle1024));
+	memset(ipMainAngle1024, 0, sizeof(ipMainAngle1024));
+	memset(ipAccelAngle1024, 0, sizeof(ipAccelAngle1024));
+	memset(ipMainSpeed1024, 0, sizeof(ipMainSpeed1024));
+	memset(ipLastOutSpeed1024, 0, sizeof(ipLastOutSpeed1024));
+	memset(ipGoalSpeed1024, 0, sizeof(ipGoalSpeed1024));
+	memset(bpFinishType, 0, sizeof(bpFinishType));
+	wUnitTimeCount = 0;
+	wUnitTimeNum = 0;
+	wPauseTime = 0;
+	wUnitTimeTotalNum = 0;
+	wAccelStep = 0;
+	bSection = 0;
+	bPlayRepeatCount = 0;
+	wNextPlayPage = 0;
 }
 
 Action::~Action()
@@ -95,7 +116,7 @@ void Action::Initialize()
 	m_Playing = false;
 
     for( int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++ )
-        m_Joint.SetValue(id, MotionStatus::m_CurrentJoints.GetValue(id));
+        m_Joint.SetValue(id, m_MotionStatus->m_Joints.GetValue(id));
 }
 
 bool Action::LoadFile( char* filename )
@@ -269,6 +290,56 @@ bool Action::SavePage(int index, PAGE *pPage)
 }
 
 void Action::Process()
+{
+    if( m_Playing == false )
+        return;
+
+    // Page timing is computed in steps of TIME_UNIT. With another control
+    // period the steps are run as their time comes and the output is
+    // interpolated between the last two of them.
+    if( m_FirstDrivingStart == true )
+    {
+        m_PlayTime = 0;
+        m_UnitTime = 0;
+        // start from what the servos were last given, not this module's stale
+        // output, so taking the joints over from another module does not jump
+        for( int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++ )
+        {
+            if(m_Joint.GetEnable(id) == true)
+                m_Joint.SetValue(id, m_MotionStatus->m_Joints.GetValue(id));
+            m_UnitValue[id] = m_Joint.GetValue(id);
+        }
+    }
+
+    m_PlayTime += m_TimeUnit;
+    while( m_Playing == true && m_UnitTime < m_PlayTime )
+    {
+        for( int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++ )
+        {
+            m_PrevUnitValue[id] = m_UnitValue[id];
+            if(m_Joint.GetEnable(id) == true)
+                m_Joint.SetValue(id, m_UnitValue[id]);
+        }
+
+        ProcessUnit();
+
+        for( int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++ )
+            m_UnitValue[id] = m_Joint.GetValue(id);
+        m_UnitTime += TIME_UNIT;
+    }
+
+    double ratio = 1.0 - (m_UnitTime - m_PlayTime) / TIME_UNIT;
+    if( m_Playing == false || ratio > 1.0 )
+        ratio = 1.0;
+
+    for( int id=JointData::ID_R_SHOULDER_PITCH; id<JointData::NUMBER_OF_JOINTS; id++ )
+    {
+        if(m_Joint.GetEnable(id) == true)
+            m_Joint.SetValue(id, m_PrevUnitValue[id] + (int)((m_UnitValue[id] - m_PrevUnitValue[id]) * ratio));
+    }
+}
+
+void Action::ProcessUnit()
 {
 	////////////////////  
     unsigned char bID;
@@ -286,25 +357,7 @@ void Action::Process()
     unsigned short wNextTargetAngle; // Next target position
     unsigned char bDirectionChanged;
 
-    ///////////////// Static 
-	static unsigned short wpStartAngle1024[JointData::NUMBER_OF_JOINTS]; //   
-    static unsigned short wpTargetAngle1024[JointData::NUMBER_OF_JOINTS]; //   
-    static short int ipMovingAngle1024[JointData::NUMBER_OF_JOINTS]; //   Ÿ
-    static short int ipMainAngle1024[JointData::NUMBER_OF_JOINTS]; //    Ÿ
-    static short int ipAccelAngle1024[JointData::NUMBER_OF_JOINTS]; //    Ÿ
-    static short int ipMainSpeed1024[JointData::NUMBER_OF_JOINTS]; // ǥ ӵ
-    static short int ipLastOutSpeed1024[JointData::NUMBER_OF_JOINTS]; //    ӵ()
-    static short int ipGoalSpeed1024[JointData::NUMBER_OF_JOINTS]; // Ͱ   ǥӵ
-    static unsigned char bpFinishType[JointData::NUMBER_OF_JOINTS]; //    
     short int iSpeedN;
-    static unsigned short wUnitTimeCount;
-    static unsigned short wUnitTimeNum;
-    static unsigned short wPauseTime;
-    static unsigned short wUnitTimeTotalNum;
-    static unsigned short wAccelStep;
-    static unsigned char bSection;
-    static unsigned char bPlayRepeatCount;
-    static unsigned short wNextPlayPage;
 
     /////////////// Enum 
 
@@ -339,7 +392,7 @@ void Action::Process()
         {
 			if(m_Joint.GetEnable(bID) == true)
 			{
-				wpTargetAngle1024[bID] = MotionStatus::m_CurrentJoints.GetValue(bID);
+				wpTargetAngle1024[bID] = m_MotionStatus->m_Joints.GetValue(bID);
 				ipLastOutSpeed1024[bID] = 0;
 				ipMovingAngle1024[bID] = 0;
 				ipGoalSpeed1024[bID] = 0;
@@ -32,6 +32,11 @@ Head::Head()
 	m_Pan_Home = 0.0;
 	m_Tilt_Home = Kinematics::EYE_TILT_OFFSET_ANGLE - 30.0;
 
+	m_PanAngle = 0.0;
+	m_TiltAngle = 0.0;
+	m_ProcessTarget.pan = 0.0;
+	m_ProcessTarget.tilt = 0.0;
+
 	m_Joint.SetEnableHeadOnly(true);
 }
 
@@ -52,10 +57,18 @@ void Head::CheckLimit()
 		m_TiltAngle = m_BottomLimit;	
 }
 
+void Head::PostTarget()
+{
+	Target target;
+	target.pan = m_PanAngle;
+	target.tilt = m_TiltAngle;
+	m_Target.Write(target);
+}
+
 void Head::Initialize()
 {
-	m_PanAngle = MotionStatus::m_CurrentJoints.GetAngle(JointData::ID_HEAD_PAN);
-	m_TiltAngle = -MotionStatus::m_CurrentJoints.GetAngle(JointData::ID_HEAD_TILT);
+	m_PanAngle = m_MotionStatus->m_Joints.GetAngle(JointData::ID_HEAD_PAN);
+	m_TiltAngle = -m_MotionStatus->m_Joints.GetAngle(JointData::ID_HEAD_TILT);
 	CheckLimit();
 
 	InitTracking();
@@ -113,6 +126,7 @@ void Head::MoveByAngle(double pan, double tilt)
 	m_TiltAngle = tilt;
 
 	CheckLimit();
+	PostTarget();
 }
 
 void Head::MoveByAngleOffset(double pan, double tilt)
@@ -164,13 +178,18 @@ void Head::MoveTracking()
 	m_TiltAngle += (pOffset + dOffset);
 
 	CheckLimit();
+	PostTarget();
 }
 
 void Head::Process()
 {
+	Target target;
+	if(m_Target.TryRead(&target) == true)
+		m_ProcessTarget = target;
+
 	if(m_Joint.GetEnable(JointData::ID_HEAD_PAN) == true)
-		m_Joint.SetAngle(JointData::ID_HEAD_PAN, m_PanAngle);
+		m_Joint.SetAngle(JointData::ID_HEAD_PAN, m_ProcessTarget.pan);
 
 	if(m_Joint.GetEnable(JointData::ID_HEAD_TILT) == true)
-		m_Joint.SetAngle(JointData::ID_HEAD_TILT, m_TiltAngle);
+		m_Joint.SetAngle(JointData::ID_HEAD_TILT, m_ProcessTarget.tilt);
 }
@@ -0,0 +1,626 @@
+/*
+ *   PreviewWalking.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+#include <stdio.h>
+#include <math.h>
+#include "MX28.h"
+#include "Kinematics.h"
+#include "PreviewWalking.h"
+
+using namespace Robot;
+
+
+#define PI (3.14159265)
+#define GRAVITY (9810.0) // mm/s^2
+
+PreviewWalking* PreviewWalking::m_UniqueInstance = new PreviewWalking();
+
+PreviewWalking::PreviewWalking()
+{
+	m_CommandSequence = 0;
+	m_X_Velocity = 0;
+	m_Y_Velocity = 0;
+	m_A_Velocity = 0;
+	m_Ctrl_Running = false;
+	m_Real_Running = false;
+	m_Gain_TimeUnit = 0;
+	m_Gain_ComHeight = 0;
+	m_Gain_PreviewTime = 0;
+	m_Gain_ZmpWeight = 0;
+	m_PreviewCount = 0;
+	m_StepCount = 0;
+	m_StepTime = 0;
+	m_IKFailCount = 0;
+	for(int i = 0; i < 12; i++)
+		m_Endpoint[i] = 0;
+
+	X_OFFSET = -10;
+	Y_OFFSET = 5;
+	Z_OFFSET = 20;
+	R_OFFSET = 0;
+	P_OFFSET = 0;
+	A_OFFSET = 0;
+	HIP_PITCH_OFFSET = 13.0;
+	PERIOD_TIME = 600;
+	DSP_RATIO = 0.2;
+	Z_MOVE_AMPLITUDE = 30;
+	X_MOVE_ACCEL = 5;
+	Y_MOVE_ACCEL = 5;
+	A_MOVE_ACCEL = 10;
+	COM_HEIGHT = 230;
+	PREVIEW_TIME = 1600;
+	ZMP_WEIGHT = 1;
+
+	// arms stay in Walking's initial pose
+	m_Joint.SetAngle(JointData::ID_R_SHOULDER_PITCH, -48.345);
+	m_Joint.SetAngle(JointData::ID_L_SHOULDER_PITCH, 41.313);
+	m_Joint.SetAngle(JointData::ID_R_SHOULDER_ROLL, -17.873);
+	m_Joint.SetAngle(JointData::ID_L_SHOULDER_ROLL, 17.580);
+	m_Joint.SetAngle(JointData::ID_R_ELBOW, 29.300);
+	m_Joint.SetAngle(JointData::ID_L_ELBOW, -29.593);
+
+	m_Joint.SetAngle(JointData::ID_HEAD_TILT, Kinematics::EYE_TILT_OFFSET_ANGLE);
+}
+
+PreviewWalking::~PreviewWalking()
+{
+}
+
+void PreviewWalking::LoadINISettings(minIni* ini)
+{
+	LoadINISettings(ini, PREVIEW_WALKING_SECTION);
+}
+void PreviewWalking::LoadINISettings(minIni* ini, const std::string &section)
+{
+	double value = INVALID_VALUE;
+
+	if((value = ini->getd(section, "x_offset", INVALID_VALUE)) != INVALID_VALUE)                X_OFFSET = value;
+	if((value = ini->getd(section, "y_offset", INVALID_VALUE)) != INVALID_VALUE)                Y_OFFSET = value;
+	if((value = ini->getd(section, "z_offset", INVALID_VALUE)) != INVALID_VALUE)                Z_OFFSET = value;
+	if((value = ini->getd(section, "roll_offset", INVALID_VALUE)) != INVALID_VALUE)             R_OFFSET = value;
+	if((value = ini->getd(section, "pitch_offset", INVALID_VALUE)) != INVALID_VALUE)            P_OFFSET = value;
+	if((value = ini->getd(section, "yaw_offset", INVALID_VALUE)) != INVALID_VALUE)              A_OFFSET = value;
+	if((value = ini->getd(section, "hip_pitch_offset", INVALID_VALUE)) != INVALID_VALUE)        HIP_PITCH_OFFSET = value;
+	if((value = ini->getd(section, "period_time", INVALID_VALUE)) != INVALID_VALUE)             PERIOD_TIME = value;
+	if((value = ini->getd(section, "dsp_ratio", INVALID_VALUE)) != INVALID_VALUE)               DSP_RATIO = value;
+	if((value = ini->getd(section, "foot_height", INVALID_VALUE)) != INVALID_VALUE)             Z_MOVE_AMPLITUDE = value;
+	if((value = ini->getd(section, "step_accel_forward_back", INVALID_VALUE)) != INVALID_VALUE) X_MOVE_ACCEL = value;
+	if((value = ini->getd(section, "step_accel_right_left", INVALID_VALUE)) != INVALID_VALUE)   Y_MOVE_ACCEL = value;
+	if((value = ini->getd(section, "step_accel_direction", INVALID_VALUE)) != INVALID_VALUE)    A_MOVE_ACCEL = value;
+	if((value = ini->getd(section, "com_height", INVALID_VALUE)) != INVALID_VALUE)              COM_HEIGHT = value;
+	if((value = ini->getd(section, "preview_time", INVALID_VALUE)) != INVALID_VALUE)            PREVIEW_TIME = value;
+	if((value = ini->getd(section, "zmp_weight", INVALID_VALUE)) != INVALID_VALUE)              ZMP_WEIGHT = value;
+}
+void PreviewWalking::SaveINISettings(minIni* ini)
+{
+	SaveINISettings(ini, PREVIEW_WALKING_SECTION);
+}
+void PreviewWalking::SaveINISettings(minIni* ini, const std::string &section)
+{
+	ini->put(section,   "x_offset",                 X_OFFSET);
+	ini->put(section,   "y_offset",                 Y_OFFSET);
+	ini->put(section,   "z_offset",                 Z_OFFSET);
+	ini->put(section,   "roll_offset",              R_OFFSET);
+	ini->put(section,   "pitch_offset",             P_OFFSET);
+	ini->put(section,   "yaw_offset",               A_OFFSET);
+	ini->put(section,   "hip_pitch_offset",         HIP_PITCH_OFFSET);
+	ini->put(section,   "period_time",              PERIOD_TIME);
+	ini->put(section,   "dsp_ratio",                DSP_RATIO);
+	ini->put(section,   "foot_height",              Z_MOVE_AMPLITUDE);
+	ini->put(section,   "step_accel_forward_back",  X_MOVE_ACCEL);
+	ini->put(section,   "step_accel_right_left",    Y_MOVE_ACCEL);
+	ini->put(section,   "step_accel_direction",     A_MOVE_ACCEL);
+	ini->put(section,   "com_height",               COM_HEIGHT);
+	ini->put(section,   "preview_time",             PREVIEW_TIME);
+	ini->put(section,   "zmp_weight",               ZMP_WEIGHT);
+}
+
+void PreviewWalking::Initialize()
+{
+	Command *cmd = m_Command.BeginWrite();
+	cmd->x_move = 0;
+	cmd->y_move = 0;
+	cmd->a_move = 0;
+	cmd->running = false;
+	m_Command.EndWrite();
+	m_CommandSequence = m_Command.GetSequence();
+	m_X_Velocity = 0;
+	m_Y_Velocity = 0;
+	m_A_Velocity = 0;
+	m_Ctrl_Running = false;
+	m_Real_Running = false;
+
+	m_Gain_TimeUnit = 0;
+	update_gain();
+
+	// standing, the centre of mass over the middle of the feet
+	double width = (Kinematics::LEG_SIDE_OFFSET + Y_OFFSET) / 2;
+	m_Foot_X[RIGHT_FOOT] = 0;
+	m_Foot_Y[RIGHT_FOOT] = -width;
+	m_Foot_A[RIGHT_FOOT] = 0;
+	m_Foot_X[LEFT_FOOT] = 0;
+	m_Foot_Y[LEFT_FOOT] = width;
+	m_Foot_A[LEFT_FOOT] = 0;
+	m_Body_X = 0;
+	m_Body_Y = 0;
+	m_Body_A = 0;
+	m_ZMP_X = 0;
+	m_ZMP_Y = 0;
+	m_StepCount = 0;
+	m_StepTime = 0;
+
+	m_ComX.Zero();
+	m_ComY.Zero();
+	m_ErrorSumX = 0;
+	m_ErrorSumY = 0;
+	for(int i = 0; i <= MAX_PREVIEW; i++)
+	{
+		m_RefX[i] = 0;
+		m_RefY[i] = 0;
+	}
+
+	update_joints();
+}
+
+void PreviewWalking::Start()
+{
+	Command *cmd = m_Command.BeginWrite();
+	cmd->running = true;
+	m_Command.EndWrite();
+}
+
+void PreviewWalking::Stop()
+{
+	Command *cmd = m_Command.BeginWrite();
+	cmd->running = false;
+	m_Command.EndWrite();
+}
+
+bool PreviewWalking::IsRunning()
+{
+	return m_Real_Running;
+}
+
+void PreviewWalking::SetVelocity(double x, double y, double a)
+{
+	Command *cmd = m_Command.BeginWrite();
+	cmd->x_move = x;
+	cmd->y_move = y;
+	cmd->a_move = a;
+	m_Command.EndWrite();
+}
+
+void PreviewWalking::update_command()
+{
+	Command cmd;
+	unsigned int seq;
+
+	// a command being written is picked up on the next tick
+	if(m_Command.TryRead(&cmd, &seq) == false || seq == m_CommandSequence)
+		return;
+
+	m_CommandSequence = seq;
+	m_Ctrl_Running = cmd.running;
+	if(cmd.running == true)
+		m_Real_Running = true;
+	m_X_Velocity = cmd.x_move;
+	m_Y_Velocity = cmd.y_move;
+	m_A_Velocity = cmd.a_move * PI / 180.0;
+}
+
+void PreviewWalking::update_gain()
+{
+	if(m_TimeUnit == m_Gain_TimeUnit && COM_HEIGHT == m_Gain_ComHeight
+			&& PREVIEW_TIME == m_Gain_PreviewTime && ZMP_WEIGHT == m_Gain_ZmpWeight)
+		return;
+	m_Gain_TimeUnit = m_TimeUnit;
+	m_Gain_ComHeight = COM_HEIGHT;
+	m_Gain_PreviewTime = PREVIEW_TIME;
+	m_Gain_ZmpWeight = ZMP_WEIGHT;
+
+	// cart-table model, jerk in and ZMP out
+	double T = m_TimeUnit / 1000.0;
+	m_A.Identity();
+	m_A(0, 1) = T;
+	m_A(0, 2) = T * T / 2;
+	m_A(1, 2) = T;
+	m_B(0, 0) = T * T * T / 6;
+	m_B(1, 0) = T * T / 2;
+	m_B(2, 0) = T;
+	m_C(0, 0) = 1;
+	m_C(0, 1) = 0;
+	m_C(0, 2) = -COM_HEIGHT / GRAVITY;
+
+	// the same with the ZMP error summed up in front of the state
+	FixedMatrix<4, 4> A;
+	FixedMatrix<4, 1> B;
+	FixedMatrix<1, 3> CA = m_C * m_A;
+	A(0, 0) = 1;
+	B(0, 0) = (m_C * m_B)(0, 0);
+	for(int i = 0; i < 3; i++)
+	{
+		A(0, i + 1) = CA(0, i);
+		B(i + 1, 0) = m_B(i, 0);
+		for(int j = 0; j < 3; j++)
+			A(i + 1, j + 1) = m_A(i, j);
+	}
+	FixedMatrix<4, 4> Q;
+	Q(0, 0) = ZMP_WEIGHT;
+	const double R = 1e-6;
+
+	// discrete Riccati equation by iteration
+	FixedMatrix<4, 4> P = Q;
+	FixedMatrix<4, 4> At = A.Transpose();
+	FixedMatrix<1, 4> Bt = B.Transpose();
+	for(int iter = 0; iter < 100000; iter++)
+	{
+		double s = R + (Bt * P * B)(0, 0);
+		FixedMatrix<4, 4> next = Q + At * P * A - (At * P * B) * (Bt * P * A) * (1 / s);
+
+		double change = 0, size = 0;
+		for(int i = 0; i < 16; i++)
+		{
+			change += fabs(next.m[i] - P.m[i]);
+			size += fabs(next.m[i]);
+		}
+		P = next;
+		if(change <= size * 1e-12)
+			break;
+	}
+
+	double s = R + (Bt * P * B)(0, 0);
+	FixedMatrix<1, 4> K = (Bt * P * A) * (1 / s);
+	m_Gi = K(0, 0);
+	for(int i = 0; i < 3; i++)
+		m_Gx(0, i) = K(0, i + 1);
+
+	// gains on the reference 1, 2, ... ticks ahead
+	m_PreviewCount = (int)(PREVIEW_TIME / m_TimeUnit);
+	if(m_PreviewCount > MAX_PREVIEW)
+		m_PreviewCount = MAX_PREVIEW;
+	if(m_PreviewCount < 1)
+		m_PreviewCount = 1;
+
+	FixedMatrix<4, 4> Act = (A - B * K).Transpose();
+	FixedMatrix<4, 1> I;
+	I(0, 0) = 1;
+	FixedMatrix<4, 1> X = Act * P * I * -1.0;
+	m_Gp[0] = -m_Gi;
+	for(int j = 1; j < m_PreviewCount; j++)
+	{
+		m_Gp[j] = (Bt * X)(0, 0) / s;
+		X = Act * X;
+	}
+}
+
+// Foot that moves after a step that left the weight at (zmp_x, zmp_y)
+static int next_swing(const double *fx, const double *fy, double zmp_x, double zmp_y, double vy, double va)
+{
+	if(fabs(zmp_x - fx[PreviewWalking::LEFT_FOOT]) + fabs(zmp_y - fy[PreviewWalking::LEFT_FOOT]) < 0.1)
+		return PreviewWalking::RIGHT_FOOT;
+	if(fabs(zmp_x - fx[PreviewWalking::RIGHT_FOOT]) + fabs(zmp_y - fy[PreviewWalking::RIGHT_FOOT]) < 0.1)
+		return PreviewWalking::LEFT_FOOT;
+
+	// the foot on the side of a sideways step or turn opens the feet
+	return (vy > 0 || (vy == 0 && va > 0)) ? PreviewWalking::LEFT_FOOT : PreviewWalking::RIGHT_FOOT;
+}
+
+void PreviewWalking::plan_steps()
+{
+	double step_time = PERIOD_TIME / 2;
+	double width = (Kinematics::LEG_SIDE_OFFSET + Y_OFFSET) / 2;
+	double fx[2], fy[2], fa[2];
+
+	for(int i = 0; i < 2; i++)
+	{
+		fx[i] = m_Foot_X[i];
+		fy[i] = m_Foot_Y[i];
+		fa[i] = m_Foot_A[i];
+	}
+
+	// Standing: wait a step so the centre of mass sees the first shift coming
+	if(m_StepCount == 0)
+	{
+		Footstep &s = m_Step[0];
+		s.swing = STAND;
+		s.x = s.y = s.a = 0;
+		s.zmp_x = m_ZMP_X;
+		s.zmp_y = m_ZMP_Y;
+		s.body_x = m_Body_X; s.body_y = m_Body_Y; s.body_a = m_Body_A;
+		s.vx = s.vy = s.va = 0;
+		m_StepCount = 1;
+	}
+
+	// Steps about to be made are kept, the ones after them follow the command.
+	// Replanning a step the ZMP reaches within the preview's main gains would
+	// jerk the centre of mass.
+	int k = (m_StepCount < LOCKED_STEPS) ? m_StepCount : LOCKED_STEPS;
+	for(int i = 0; i < k; i++)
+	{
+		if(m_Step[i].swing != STAND)
+		{
+			fx[m_Step[i].swing] = m_Step[i].x;
+			fy[m_Step[i].swing] = m_Step[i].y;
+			fa[m_Step[i].swing] = m_Step[i].a;
+		}
+	}
+	const Footstep &last = m_Step[k - 1];
+	double bx = last.body_x, by = last.body_y, ba = last.body_a;
+	double vx = last.vx, vy = last.vy, va = last.va;
+	double zx = last.zmp_x, zy = last.zmp_y;
+	int prev_swing = last.swing;
+
+	double horizon = m_StepTime + m_PreviewCount * m_TimeUnit;
+	for(; k < MAX_FOOTSTEPS && k * step_time <= horizon; k++)
+	{
+		Footstep &s = m_Step[k];
+		double mid_x = (fx[0] + fx[1]) / 2;
+		double mid_y = (fy[0] + fy[1]) / 2;
+
+		// are both feet where a standing robot has them?
+		bool closed = true;
+		for(int i = 0; i < 2; i++)
+		{
+			double side = (i == LEFT_FOOT) ? 1 : -1;
+			if(fabs(fx[i] - (bx - sin(ba) * side * width)) > 0.1
+					|| fabs(fy[i] - (by + cos(ba) * side * width)) > 0.1
+					|| fabs(fa[i] - ba) > 0.001)
+				closed = false;
+		}
+
+		double tx = 0, ty = 0, ta = 0;
+		if(m_Ctrl_Running == true)
+		{
+			tx = m_X_Velocity;
+			ty = m_Y_Velocity;
+			ta = m_A_Velocity;
+		}
+		vx = Approach(vx, tx, X_MOVE_ACCEL);
+		vy = Approach(vy, ty, Y_MOVE_ACCEL);
+		va = Approach(va, ta, A_MOVE_ACCEL * PI / 180.0);
+
+		if(m_Ctrl_Running == false && vx == 0 && vy == 0 && va == 0 && closed == true)
+		{
+			// weight back between the feet, then the walk ends
+			if(prev_swing == STAND && fabs(zx - mid_x) + fabs(zy - mid_y) < 0.1)
+				break;
+			s.swing = STAND;
+			s.x = s.y = s.a = 0;
+			s.zmp_x = mid_x;
+			s.zmp_y = mid_y;
+			s.body_x = bx; s.body_y = by; s.body_a = ba;
+			s.vx = s.vy = s.va = 0;
+			k++;
+			break;
+		}
+
+		int swing;
+		if(prev_swing != STAND)
+			swing = 1 - prev_swing;
+		else
+			swing = next_swing(fx, fy, zx, zy, vy, va);
+
+		if(prev_swing == STAND && fabs(zx - mid_x) + fabs(zy - mid_y) < 0.1)
+		{
+			// from standing, shift the weight onto the support foot first
+			s.swing = STAND;
+			s.x = s.y = s.a = 0;
+			s.zmp_x = fx[1 - swing];
+			s.zmp_y = fy[1 - swing];
+			s.body_x = bx; s.body_y = by; s.body_a = ba;
+			s.vx = s.vy = s.va = 0;
+			vx = vy = va = 0;
+			zx = s.zmp_x;
+			zy = s.zmp_y;
+			continue;
+		}
+
+		// sideways and turning steps only open the feet, the other foot
+		// closes them on the next step
+		double side = (swing == LEFT_FOOT) ? 1 : -1;
+		double dx = vx;
+		double dy = (side * vy > 0) ? 2 * vy : 0;
+		double da = (side * va > 0) ? 2 * va : 0;
+		bx += cos(ba) * dx - sin(ba) * dy;
+		by += sin(ba) * dx + cos(ba) * dy;
+		ba += da;
+
+		s.swing = swing;
+		s.x = bx - sin(ba) * side * width;
+		s.y = by + cos(ba) * side * width;
+		s.a = ba;
+		s.zmp_x = fx[1 - swing];
+		s.zmp_y = fy[1 - swing];
+		s.body_x = bx; s.body_y = by; s.body_a = ba;
+		s.vx = vx; s.vy = vy; s.va = va;
+
+		fx[swing] = s.x;
+		fy[swing] = s.y;
+		fa[swing] = s.a;
+		zx = s.zmp_x;
+		zy = s.zmp_y;
+		prev_swing = swing;
+	}
+	m_StepCount = k;
+}
+
+void PreviewWalking::update_reference()
+{
+	double step_time = PERIOD_TIME / 2;
+	int k = 0;
+	double t = m_StepTime;
+	double from_x = m_ZMP_X, from_y = m_ZMP_Y;
+
+	for(int i = 0; i <= m_PreviewCount; i++, t += m_TimeUnit)
+	{
+		while(t >= step_time && k < m_StepCount - 1)
+		{
+			from_x = m_Step[k].zmp_x;
+			from_y = m_Step[k].zmp_y;
+			t -= step_time;
+			k++;
+		}
+
+		// the ZMP moves over to the support foot in the double support phase,
+		// while standing over the whole step
+		const Footstep &s = m_Step[k];
+		double dsp = (s.swing == STAND) ? step_time : step_time * DSP_RATIO;
+		if(t < dsp)
+		{
+			double r = t / dsp;
+			m_RefX[i] = from_x + (s.zmp_x - from_x) * r;
+			m_RefY[i] = from_y + (s.zmp_y - from_y) * r;
+		}
+		else
+		{
+			m_RefX[i] = s.zmp_x;
+			m_RefY[i] = s.zmp_y;
+		}
+	}
+}
+
+void PreviewWalking::control(FixedMatrix<3, 1> *com, double *error_sum, const double *ref)
+{
+	*error_sum += (m_C * *com)(0, 0) - ref[0];
+
+	double u = -m_Gi * *error_sum - (m_Gx * *com)(0, 0);
+	for(int j = 0; j < m_PreviewCount; j++)
+		u -= m_Gp[j] * ref[j + 1];
+
+	*com = m_A * *com + m_B * u;
+}
+
+void PreviewWalking::update_joints()
+{
+	//                     R_HIP_YAW, R_HIP_ROLL, R_HIP_PITCH, R_KNEE, R_ANKLE_PITCH, R_ANKLE_ROLL, L_HIP_YAW, L_HIP_ROLL, L_HIP_PITCH, L_KNEE, L_ANKLE_PITCH, L_ANKLE_ROLL
+	int dir[12]          = {   -1,        -1,          1,         1,         -1,            1,          -1,        -1,         -1,         -1,         1,            1     };
+	int id[12]           = { JointData::ID_R_HIP_YAW, JointData::ID_R_HIP_ROLL, JointData::ID_R_HIP_PITCH,
+							 JointData::ID_R_KNEE, JointData::ID_R_ANKLE_PITCH, JointData::ID_R_ANKLE_ROLL,
+							 JointData::ID_L_HIP_YAW, JointData::ID_L_HIP_ROLL, JointData::ID_L_HIP_PITCH,
+							 JointData::ID_L_KNEE, JointData::ID_L_ANKLE_PITCH, JointData::ID_L_ANKLE_ROLL };
+	double step_time = PERIOD_TIME / 2;
+	double fx[2], fy[2], fa[2], lift[2] = { 0, 0 };
+	double angle[12], *ep = m_Endpoint;
+
+	for(int i = 0; i < 2; i++)
+	{
+		fx[i] = m_Foot_X[i];
+		fy[i] = m_Foot_Y[i];
+		fa[i] = m_Foot_A[i];
+	}
+
+	// swing foot, lifted and carried over in the single support phase
+	if(m_StepCount > 0 && m_Step[0].swing != STAND)
+	{
+		const Footstep &s = m_Step[0];
+		double dsp = step_time * DSP_RATIO;
+		double phase = (m_StepTime - dsp) / (step_time - dsp);
+		if(phase < 0)
+			phase = 0;
+		else if(phase > 1)
+			phase = 1;
+		double r = (1 - cos(PI * phase)) / 2;
+		fx[s.swing] += (s.x - fx[s.swing]) * r;
+		fy[s.swing] += (s.y - fy[s.swing]) * r;
+		fa[s.swing] += (s.a - fa[s.swing]) * r;
+		lift[s.swing] = Z_MOVE_AMPLITUDE * (1 - cos(2 * PI * phase)) / 2; // lands softly
+	}
+
+	// feet seen from the hips, the body faces between the feet
+	double yaw = (fa[RIGHT_FOOT] + fa[LEFT_FOOT]) / 2;
+	double cy = cos(yaw), sy = sin(yaw);
+	for(int i = 0; i < 2; i++)
+	{
+		double side = (i == LEFT_FOOT) ? 1 : -1;
+		double dx = fx[i] - m_ComX(0, 0);
+		double dy = fy[i] - m_ComY(0, 0);
+		double *e = ep + ((i == RIGHT_FOOT) ? 0 : 6);
+
+		e[0] = cy * dx + sy * dy + X_OFFSET;
+		e[1] = -sy * dx + cy * dy - side * Kinematics::LEG_SIDE_OFFSET / 2;
+		e[2] = Z_OFFSET + lift[i];
+		e[3] = side * R_OFFSET * PI / 180.0 / 2;
+		e[4] = P_OFFSET * PI / 180.0;
+		e[5] = fa[i] - yaw + side * A_OFFSET * PI / 180.0 / 2;
+	}
+
+	if((Kinematics::LegIK(&angle[0], ep[0], ep[1], ep[2], ep[3], ep[4], ep[5]) == false)
+		|| (Kinematics::LegIK(&angle[6], ep[6], ep[7], ep[8], ep[9], ep[10], ep[11]) == false))
+	{
+		m_IKFailCount++;
+		return; // keep the last pose
+	}
+
+	for(int i = 0; i < 12; i++)
+	{
+		double offset = (double)dir[i] * angle[i] * 180.0 / PI * MX28::RATIO_ANGLE2VALUE;
+		if(i == 2 || i == 8) // R_HIP_PITCH or L_HIP_PITCH
+			offset -= (double)dir[i] * HIP_PITCH_OFFSET * MX28::RATIO_ANGLE2VALUE;
+		m_Joint.SetValue(id[i], MX28::Angle2Value(0.0) + (int)offset);
+	}
+}
+
+void PreviewWalking::Process()
+{
+	update_command();
+	update_gain();
+
+	if(m_Real_Running == false)
+	{
+		update_joints();
+		return;
+	}
+
+	plan_steps();
+	update_reference();
+	control(&m_ComX, &m_ErrorSumX, m_RefX);
+	control(&m_ComY, &m_ErrorSumY, m_RefY);
+	update_joints();
+
+	// next tick
+	double step_time = PERIOD_TIME / 2;
+	m_StepTime += m_TimeUnit;
+	if(m_StepTime < step_time - m_TimeUnit / 2)
+		return;
+
+	Footstep &s = m_Step[0];
+	if(m_StepCount == 1 && s.swing == STAND && m_Ctrl_Running == false)
+	{
+		// the last step: the walk ends once the body settled over the feet
+		m_StepTime = step_time;
+		if(fabs(m_ComX(0, 0) - s.zmp_x) < 1 && fabs(m_ComY(0, 0) - s.zmp_y) < 1
+				&& fabs(m_ComX(1, 0)) < 5 && fabs(m_ComY(1, 0)) < 5)
+		{
+			m_ZMP_X = s.zmp_x;
+			m_ZMP_Y = s.zmp_y;
+			m_Body_X = s.body_x;
+			m_Body_Y = s.body_y;
+			m_Body_A = s.body_a;
+			m_StepCount = 0;
+			m_StepTime = 0;
+			m_Real_Running = false;
+		}
+		return;
+	}
+
+	if(s.swing != STAND)
+	{
+		m_Foot_X[s.swing] = s.x;
+		m_Foot_Y[s.swing] = s.y;
+		m_Foot_A[s.swing] = s.a;
+	}
+	m_ZMP_X = s.zmp_x;
+	m_ZMP_Y = s.zmp_y;
+	m_Body_X = s.body_x;
+	m_Body_Y = s.body_y;
+	m_Body_A = s.body_a;
+	for(int k = 1; k < m_StepCount; k++)
+		m_Step[k - 1] = m_Step[k];
+	m_StepCount--;
+	m_StepTime -= step_time;
+	if(m_StepTime < 0)
+		m_StepTime = 0;
+}
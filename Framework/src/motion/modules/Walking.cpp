@@ -6,8 +6,6 @@
  */
 #include <stdio.h>
 #include <math.h>
-#include "Vector.h"
-#include "Matrix.h"
 #include "MX28.h"
 #include "MotionStatus.h"
 #include "Kinematics.h"
@@ -22,6 +20,18 @@ Walking* Walking::m_UniqueInstance = new Walking();
 
 Walking::Walking()
 {
+	m_CommandSequence = 0;
+	m_MoveCount = 0;
+	m_AimCount = 0;
+	m_Velocity_On = false;
+	m_X_Velocity = 0;
+	m_Y_Velocity = 0;
+	m_A_Velocity = 0;
+	m_Wave_PeriodTime = 0;
+	m_Wave_DSP_Ratio = 0;
+	m_IKFailCount = 0;
+	for(int i = 0; i < 12; i++)
+		m_Endpoint[i] = 0;
 	X_OFFSET = -10;
 	Y_OFFSET = 5;
 	Z_OFFSET = 20;
@@ -50,6 +60,9 @@ Walking::Walking()
 	Y_MOVE_AMPLITUDE = 0;
 	A_MOVE_AMPLITUDE = 0;	
 	A_MOVE_AIM_ON = false;
+	X_MOVE_ACCEL = 5;
+	Y_MOVE_ACCEL = 5;
+	A_MOVE_ACCEL = 10;
 	BALANCE_ENABLE = true;
 
 	m_Joint.SetAngle(JointData::ID_R_SHOULDER_PITCH, -48.345);
@@ -104,6 +117,9 @@ void Walking::LoadINISettings(minIni* ini, const std::string &section)
     if((value = ini->getd(section, "swing_top_down", INVALID_VALUE)) != INVALID_VALUE)          Z_SWAP_AMPLITUDE = value;
     if((value = ini->getd(section, "pelvis_offset", INVALID_VALUE)) != INVALID_VALUE)           PELVIS_OFFSET = value;
     if((value = ini->getd(section, "arm_swing_gain", INVALID_VALUE)) != INVALID_VALUE)          ARM_SWING_GAIN = value;
+    if((value = ini->getd(section, "step_accel_forward_back", INVALID_VALUE)) != INVALID_VALUE) X_MOVE_ACCEL = value;
+    if((value = ini->getd(section, "step_accel_right_left", INVALID_VALUE)) != INVALID_VALUE)   Y_MOVE_ACCEL = value;
+    if((value = ini->getd(section, "step_accel_direction", INVALID_VALUE)) != INVALID_VALUE)    A_MOVE_ACCEL = value;
     if((value = ini->getd(section, "balance_knee_gain", INVALID_VALUE)) != INVALID_VALUE)       BALANCE_KNEE_GAIN = value;
     if((value = ini->getd(section, "balance_ankle_pitch_gain", INVALID_VALUE)) != INVALID_VALUE)BALANCE_ANKLE_PITCH_GAIN = value;
     if((value = ini->getd(section, "balance_hip_roll_gain", INVALID_VALUE)) != INVALID_VALUE)   BALANCE_HIP_ROLL_GAIN = value;
@@ -136,6 +152,9 @@ void Walking::SaveINISettings(minIni* ini, const std::string &section)
     ini->put(section,   "swing_top_down",           Z_SWAP_AMPLITUDE);
     ini->put(section,   "pelvis_offset",            PELVIS_OFFSET);
     ini->put(section,   "arm_swing_gain",           ARM_SWING_GAIN);
+    ini->put(section,   "step_accel_forward_back",  X_MOVE_ACCEL);
+    ini->put(section,   "step_accel_right_left",    Y_MOVE_ACCEL);
+    ini->put(section,   "step_accel_direction",     A_MOVE_ACCEL);
     ini->put(section,   "balance_knee_gain",        BALANCE_KNEE_GAIN);
     ini->put(section,   "balance_ankle_pitch_gain", BALANCE_ANKLE_PITCH_GAIN);
     ini->put(section,   "balance_hip_roll_gain",    BALANCE_HIP_ROLL_GAIN);
@@ -146,88 +165,23 @@ void Walking::SaveINISettings(minIni* ini, const std::string &section)
     ini->put(section,   "d_gain",                   D_GAIN);
 }
 
-double Walking::wsin(double time, double period, double period_shift, double mag, double mag_shift)
+double Walking::wave_sin(const Wave &wave, double time)
 {
-	return mag * sin(2 * 3.141592 / period * time - period_shift) + mag_shift;
+	return sin(wave.omega * time - wave.shift);
 }
 
-bool Walking::computeIK(double *out, double x, double y, double z, double a, double b, double c)
+void Walking::set_wave(Wave *wave, double period, double shift)
 {
-	Matrix3D Tad, Tda, Tcd, Tdc, Tac;
-	Vector3D vec;
-    double _Rac, _Acos, _Atan, _k, _l, _m, _n, _s, _c, _theta;
-	double LEG_LENGTH = Kinematics::LEG_LENGTH;
-	double THIGH_LENGTH = Kinematics::THIGH_LENGTH;
-	double CALF_LENGTH = Kinematics::CALF_LENGTH;
-	double ANKLE_LENGTH = Kinematics::ANKLE_LENGTH;
-
-	Tad.SetTransform(Point3D(x, y, z - LEG_LENGTH), Vector3D(a * 180.0 / PI, b * 180.0 / PI, c * 180.0 / PI));
-
-	vec.X = x + Tad.m[2] * ANKLE_LENGTH;
-    vec.Y = y + Tad.m[6] * ANKLE_LENGTH;
-    vec.Z = (z - LEG_LENGTH) + Tad.m[10] * ANKLE_LENGTH;
-
-    // Get Knee
-	_Rac = vec.Length();
-    _Acos = acos((_Rac * _Rac - THIGH_LENGTH * THIGH_LENGTH - CALF_LENGTH * CALF_LENGTH) / (2 * THIGH_LENGTH * CALF_LENGTH));
-    if(isnan(_Acos) == 1)
-		return false;
-    *(out + 3) = _Acos;
-
-    // Get Ankle Roll
-    Tda = Tad;
-	if(Tda.Inverse() == false)
-        return false;
-    _k = sqrt(Tda.m[7] * Tda.m[7] + Tda.m[11] * Tda.m[11]);
-    _l = sqrt(Tda.m[7] * Tda.m[7] + (Tda.m[11] - ANKLE_LENGTH) * (Tda.m[11] - ANKLE_LENGTH));
-    _m = (_k * _k - _l * _l - ANKLE_LENGTH * ANKLE_LENGTH) / (2 * _l * ANKLE_LENGTH);
-    if(_m > 1.0)
-        _m = 1.0;
-    else if(_m < -1.0)
-        _m = -1.0;
-    _Acos = acos(_m);
-    if(isnan(_Acos) == 1)
-        return false;
-    if(Tda.m[7] < 0.0)
-        *(out + 5) = -_Acos;
-    else
-        *(out + 5) = _Acos;
-
-    // Get Hip Yaw
-	Tcd.SetTransform(Point3D(0, 0, -ANKLE_LENGTH), Vector3D(*(out + 5) * 180.0 / PI, 0, 0));
-	Tdc = Tcd;
-	if(Tdc.Inverse() == false)
-        return false;
-	Tac = Tad * Tdc;
-    _Atan = atan2(-Tac.m[1] , Tac.m[5]);
-    if(isinf(_Atan) == 1)
-        return false;
-    *(out) = _Atan;
-
-    // Get Hip Roll
-    _Atan = atan2(Tac.m[9], -Tac.m[1] * sin(*(out)) + Tac.m[5] * cos(*(out)));
-    if(isinf(_Atan) == 1)
-        return false;
-    *(out + 1) = _Atan;
-
-    // Get Hip Pitch and Ankle Pitch
-    _Atan = atan2(Tac.m[2] * cos(*(out)) + Tac.m[6] * sin(*(out)), Tac.m[0] * cos(*(out)) + Tac.m[4] * sin(*(out)));
-    if(isinf(_Atan) == 1)
-        return false;
-    _theta = _Atan;
-    _k = sin(*(out + 3)) * CALF_LENGTH;
-    _l = -THIGH_LENGTH - cos(*(out + 3)) * CALF_LENGTH;
-	_m = cos(*(out)) * vec.X + sin(*(out)) * vec.Y;
-	_n = cos(*(out + 1)) * vec.Z + sin(*(out)) * sin(*(out + 1)) * vec.X - cos(*(out)) * sin(*(out + 1)) * vec.Y;
-    _s = (_k * _n + _l * _m) / (_k * _k + _l * _l);
-    _c = (_n - _k * _s) / _l;
-    _Atan = atan2(_s, _c);
-    if(isinf(_Atan) == 1)
-        return false;
-    *(out + 2) = _Atan;
-    *(out + 4) = _theta - *(out + 3) - *(out + 2);
-
-    return true;
+	wave->omega = 2 * 3.141592 / period;
+	wave->shift = shift;
+}
+
+void Walking::set_hold(double *hold, const Wave &wave_l, const Wave &wave_r)
+{
+	hold[HOLD_START_L] = wave_sin(wave_l, m_SSP_Time_Start_L);
+	hold[HOLD_END_L] = wave_sin(wave_l, m_SSP_Time_End_L);
+	hold[HOLD_START_R] = wave_sin(wave_r, m_SSP_Time_Start_R);
+	hold[HOLD_END_R] = wave_sin(wave_r, m_SSP_Time_End_R);
 }
 
 void Walking::update_param_time()
@@ -257,6 +211,33 @@ void Walking::update_param_time()
     m_Pelvis_Offset = PELVIS_OFFSET*MX28::RATIO_ANGLE2VALUE;
     m_Pelvis_Swing = m_Pelvis_Offset * 0.35;
     m_Arm_Swing_Gain = ARM_SWING_GAIN;
+
+    // Gait coefficients, only when the timing changed: this runs every tick
+    // while the robot stands
+    if(m_PeriodTime == m_Wave_PeriodTime && m_DSP_Ratio == m_Wave_DSP_Ratio)
+        return;
+    m_Wave_PeriodTime = m_PeriodTime;
+    m_Wave_DSP_Ratio = m_DSP_Ratio;
+
+    // a left foot move starts at m_SSP_Time_Start_L and a right one half a
+    // period later at m_SSP_Time_Start_R
+    set_wave(&m_X_Swap_Wave, m_X_Swap_PeriodTime, m_X_Swap_Phase_Shift);
+    set_wave(&m_Y_Swap_Wave, m_Y_Swap_PeriodTime, m_Y_Swap_Phase_Shift);
+    set_wave(&m_Z_Swap_Wave, m_Z_Swap_PeriodTime, m_Z_Swap_Phase_Shift);
+    set_wave(&m_X_Move_Wave_L, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L);
+    set_wave(&m_X_Move_Wave_R, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_R + PI);
+    set_wave(&m_Y_Move_Wave_L, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L);
+    set_wave(&m_Y_Move_Wave_R, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_R + PI);
+    set_wave(&m_Z_Move_Wave_L, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L);
+    set_wave(&m_Z_Move_Wave_R, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R);
+    set_wave(&m_A_Move_Wave_L, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L);
+    set_wave(&m_A_Move_Wave_R, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_R + PI);
+    set_wave(&m_Arm_Swing_Wave, m_PeriodTime, PI * 1.5);
+
+    set_hold(m_X_Move_Hold, m_X_Move_Wave_L, m_X_Move_Wave_R);
+    set_hold(m_Y_Move_Hold, m_Y_Move_Wave_L, m_Y_Move_Wave_R);
+    set_hold(m_Z_Move_Hold, m_Z_Move_Wave_L, m_Z_Move_Wave_R);
+    set_hold(m_A_Move_Hold, m_A_Move_Wave_L, m_A_Move_Wave_R);
 }
 
 void Walking::update_param_move()
@@ -328,9 +309,23 @@ void Walking::Initialize()
     m_Z_Move_Phase_Shift = PI / 2;
     m_A_Move_Phase_Shift = PI / 2;
 
+	Command *cmd = m_Command.BeginWrite();
+	cmd->x_move = 0;
+	cmd->y_move = 0;
+	cmd->a_move = 0;
+	cmd->a_move_aim_on = A_MOVE_AIM_ON;
+	cmd->velocity = false;
+	cmd->running = false;
+	m_MoveCount = cmd->move_count;
+	m_AimCount = cmd->aim_count;
+	m_Command.EndWrite();
+	m_CommandSequence = m_Command.GetSequence();
+	m_Velocity_On = false;
+
 	m_Ctrl_Running = false;
     m_Real_Running = false;
     m_Time = 0;
+    m_Wave_PeriodTime = 0; // phase shifts are set above, rebuild the coefficients
     update_param_time();
     update_param_move();
 
@@ -339,13 +334,117 @@ void Walking::Initialize()
 
 void Walking::Start()
 {
-	m_Ctrl_Running = true;
-    m_Real_Running = true;
+	Command *cmd = m_Command.BeginWrite();
+	cmd->running = true;
+	m_Command.EndWrite();
 }
 
 void Walking::Stop()
 {
-	m_Ctrl_Running = false;
+	Command *cmd = m_Command.BeginWrite();
+	cmd->running = false;
+	m_Command.EndWrite();
+}
+
+void Walking::SetMoveAmplitude(double x, double y, double a)
+{
+	Command *cmd = m_Command.BeginWrite();
+	cmd->x_move = x;
+	cmd->y_move = y;
+	cmd->a_move = a;
+	cmd->velocity = false;
+	cmd->move_count++;
+	m_Command.EndWrite();
+}
+
+void Walking::SetVelocity(double x, double y, double a)
+{
+	Command *cmd = m_Command.BeginWrite();
+	cmd->x_move = x;
+	cmd->y_move = y;
+	cmd->a_move = a;
+	cmd->velocity = true;
+	cmd->move_count++;
+	m_Command.EndWrite();
+}
+
+void Walking::SetMoveAimOn(bool aim_on)
+{
+	Command *cmd = m_Command.BeginWrite();
+	cmd->a_move_aim_on = aim_on;
+	cmd->aim_count++;
+	m_Command.EndWrite();
+}
+
+void Walking::GetMoveAmplitude(double *x, double *y, double *a)
+{
+	Command cmd;
+	m_Command.Read(&cmd);
+	*x = cmd.x_move;
+	*y = cmd.y_move;
+	*a = cmd.a_move;
+}
+
+bool Walking::GetMoveAimOn()
+{
+	Command cmd;
+	m_Command.Read(&cmd);
+	return cmd.a_move_aim_on;
+}
+
+void Walking::update_command()
+{
+	Command cmd;
+	unsigned int seq;
+
+	// a command being written is picked up on the next tick
+	if(m_Command.TryRead(&cmd, &seq) == false || seq == m_CommandSequence)
+		return;
+
+	m_CommandSequence = seq;
+	m_Ctrl_Running = cmd.running;
+	if(cmd.running == true)
+		m_Real_Running = true;
+
+	if(cmd.move_count != m_MoveCount)
+	{
+		m_MoveCount = cmd.move_count;
+		m_Velocity_On = cmd.velocity;
+		if(cmd.velocity == true)
+		{
+			m_X_Velocity = cmd.x_move;
+			m_Y_Velocity = cmd.y_move;
+			m_A_Velocity = cmd.a_move;
+		}
+		else
+		{
+			X_MOVE_AMPLITUDE = cmd.x_move;
+			Y_MOVE_AMPLITUDE = cmd.y_move;
+			A_MOVE_AMPLITUDE = cmd.a_move;
+		}
+	}
+
+	if(cmd.aim_count != m_AimCount)
+	{
+		m_AimCount = cmd.aim_count;
+		A_MOVE_AIM_ON = cmd.a_move_aim_on;
+	}
+}
+
+void Walking::update_velocity()
+{
+	// once stopped, the amplitudes are zeroed at the next phase boundary and
+	// taken over by the PHASE1/PHASE3 latch, like SetMoveAmplitude() ones
+	if(m_Velocity_On == false || m_Real_Running == false || m_Ctrl_Running == false)
+		return;
+
+	// a step is half a period, the amplitudes move toward the command in
+	// equal parts every tick and reach it exactly
+	double step = m_TimeUnit * 2 / m_PeriodTime;
+	X_MOVE_AMPLITUDE = Approach(X_MOVE_AMPLITUDE, m_X_Velocity, X_MOVE_ACCEL * step);
+	Y_MOVE_AMPLITUDE = Approach(Y_MOVE_AMPLITUDE, m_Y_Velocity, Y_MOVE_ACCEL * step);
+	A_MOVE_AMPLITUDE = Approach(A_MOVE_AMPLITUDE, m_A_Velocity, A_MOVE_ACCEL * step);
+	update_param_move();
 }
 		
 bool Walking::IsRunning()
@@ -359,14 +458,18 @@ void Walking::Process()
     double x_move_r, y_move_r, z_move_r, a_move_r, b_move_r, c_move_r;
     double x_move_l, y_move_l, z_move_l, a_move_l, b_move_l, c_move_l;
     double pelvis_offset_r, pelvis_offset_l;
-    double angle[14], ep[12];
+    double x_sin, y_sin, z_sin_l, z_sin_r, a_sin;
+    double angle[14], *ep = m_Endpoint;
 	double offset;
-	double TIME_UNIT = MotionModule::TIME_UNIT;
+	double TIME_UNIT = m_TimeUnit;
 	//                     R_HIP_YAW, R_HIP_ROLL, R_HIP_PITCH, R_KNEE, R_ANKLE_PITCH, R_ANKLE_ROLL, L_HIP_YAW, L_HIP_ROLL, L_HIP_PITCH, L_KNEE, L_ANKLE_PITCH, L_ANKLE_ROLL, R_ARM_SWING, L_ARM_SWING
 	int dir[14]          = {   -1,        -1,          1,         1,         -1,            1,          -1,        -1,         -1,         -1,         1,            1,           1,           -1      };
     double initAngle[14] = {   0.0,       0.0,        0.0,       0.0,        0.0,          0.0,         0.0,       0.0,        0.0,        0.0,       0.0,          0.0,       -48.345,       41.313    };
 	int outValue[14];
 
+	update_command();
+	update_velocity();
+
     // Update walk parameters
     if(m_Time == 0)
     {
@@ -417,80 +520,74 @@ void Walking::Process()
     }
     update_param_balance();
 
-    // Compute endpoints
-    x_swap = wsin(m_Time, m_X_Swap_PeriodTime, m_X_Swap_Phase_Shift, m_X_Swap_Amplitude, m_X_Swap_Amplitude_Shift);
-    y_swap = wsin(m_Time, m_Y_Swap_PeriodTime, m_Y_Swap_Phase_Shift, m_Y_Swap_Amplitude, m_Y_Swap_Amplitude_Shift);
-    z_swap = wsin(m_Time, m_Z_Swap_PeriodTime, m_Z_Swap_Phase_Shift, m_Z_Swap_Amplitude, m_Z_Swap_Amplitude_Shift);
+    // Compute endpoints. Sines are shared by both feet and by the pelvis, and
+    // taken from the hold tables while a foot stays on the ground.
+    x_swap = m_X_Swap_Amplitude * wave_sin(m_X_Swap_Wave, m_Time) + m_X_Swap_Amplitude_Shift;
+    y_swap = m_Y_Swap_Amplitude * wave_sin(m_Y_Swap_Wave, m_Time) + m_Y_Swap_Amplitude_Shift;
+    z_swap = m_Z_Swap_Amplitude * wave_sin(m_Z_Swap_Wave, m_Time) + m_Z_Swap_Amplitude_Shift;
     a_swap = 0;
     b_swap = 0;
     c_swap = 0;
 
     if(m_Time <= m_SSP_Time_Start_L)
     {
-        x_move_l = wsin(m_SSP_Time_Start_L, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, m_X_Move_Amplitude, m_X_Move_Amplitude_Shift);
-        y_move_l = wsin(m_SSP_Time_Start_L, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, m_Y_Move_Amplitude, m_Y_Move_Amplitude_Shift);
-        z_move_l = wsin(m_SSP_Time_Start_L, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
-        c_move_l = wsin(m_SSP_Time_Start_L, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, m_A_Move_Amplitude, m_A_Move_Amplitude_Shift);
-        x_move_r = wsin(m_SSP_Time_Start_L, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, -m_X_Move_Amplitude, -m_X_Move_Amplitude_Shift);
-        y_move_r = wsin(m_SSP_Time_Start_L, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, -m_Y_Move_Amplitude, -m_Y_Move_Amplitude_Shift);
-        z_move_r = wsin(m_SSP_Time_Start_R, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
-        c_move_r = wsin(m_SSP_Time_Start_L, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, -m_A_Move_Amplitude, -m_A_Move_Amplitude_Shift);
+        x_sin = m_X_Move_Hold[HOLD_START_L];
+        y_sin = m_Y_Move_Hold[HOLD_START_L];
+        a_sin = m_A_Move_Hold[HOLD_START_L];
+        z_sin_l = m_Z_Move_Hold[HOLD_START_L];
+        z_sin_r = m_Z_Move_Hold[HOLD_START_R];
         pelvis_offset_l = 0;
         pelvis_offset_r = 0;
     }
     else if(m_Time <= m_SSP_Time_End_L)
     {
-        x_move_l = wsin(m_Time, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, m_X_Move_Amplitude, m_X_Move_Amplitude_Shift);
-        y_move_l = wsin(m_Time, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, m_Y_Move_Amplitude, m_Y_Move_Amplitude_Shift);
-        z_move_l = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
-        c_move_l = wsin(m_Time, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, m_A_Move_Amplitude, m_A_Move_Amplitude_Shift);
-        x_move_r = wsin(m_Time, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, -m_X_Move_Amplitude, -m_X_Move_Amplitude_Shift);
-        y_move_r = wsin(m_Time, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, -m_Y_Move_Amplitude, -m_Y_Move_Amplitude_Shift);
-        z_move_r = wsin(m_SSP_Time_Start_R, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
-        c_move_r = wsin(m_Time, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, -m_A_Move_Amplitude, -m_A_Move_Amplitude_Shift);
-        pelvis_offset_l = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Pelvis_Swing / 2, m_Pelvis_Swing / 2);
-        pelvis_offset_r = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, -m_Pelvis_Offset / 2, -m_Pelvis_Offset / 2);
+        x_sin = wave_sin(m_X_Move_Wave_L, m_Time);
+        y_sin = wave_sin(m_Y_Move_Wave_L, m_Time);
+        a_sin = wave_sin(m_A_Move_Wave_L, m_Time);
+        z_sin_l = wave_sin(m_Z_Move_Wave_L, m_Time);
+        z_sin_r = m_Z_Move_Hold[HOLD_START_R];
+        pelvis_offset_l = m_Pelvis_Swing / 2 * z_sin_l + m_Pelvis_Swing / 2;
+        pelvis_offset_r = -m_Pelvis_Offset / 2 * z_sin_l + -m_Pelvis_Offset / 2;
     }
     else if(m_Time <= m_SSP_Time_Start_R)
     {
-        x_move_l = wsin(m_SSP_Time_End_L, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, m_X_Move_Amplitude, m_X_Move_Amplitude_Shift);
-        y_move_l = wsin(m_SSP_Time_End_L, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, m_Y_Move_Amplitude, m_Y_Move_Amplitude_Shift);
-        z_move_l = wsin(m_SSP_Time_End_L, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
-        c_move_l = wsin(m_SSP_Time_End_L, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, m_A_Move_Amplitude, m_A_Move_Amplitude_Shift);
-        x_move_r = wsin(m_SSP_Time_End_L, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, -m_X_Move_Amplitude, -m_X_Move_Amplitude_Shift);
-        y_move_r = wsin(m_SSP_Time_End_L, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, -m_Y_Move_Amplitude, -m_Y_Move_Amplitude_Shift);
-        z_move_r = wsin(m_SSP_Time_Start_R, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
-        c_move_r = wsin(m_SSP_Time_End_L, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, -m_A_Move_Amplitude, -m_A_Move_Amplitude_Shift);
+        x_sin = m_X_Move_Hold[HOLD_END_L];
+        y_sin = m_Y_Move_Hold[HOLD_END_L];
+        a_sin = m_A_Move_Hold[HOLD_END_L];
+        z_sin_l = m_Z_Move_Hold[HOLD_END_L];
+        z_sin_r = m_Z_Move_Hold[HOLD_START_R];
         pelvis_offset_l = 0;
         pelvis_offset_r = 0;
     }
     else if(m_Time <= m_SSP_Time_End_R)
     {
-        x_move_l = wsin(m_Time, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_X_Move_Amplitude, m_X_Move_Amplitude_Shift);
-        y_move_l = wsin(m_Time, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_Y_Move_Amplitude, m_Y_Move_Amplitude_Shift);
-        z_move_l = wsin(m_SSP_Time_End_L, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
-        c_move_l = wsin(m_Time, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_A_Move_Amplitude, m_A_Move_Amplitude_Shift);
-        x_move_r = wsin(m_Time, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_X_Move_Amplitude, -m_X_Move_Amplitude_Shift);
-        y_move_r = wsin(m_Time, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_Y_Move_Amplitude, -m_Y_Move_Amplitude_Shift);
-        z_move_r = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
-        c_move_r = wsin(m_Time, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_A_Move_Amplitude, -m_A_Move_Amplitude_Shift);
-        pelvis_offset_l = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Pelvis_Offset / 2, m_Pelvis_Offset / 2);
-        pelvis_offset_r = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, -m_Pelvis_Swing / 2, -m_Pelvis_Swing / 2);
+        x_sin = wave_sin(m_X_Move_Wave_R, m_Time);
+        y_sin = wave_sin(m_Y_Move_Wave_R, m_Time);
+        a_sin = wave_sin(m_A_Move_Wave_R, m_Time);
+        z_sin_l = m_Z_Move_Hold[HOLD_END_L];
+        z_sin_r = wave_sin(m_Z_Move_Wave_R, m_Time);
+        pelvis_offset_l = m_Pelvis_Offset / 2 * z_sin_r + m_Pelvis_Offset / 2;
+        pelvis_offset_r = -m_Pelvis_Swing / 2 * z_sin_r + -m_Pelvis_Swing / 2;
     }
     else
     {
-        x_move_l = wsin(m_SSP_Time_End_R, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_X_Move_Amplitude, m_X_Move_Amplitude_Shift);
-        y_move_l = wsin(m_SSP_Time_End_R, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_Y_Move_Amplitude, m_Y_Move_Amplitude_Shift);
-        z_move_l = wsin(m_SSP_Time_End_L, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
-        c_move_l = wsin(m_SSP_Time_End_R, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_A_Move_Amplitude, m_A_Move_Amplitude_Shift);
-        x_move_r = wsin(m_SSP_Time_End_R, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_X_Move_Amplitude, -m_X_Move_Amplitude_Shift);
-        y_move_r = wsin(m_SSP_Time_End_R, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_Y_Move_Amplitude, -m_Y_Move_Amplitude_Shift);
-        z_move_r = wsin(m_SSP_Time_End_R, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
-        c_move_r = wsin(m_SSP_Time_End_R, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_A_Move_Amplitude, -m_A_Move_Amplitude_Shift);
+        x_sin = m_X_Move_Hold[HOLD_END_R];
+        y_sin = m_Y_Move_Hold[HOLD_END_R];
+        a_sin = m_A_Move_Hold[HOLD_END_R];
+        z_sin_l = m_Z_Move_Hold[HOLD_END_L];
+        z_sin_r = m_Z_Move_Hold[HOLD_END_R];
         pelvis_offset_l = 0;
         pelvis_offset_r = 0;
     }
 
+    x_move_l = m_X_Move_Amplitude * x_sin + m_X_Move_Amplitude_Shift;
+    y_move_l = m_Y_Move_Amplitude * y_sin + m_Y_Move_Amplitude_Shift;
+    z_move_l = m_Z_Move_Amplitude * z_sin_l + m_Z_Move_Amplitude_Shift;
+    c_move_l = m_A_Move_Amplitude * a_sin + m_A_Move_Amplitude_Shift;
+    x_move_r = -m_X_Move_Amplitude * x_sin + -m_X_Move_Amplitude_Shift;
+    y_move_r = -m_Y_Move_Amplitude * y_sin + -m_Y_Move_Amplitude_Shift;
+    z_move_r = m_Z_Move_Amplitude * z_sin_r + m_Z_Move_Amplitude_Shift;
+    c_move_r = -m_A_Move_Amplitude * a_sin + -m_A_Move_Amplitude_Shift;
     a_move_l = 0;
     b_move_l = 0;
     a_move_r = 0;
@@ -530,8 +627,9 @@ void Walking::Process()
     }
     else
     {
-        angle[12] = wsin(m_Time, m_PeriodTime, PI * 1.5, -m_X_Move_Amplitude * m_Arm_Swing_Gain, 0);
-        angle[13] = wsin(m_Time, m_PeriodTime, PI * 1.5, m_X_Move_Amplitude * m_Arm_Swing_Gain, 0);
+        double arm_sin = wave_sin(m_Arm_Swing_Wave, m_Time);
+        angle[12] = -m_X_Move_Amplitude * m_Arm_Swing_Gain * arm_sin;
+        angle[13] = m_X_Move_Amplitude * m_Arm_Swing_Gain * arm_sin;
     }
 
     if(m_Real_Running == true)
@@ -542,14 +640,15 @@ void Walking::Process()
     }
 
     // Compute angles
-    if((computeIK(&angle[0], ep[0], ep[1], ep[2], ep[3], ep[4], ep[5]) == 1)
-        && (computeIK(&angle[6], ep[6], ep[7], ep[8], ep[9], ep[10], ep[11]) == 1))
+    if((Kinematics::LegIK(&angle[0], ep[0], ep[1], ep[2], ep[3], ep[4], ep[5]) == true)
+        && (Kinematics::LegIK(&angle[6], ep[6], ep[7], ep[8], ep[9], ep[10], ep[11]) == true))
     {
         for(int i=0; i<12; i++)
             angle[i] *= 180.0 / PI;
     }
 	else
 	{
+		m_IKFailCount++;
 		return; // Do not use angle;
 	}
 
@@ -570,8 +669,8 @@ void Walking::Process()
     // adjust balance offset
     if(BALANCE_ENABLE == true)
     {
-		double rlGyroErr = MotionStatus::RL_GYRO;
-		double fbGyroErr = MotionStatus::FB_GYRO;
+		double rlGyroErr = m_MotionStatus->m_RLGyro;
+		double fbGyroErr = m_MotionStatus->m_FBGyro;
 #ifdef MX28_1024
         outValue[1] += (int)(dir[1] * rlGyroErr * BALANCE_HIP_ROLL_GAIN); // R_HIP_ROLL
         outValue[7] += (int)(dir[7] * rlGyroErr * BALANCE_HIP_ROLL_GAIN); // L_HIP_ROLL
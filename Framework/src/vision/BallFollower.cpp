@@ -34,8 +34,6 @@ BallFollower::BallFollower()
 	m_FollowMaxRLTurn = 35.0;
 	m_FitFBStep = 3.0;
 	m_FitMaxRLTurn = 35.0;
-	m_UnitFBStep = 0.3;
-	m_UnitRLTurn = 1.0;
 
 	m_GoalFBStep = 0;
 	m_GoalRLTurn = 0;
@@ -177,29 +175,19 @@ void BallFollower::Process(Point2D ball_pos)
 		if(DEBUG_PRINT == true)
 			fprintf(stderr, " START");
 
+		// Walking ramps its steps to the goal within X/A_MOVE_ACCEL
+		m_FBStep = m_GoalFBStep;
+		m_RLTurn = m_GoalRLTurn;
 		if(Walking::GetInstance()->IsRunning() == false)
 		{
-			m_FBStep = 0;
-			m_RLTurn = 0;
 			m_KickBallCount = 0;
 			KickBall = 0;
-			Walking::GetInstance()->X_MOVE_AMPLITUDE = m_FBStep;
-			Walking::GetInstance()->A_MOVE_AMPLITUDE = m_RLTurn;
+			Walking::GetInstance()->SetVelocity(m_FBStep, 0, m_RLTurn);
 			Walking::GetInstance()->Start();			
 		}
 		else
 		{
-			if(m_FBStep < m_GoalFBStep)
-				m_FBStep += m_UnitFBStep;
-			else if(m_FBStep > m_GoalFBStep)
-				m_FBStep = m_GoalFBStep;
-			Walking::GetInstance()->X_MOVE_AMPLITUDE = m_FBStep;
-
-			if(m_RLTurn < m_GoalRLTurn)
-				m_RLTurn += m_UnitRLTurn;
-			else if(m_RLTurn > m_GoalRLTurn)
-				m_RLTurn -= m_UnitRLTurn;
-			Walking::GetInstance()->A_MOVE_AMPLITUDE = m_RLTurn;
+			Walking::GetInstance()->SetVelocity(m_FBStep, 0, m_RLTurn);
 
 			if(DEBUG_PRINT == true)
 				fprintf(stderr, " (FB:%.1f RL:%.1f)", m_FBStep, m_RLTurn);
@@ -0,0 +1,119 @@
+/*
+ *   LinuxBusArbiter.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+#include <time.h>
+#include "LinuxBusArbiter.h"
+
+using namespace Robot;
+
+
+static double GetMonotonicTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((double)ts.tv_sec*1000000.0 + (double)ts.tv_nsec/1000.0);
+}
+
+LinuxBusArbiter::LinuxBusArbiter()
+{
+    pthread_mutex_init(&m_Mutex, NULL);
+    pthread_cond_init(&m_Cond, NULL);
+    m_Busy = false;
+
+    for(int p = 0; p < NUMBER_OF_PRIORITY; p++)
+    {
+        m_NextTicket[p] = 0;
+        m_ServingTicket[p] = 0;
+    }
+    ResetStatistics();
+}
+
+LinuxBusArbiter::~LinuxBusArbiter()
+{
+    pthread_cond_destroy(&m_Cond);
+    pthread_mutex_destroy(&m_Mutex);
+}
+
+bool LinuxBusArbiter::IsGranted(int priority, unsigned int ticket)
+{
+    if(m_Busy == true || m_ServingTicket[priority] != ticket)
+        return false;
+
+    for(int p = 0; p < priority; p++)
+    {
+        if(m_NextTicket[p] != m_ServingTicket[p])
+            return false;
+    }
+
+    return true;
+}
+
+void LinuxBusArbiter::Acquire(int priority)
+{
+    if(priority < PRIORITY_HIGH)
+        priority = PRIORITY_HIGH;
+    else if(priority > PRIORITY_LOW)
+        priority = PRIORITY_LOW;
+
+    double start = GetMonotonicTime();
+
+    pthread_mutex_lock(&m_Mutex);
+
+    unsigned int ticket = m_NextTicket[priority]++;
+    while(IsGranted(priority, ticket) == false)
+        pthread_cond_wait(&m_Cond, &m_Mutex);
+
+    m_ServingTicket[priority]++;
+    m_Busy = true;
+
+    double wait = GetMonotonicTime() - start;
+    int bin = 0;
+    for(double limit = 1.0; wait >= limit && bin < NUMBER_OF_WAIT_BIN - 1; limit *= 2.0)
+        bin++;
+    m_WaitHistogram[priority][bin]++;
+    if(wait > m_MaxWaitTime[priority])
+        m_MaxWaitTime[priority] = wait;
+
+    pthread_mutex_unlock(&m_Mutex);
+}
+
+void LinuxBusArbiter::Release()
+{
+    pthread_mutex_lock(&m_Mutex);
+    m_Busy = false;
+    pthread_cond_broadcast(&m_Cond);
+    pthread_mutex_unlock(&m_Mutex);
+}
+
+void LinuxBusArbiter::GetWaitHistogram(int priority, unsigned int *bins)
+{
+    pthread_mutex_lock(&m_Mutex);
+    for(int i = 0; i < NUMBER_OF_WAIT_BIN; i++)
+        bins[i] = m_WaitHistogram[priority][i];
+    pthread_mutex_unlock(&m_Mutex);
+}
+
+double LinuxBusArbiter::GetMaxWaitTime(int priority)
+{
+    pthread_mutex_lock(&m_Mutex);
+    double wait = m_MaxWaitTime[priority];
+    pthread_mutex_unlock(&m_Mutex);
+
+    return wait;
+}
+
+void LinuxBusArbiter::ResetStatistics()
+{
+    pthread_mutex_lock(&m_Mutex);
+    for(int p = 0; p < NUMBER_OF_PRIORITY; p++)
+    {
+        for(int i = 0; i < NUMBER_OF_WAIT_BIN; i++)
+            m_WaitHistogram[p][i] = 0;
+        m_MaxWaitTime[p] = 0;
+    }
+    pthread_mutex_unlock(&m_Mutex);
+}
@@ -10,27 +10,34 @@
 #include <string.h>
 #include <fcntl.h>
 #include <termios.h>
-#include <sys/time.h>
+#include <poll.h>
+#include <time.h>
 #include <linux/serial.h>
 #include <sys/ioctl.h>
 #include "LinuxCM730.h"
 
 using namespace Robot;
 
+#define LEGACY_MARGIN           (5.0)   // msec
+#define ADAPTIVE_MIN_MARGIN     (0.2)   // msec
+
 
 LinuxCM730::LinuxCM730(const char* name)
 {
 	DEBUG_PRINT = false;
+	POLL_READ = true;
+	ADAPTIVE_TIMEOUT = true;
 	m_Socket_fd = -1;
 	m_PacketStartTime = 0;
 	m_PacketWaitTime = 0;
+	m_PacketID = -1;
+	m_PacketLength = 0;
 	m_UpdateStartTime = 0;
 	m_UpdateWaitTime = 0;
 	m_ByteTransferTime = 0;
-
-    sem_init(&m_LowSemID, 0, 1);
-    sem_init(&m_MidSemID, 0, 1);
-    sem_init(&m_HighSemID, 0, 1);
+	m_Baudrate = 1000000; //bps (1Mbps)
+	ResetReadTime();
+	ResetTimeoutModel();
 
 	SetPortName(name);
 }
@@ -49,7 +56,7 @@ bool LinuxCM730::OpenPort()
 {
 	struct termios newtio;
     struct serial_struct serinfo;
-	double baudrate = 1000000.0; //bps (1Mbps)
+	double baudrate = m_Baudrate;
     
     ClosePort();
 
@@ -81,7 +88,10 @@ bool LinuxCM730::OpenPort()
 
     serinfo.flags &= ~ASYNC_SPD_MASK;
     serinfo.flags |= ASYNC_SPD_CUST;
-    serinfo.custom_divisor = serinfo.baud_base / baudrate;
+    serinfo.flags |= ASYNC_LOW_LATENCY; // do not let the driver batch replies
+    serinfo.custom_divisor = (int)(serinfo.baud_base / baudrate + 0.5);
+    if(serinfo.custom_divisor < 1)
+        serinfo.custom_divisor = 1;
 	
     if(ioctl(m_Socket_fd, TIOCSSERIAL, &serinfo) < 0)
 	{
@@ -95,6 +105,8 @@ bool LinuxCM730::OpenPort()
 
 	tcflush(m_Socket_fd, TCIFLUSH);
 
+    // the rate the divisor really gives, not the one asked for
+    baudrate = (double)serinfo.baud_base / serinfo.custom_divisor;
     m_ByteTransferTime = (1000.0 / baudrate) * 12.0;
 	
     return true;
@@ -108,32 +120,27 @@ UART_OPEN_ERROR:
 
 bool LinuxCM730::SetBaud(int baud)
 {
-    struct serial_struct serinfo;
-    int baudrate = (int)(2000000.0f / (float)(baud + 1));
+    Protocol1 protocol;
+    int bps = protocol.GetBaudrate(baud);
 
-    if(m_Socket_fd == -1)
+    if(bps == 0)
         return false;
 
-    if(ioctl(m_Socket_fd, TIOCGSERIAL, &serinfo) < 0) {
-        fprintf(stderr, "Cannot get serial info\n");
-        return false;
-    }
-
-    serinfo.flags &= ~ASYNC_SPD_MASK;
-    serinfo.flags |= ASYNC_SPD_CUST;
-    serinfo.custom_divisor = serinfo.baud_base / baudrate;
+    return SetBaudrate(bps);
+}
 
-    if(ioctl(m_Socket_fd, TIOCSSERIAL, &serinfo) < 0) {
-        fprintf(stderr, "Cannot set serial info\n");
+bool LinuxCM730::SetBaudrate(int bps)
+{
+    if(bps <= 0)
         return false;
-    }
 
-    ClosePort();
-    OpenPort();
+    m_Baudrate = bps;
+    ResetTimeoutModel();
 
-    m_ByteTransferTime = (float)((1000.0f / baudrate) * 12.0f * 8);
+    if(m_Socket_fd == -1)
+        return true;
 
-    return true;
+    return OpenPort();
 }
 
 void LinuxCM730::ClosePort()
@@ -155,59 +162,180 @@ int LinuxCM730::WritePort(unsigned char* packet, int numPacket)
 
 int LinuxCM730::ReadPort(unsigned char* packet, int numPacket)
 {
-	return read(m_Socket_fd, packet, numPacket);
+    long long start = GetCurrentTime();
+    long long ready = start;
+
+    // Sleep in the kernel until a byte arrives or the packet deadline passes,
+    // instead of letting the caller spin on an empty non-blocking read.
+    if(POLL_READ == true && m_PacketWaitTime > 0.0)
+    {
+        double remain = m_PacketWaitTime - GetPacketTime();
+        if(remain > 0.0)
+        {
+            struct pollfd pfd;
+            struct timespec ts;
+
+            pfd.fd = m_Socket_fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            ts.tv_sec = (time_t)(remain / 1000.0);
+            ts.tv_nsec = (long)((remain - ts.tv_sec * 1000.0) * 1000000.0);
+
+            int res;
+            do {
+                res = ppoll(&pfd, 1, &ts, NULL);
+            } while(res == -1 && errno == EINTR);
+
+            ready = GetCurrentTime();
+            m_ReadWaitTime += (ready - start) / 1000.0;
+            if(res <= 0)
+                return 0;
+        }
+    }
+
+    int length = read(m_Socket_fd, packet, numPacket);
+
+    m_ReadSpinTime += (GetCurrentTime() - ready) / 1000.0;
+    m_ReadCount++;
+    if(length <= 0)
+        m_EmptyReadCount++;
+
+    return length;
 }
 
-void sem_wait_nointr(sem_t *sem)
+void LinuxCM730::ResetReadTime()
 {
-    int sem_result, sem_count = 0;
-	do {
-	    sem_result = sem_wait(sem);
-    } while((sem_result == -1) && (errno == EINTR));
+    m_ReadWaitTime = 0;
+    m_ReadSpinTime = 0;
+    m_ReadCount = 0;
+    m_EmptyReadCount = 0;
 }
 
 void LinuxCM730::LowPriorityWait()
 {
-    sem_wait_nointr(&m_LowSemID);
+    m_Arbiter.Acquire(LinuxBusArbiter::PRIORITY_LOW);
 }
 
 void LinuxCM730::MidPriorityWait()
 {
-    sem_wait_nointr(&m_MidSemID);
+    m_Arbiter.Acquire(LinuxBusArbiter::PRIORITY_MID);
 }
 
 void LinuxCM730::HighPriorityWait()
 {
-    sem_wait_nointr(&m_HighSemID);
+    m_Arbiter.Acquire(LinuxBusArbiter::PRIORITY_HIGH);
 }
 
 void LinuxCM730::LowPriorityRelease()
 {
-	sem_post(&m_LowSemID);
+	m_Arbiter.Release();
 }
 
 void LinuxCM730::MidPriorityRelease()
 {
-	sem_post(&m_MidSemID);
+	m_Arbiter.Release();
 }
 
 void LinuxCM730::HighPriorityRelease()
 {
-	sem_post(&m_HighSemID);
+	m_Arbiter.Release();
+}
+
+long long LinuxCM730::GetCurrentTime()
+{
+	struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((long long)ts.tv_sec*1000000000LL + (long long)ts.tv_nsec);
+}
+
+double LinuxCM730::GetElapsedTime(long long start)
+{
+    return (double)(GetCurrentTime() - start) / 1000000.0;
 }
 
-double LinuxCM730::GetCurrentTime()
+void LinuxCM730::ResetTimeoutModel()
 {
-	struct timeval tv;
-    gettimeofday(&tv, NULL);
+    for(int i = 0; i < NUMBER_OF_TIMEOUT_MODEL; i++)
+    {
+        m_TimeoutModel[i].samples = 0;
+        m_TimeoutModel[i].latency = 0;
+        m_TimeoutModel[i].deviation = 0;
+    }
+}
+
+void LinuxCM730::UpdateTimeoutModel(TimeoutModel *model, double latency)
+{
+    // smoothed mean and mean deviation, as in the TCP retransmit timer
+    if(model->samples == 0)
+    {
+        model->latency = latency;
+        model->deviation = latency / 2.0;
+    }
+    else
+    {
+        double err = latency - model->latency;
+        model->latency += err / 8.0;
+        model->deviation += ((err < 0 ? -err : err) - model->deviation) / 4.0;
+    }
 
-    return ((double)tv.tv_sec*1000.0 + (double)tv.tv_usec/1000.0);
+    if(model->samples < ADAPTIVE_MIN_SAMPLES)
+        model->samples++;
 }
 
 void LinuxCM730::SetPacketTimeout(int lenPacket)
 {
-	m_PacketStartTime = GetCurrentTime();
-    m_PacketWaitTime = m_ByteTransferTime * (double)lenPacket + 5.0;
+	SetPacketTimeout(-1, lenPacket);
+}
+
+void LinuxCM730::SetPacketTimeout(int id, int lenPacket)
+{
+    double wire = m_ByteTransferTime * (double)lenPacket;
+    double margin = LEGACY_MARGIN;
+
+    m_PacketStartTime = GetCurrentTime();
+    m_PacketID = id;
+    m_PacketLength = lenPacket;
+
+    if(ADAPTIVE_TIMEOUT == true && id >= 0 && id < NUMBER_OF_TIMEOUT_MODEL)
+    {
+        TimeoutModel *model = &m_TimeoutModel[id];
+        // an ID that never answered borrows what the other servos taught us
+        if(model->samples < ADAPTIVE_MIN_SAMPLES && id != CM730::ID_BROADCAST)
+            model = &m_TimeoutModel[MODEL_ANY];
+
+        if(model->samples >= ADAPTIVE_MIN_SAMPLES)
+        {
+            margin = model->latency + 4.0 * model->deviation;
+            if(margin < ADAPTIVE_MIN_MARGIN)
+                margin = ADAPTIVE_MIN_MARGIN;
+            else if(margin > LEGACY_MARGIN)
+                margin = LEGACY_MARGIN;
+        }
+    }
+
+    m_PacketWaitTime = wire + margin;
+}
+
+void LinuxCM730::PacketReceived()
+{
+    if(m_PacketID < 0 || m_PacketID >= NUMBER_OF_TIMEOUT_MODEL)
+        return;
+
+    double latency = GetPacketTime() - m_ByteTransferTime * (double)m_PacketLength;
+
+    UpdateTimeoutModel(&m_TimeoutModel[m_PacketID], latency);
+    if(m_PacketID != CM730::ID_BROADCAST)
+        UpdateTimeoutModel(&m_TimeoutModel[MODEL_ANY], latency);
+    m_PacketID = -1;
+}
+
+double LinuxCM730::GetLearnedLatency(int id)
+{
+    if(id < 0 || id >= NUMBER_OF_TIMEOUT_MODEL || m_TimeoutModel[id].samples == 0)
+        return -1.0;
+
+    return m_TimeoutModel[id].latency;
 }
 
 bool LinuxCM730::IsPacketTimeout()
@@ -220,13 +348,7 @@ bool LinuxCM730::IsPacketTimeout()
 
 double LinuxCM730::GetPacketTime()
 {
-	double time;
-
-    time = GetCurrentTime() - m_PacketStartTime;
-	if(time < 0.0)
-		m_PacketStartTime = GetCurrentTime();
-
-    return time;
+    return GetElapsedTime(m_PacketStartTime);
 }
 
 void LinuxCM730::SetUpdateTimeout(int msec)
@@ -245,22 +367,16 @@ bool LinuxCM730::IsUpdateTimeout()
 
 double LinuxCM730::GetUpdateTime()
 {
-	double time;
-
-    time = GetCurrentTime() - m_UpdateStartTime;
-	if(time < 0.0)
-		m_UpdateStartTime = GetCurrentTime();
-
-    return time;
+    return GetElapsedTime(m_UpdateStartTime);
 }
 
 void LinuxCM730::Sleep(double msec)
 {
-    double start_time = GetCurrentTime();
-    double curr_time = start_time;
+    long long start_time = GetCurrentTime();
+    double elapsed = 0;
 
     do {
-        usleep((start_time + msec) - curr_time);
-        curr_time = GetCurrentTime();
-    } while(curr_time - start_time < msec);
+        usleep((useconds_t)((msec - elapsed) * 1000.0));
+        elapsed = GetElapsedTime(start_time);
+    } while(elapsed < msec);
 }
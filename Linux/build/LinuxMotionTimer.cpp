@@ -8,32 +8,90 @@
 #include "MotionModule.h"
 #include "LinuxMotionTimer.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sched.h>
+#include <sys/mman.h>
 
 using namespace Robot;
 
+static long long GetTime()
+{
+    struct timespec tv;
+    clock_gettime(CLOCK_MONOTONIC, &tv);
+
+    return (long long)tv.tv_sec * 1000000000LL + tv.tv_nsec;
+}
+
 LinuxMotionTimer::LinuxMotionTimer(MotionManager* manager)
     : m_Manager(manager)
 {
+    this->m_Interval_ns = MotionModule::TIME_UNIT * 1000000;
     this->m_FinishTimer = false;
     this->m_TimerRunning = false;
+    this->CATCH_UP = CATCH_UP_COMPRESS;
+    this->LOCK_MEMORY = false;
+    this->CPU_AFFINITY = -1;
+    ResetStatistics();
+}
+
+void LinuxMotionTimer::AddHistogram(unsigned int *bins, double usec)
+{
+    int bin = 0;
+    for(double limit = 1.0; usec >= limit && bin < NUMBER_OF_TIME_BIN - 1; limit *= 2.0)
+        bin++;
+    bins[bin]++;
 }
 
 void *LinuxMotionTimer::TimerProc(void *param)
 {
     LinuxMotionTimer *timer = (LinuxMotionTimer *)param;
-    static struct timespec next_time;
-    clock_gettime(CLOCK_MONOTONIC,&next_time);
+    long long interval = timer->m_Interval_ns;
+    long long next = GetTime();
+    struct timespec next_time;
 
     while(!timer->m_FinishTimer)
     {
-        next_time.tv_sec += (next_time.tv_nsec + MotionModule::TIME_UNIT * 1000000) / 1000000000;
-        next_time.tv_nsec = (next_time.tv_nsec + MotionModule::TIME_UNIT * 1000000) % 1000000000;
+        // the control period may be changed at run time
+        if(timer->m_Manager != NULL)
+            timer->m_Interval_ns = (unsigned long)(timer->m_Manager->GetTimeUnit() * 1000000.0);
+        interval = timer->m_Interval_ns;
+
+        long long release = next;
+        next += interval;
 
+        long long start = GetTime();
         if(timer->m_Manager != NULL)
             timer->m_Manager->Process();
-
+        long long end = GetTime();
+
+        double jitter = (double)(start - release) / 1000.0;
+        double exec = (double)(end - start) / 1000.0;
+        AddHistogram(timer->m_JitterHistogram, jitter);
+        AddHistogram(timer->m_ExecHistogram, exec);
+        if(jitter > timer->m_MaxJitter)
+            timer->m_MaxJitter = jitter;
+        if(exec > timer->m_MaxExecTime)
+            timer->m_MaxExecTime = exec;
+        timer->m_TickCount++;
+
+        if(end > next)
+        {
+            timer->m_OverrunCount++;
+            if(timer->CATCH_UP == CATCH_UP_SKIP)
+            {
+                long long missed = (end - next) / interval + 1;
+                next += missed * interval;
+                timer->m_SkippedCount += (unsigned int)missed;
+            }
+            else if(timer->CATCH_UP == CATCH_UP_LATE)
+                next = end;
+            // CATCH_UP_COMPRESS: 'next' is already due, the loop does not sleep
+        }
+
+        next_time.tv_sec = next / 1000000000LL;
+        next_time.tv_nsec = next % 1000000000LL;
         clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next_time, NULL);
     }
 
@@ -46,6 +104,10 @@ void LinuxMotionTimer::Start(void)
     struct sched_param param;
     pthread_attr_t attr;
 
+    // page faults in the control loop cost milliseconds
+    if(this->LOCK_MEMORY == true && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        printf("mlockall error\n");
+
     pthread_attr_init(&attr);
 
     error = pthread_attr_setschedpolicy(&attr, SCHED_RR);
@@ -61,6 +123,16 @@ void LinuxMotionTimer::Start(void)
     if(error != 0)
         printf("error = %d\n",error);
 
+    if(this->CPU_AFFINITY >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(this->CPU_AFFINITY, &cpus);
+        error = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+        if(error != 0)
+            printf("error = %d\n",error);
+    }
+
     // create and start the thread
     if((error = pthread_create(&this->m_Thread, &attr, this->TimerProc, this))!= 0)
         exit(-1);
@@ -90,6 +162,32 @@ bool LinuxMotionTimer::IsRunning(void)
     return this->m_TimerRunning;
 }
 
+void LinuxMotionTimer::GetJitterHistogram(unsigned int *bins)
+{
+    for(int i = 0; i < NUMBER_OF_TIME_BIN; i++)
+        bins[i] = this->m_JitterHistogram[i];
+}
+
+void LinuxMotionTimer::GetExecHistogram(unsigned int *bins)
+{
+    for(int i = 0; i < NUMBER_OF_TIME_BIN; i++)
+        bins[i] = this->m_ExecHistogram[i];
+}
+
+void LinuxMotionTimer::ResetStatistics()
+{
+    for(int i = 0; i < NUMBER_OF_TIME_BIN; i++)
+    {
+        this->m_JitterHistogram[i] = 0;
+        this->m_ExecHistogram[i] = 0;
+    }
+    this->m_TickCount = 0;
+    this->m_OverrunCount = 0;
+    this->m_SkippedCount = 0;
+    this->m_MaxJitter = 0;
+    this->m_MaxExecTime = 0;
+}
+
 LinuxMotionTimer::~LinuxMotionTimer()
 {
     this->Stop();
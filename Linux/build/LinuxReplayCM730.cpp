@@ -0,0 +1,369 @@
+/*
+ *   LinuxReplayCM730.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include "LinuxReplayCM730.h"
+
+using namespace Robot;
+
+
+LinuxReplayCM730::LinuxReplayCM730(const char* filename, PlatformCM730 *port)
+{
+    DEBUG_PRINT = false;
+    m_Port = port;
+    m_File = 0;
+    m_StartTime = 0;
+    m_HasLine = false;
+    m_ReplyLength = 0;
+    m_ReplyRead = 0;
+    m_Requests = 0;
+    m_Mismatches = 0;
+    m_PacketStartTime = 0;
+    m_PacketWaitTime = 0;
+    m_UpdateStartTime = 0;
+    m_UpdateWaitTime = 0;
+
+    strncpy(m_FileName, filename, sizeof(m_FileName) - 1);
+    m_FileName[sizeof(m_FileName) - 1] = 0;
+}
+
+LinuxReplayCM730::~LinuxReplayCM730()
+{
+    ClosePort();
+}
+
+long long LinuxReplayCM730::GetCurrentTime()
+{
+    struct timespec tv;
+    clock_gettime(CLOCK_MONOTONIC, &tv);
+
+    return (long long)tv.tv_sec * 1000000000LL + tv.tv_nsec;
+}
+
+double LinuxReplayCM730::GetElapsedTime(long long start)
+{
+    return (double)(GetCurrentTime() - start) / 1000000.0;
+}
+
+void LinuxReplayCM730::WriteLine(char type, unsigned char *data, int length)
+{
+    if(m_File == 0)
+        return;
+
+    fprintf(m_File, "%c %.3f", type, GetElapsedTime(m_StartTime));
+    for(int i = 0; i < length; i++)
+        fprintf(m_File, " %.2X", data[i]);
+    fprintf(m_File, "\n");
+}
+
+bool LinuxReplayCM730::NextLine()
+{
+    m_HasLine = false;
+    while(m_File != 0 && fgets(m_Line, sizeof(m_Line), m_File) != 0)
+    {
+        if(m_Line[0] == 'T' || m_Line[0] == 'R')
+        {
+            m_HasLine = true;
+            break;
+        }
+    }
+
+    return m_HasLine;
+}
+
+int LinuxReplayCM730::ParseLine(unsigned char *data, int capacity)
+{
+    char *pos = &m_Line[1];
+    char *end;
+    int length = 0;
+
+    strtod(pos, &end);  // time stamp
+    pos = end;
+
+    while(length < capacity)
+    {
+        long value = strtol(pos, &end, 16);
+        if(end == pos)
+            break;
+        data[length++] = (unsigned char)value;
+        pos = end;
+    }
+
+    return length;
+}
+
+bool LinuxReplayCM730::OpenPort()
+{
+    ClosePort();
+
+    if(m_Port != 0)
+    {
+        m_File = fopen(m_FileName, "w");
+        if(m_File == 0)
+        {
+            if(DEBUG_PRINT == true)
+                fprintf(stderr, "Fail to create %s\n", m_FileName);
+            return false;
+        }
+        m_StartTime = GetCurrentTime();
+        return m_Port->OpenPort();
+    }
+
+    m_File = fopen(m_FileName, "r");
+    if(m_File == 0)
+    {
+        if(DEBUG_PRINT == true)
+            fprintf(stderr, "Fail to open %s\n", m_FileName);
+        return false;
+    }
+    m_StartTime = GetCurrentTime();
+    m_Requests = 0;
+    m_Mismatches = 0;
+    NextLine();
+
+    return true;
+}
+
+bool LinuxReplayCM730::SetBaud(int baud)
+{
+    if(m_Port != 0)
+        return m_Port->SetBaud(baud);
+
+    return true;
+}
+
+bool LinuxReplayCM730::SetBaudrate(int bps)
+{
+    if(m_Port != 0)
+        return m_Port->SetBaudrate(bps);
+
+    return true;
+}
+
+int LinuxReplayCM730::GetBaudrate()
+{
+    if(m_Port != 0)
+        return m_Port->GetBaudrate();
+
+    return 0;
+}
+
+void LinuxReplayCM730::ClosePort()
+{
+    if(m_File != 0)
+        fclose(m_File);
+    m_File = 0;
+    m_HasLine = false;
+
+    if(m_Port != 0)
+        m_Port->ClosePort();
+}
+
+void LinuxReplayCM730::ClearPort()
+{
+    if(m_Port != 0)
+        m_Port->ClearPort();
+
+    m_ReplyLength = 0;
+    m_ReplyRead = 0;
+}
+
+int LinuxReplayCM730::WritePort(unsigned char* packet, int numPacket)
+{
+    if(m_Port != 0)
+    {
+        int res = m_Port->WritePort(packet, numPacket);
+        if(res > 0)
+            WriteLine('T', packet, res);
+        return res;
+    }
+
+    if(m_File == 0)
+        return -1;
+
+    // replies the last request did not consume are dropped
+    while(m_HasLine == true && m_Line[0] != 'T')
+        NextLine();
+
+    m_Requests++;
+    m_ReplyLength = 0;
+    m_ReplyRead = 0;
+    if(m_HasLine == false)
+    {
+        m_Mismatches++;
+        return numPacket;
+    }
+
+    unsigned char logged[MAXNUM_REPLY];
+    int length = ParseLine(logged, MAXNUM_REPLY);
+    if(length != numPacket || memcmp(logged, packet, numPacket) != 0)
+    {
+        m_Mismatches++;
+        if(DEBUG_PRINT == true)
+            fprintf(stderr, "Replay mismatch at request %u\n", m_Requests);
+    }
+
+    while(NextLine() == true && m_Line[0] == 'R')
+        m_ReplyLength += ParseLine(&m_Reply[m_ReplyLength], MAXNUM_REPLY - m_ReplyLength);
+
+    return numPacket;
+}
+
+int LinuxReplayCM730::ReadPort(unsigned char* packet, int numPacket)
+{
+    if(m_Port != 0)
+    {
+        int res = m_Port->ReadPort(packet, numPacket);
+        if(res > 0)
+            WriteLine('R', packet, res);
+        return res;
+    }
+
+    int length = m_ReplyLength - m_ReplyRead;
+    if(length > numPacket)
+        length = numPacket;
+
+    memcpy(packet, &m_Reply[m_ReplyRead], length);
+    m_ReplyRead += length;
+
+    return length;
+}
+
+void LinuxReplayCM730::LowPriorityWait()
+{
+    if(m_Port != 0)
+        m_Port->LowPriorityWait();
+    else
+        m_Arbiter.Acquire(LinuxBusArbiter::PRIORITY_LOW);
+}
+
+void LinuxReplayCM730::MidPriorityWait()
+{
+    if(m_Port != 0)
+        m_Port->MidPriorityWait();
+    else
+        m_Arbiter.Acquire(LinuxBusArbiter::PRIORITY_MID);
+}
+
+void LinuxReplayCM730::HighPriorityWait()
+{
+    if(m_Port != 0)
+        m_Port->HighPriorityWait();
+    else
+        m_Arbiter.Acquire(LinuxBusArbiter::PRIORITY_HIGH);
+}
+
+void LinuxReplayCM730::LowPriorityRelease()
+{
+    if(m_Port != 0)
+        m_Port->LowPriorityRelease();
+    else
+        m_Arbiter.Release();
+}
+
+void LinuxReplayCM730::MidPriorityRelease()
+{
+    if(m_Port != 0)
+        m_Port->MidPriorityRelease();
+    else
+        m_Arbiter.Release();
+}
+
+void LinuxReplayCM730::HighPriorityRelease()
+{
+    if(m_Port != 0)
+        m_Port->HighPriorityRelease();
+    else
+        m_Arbiter.Release();
+}
+
+void LinuxReplayCM730::SetPacketTimeout(int lenPacket)
+{
+    if(m_Port != 0)
+    {
+        m_Port->SetPacketTimeout(lenPacket);
+        return;
+    }
+
+    m_PacketStartTime = GetCurrentTime();
+    m_PacketWaitTime = 0;
+}
+
+void LinuxReplayCM730::SetPacketTimeout(int id, int lenPacket)
+{
+    if(m_Port != 0)
+        m_Port->SetPacketTimeout(id, lenPacket);
+    else
+        SetPacketTimeout(lenPacket);
+}
+
+void LinuxReplayCM730::PacketReceived()
+{
+    if(m_Port != 0)
+        m_Port->PacketReceived();
+}
+
+bool LinuxReplayCM730::IsPacketTimeout()
+{
+    if(m_Port != 0)
+        return m_Port->IsPacketTimeout();
+
+    // the log holds everything the bus answered, once it is served we are done
+    return m_ReplyRead >= m_ReplyLength;
+}
+
+double LinuxReplayCM730::GetPacketTime()
+{
+    if(m_Port != 0)
+        return m_Port->GetPacketTime();
+
+    return GetElapsedTime(m_PacketStartTime);
+}
+
+void LinuxReplayCM730::SetUpdateTimeout(int msec)
+{
+    if(m_Port != 0)
+    {
+        m_Port->SetUpdateTimeout(msec);
+        return;
+    }
+
+    m_UpdateStartTime = GetCurrentTime();
+    m_UpdateWaitTime = msec;
+}
+
+bool LinuxReplayCM730::IsUpdateTimeout()
+{
+    if(m_Port != 0)
+        return m_Port->IsUpdateTimeout();
+
+    if(GetUpdateTime() > m_UpdateWaitTime)
+        return true;
+
+    return false;
+}
+
+double LinuxReplayCM730::GetUpdateTime()
+{
+    if(m_Port != 0)
+        return m_Port->GetUpdateTime();
+
+    return GetElapsedTime(m_UpdateStartTime);
+}
+
+void LinuxReplayCM730::Sleep(double msec)
+{
+    if(m_Port != 0)
+    {
+        m_Port->Sleep(msec);
+        return;
+    }
+
+    // replay runs as fast as it can
+}
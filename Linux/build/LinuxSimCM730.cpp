@@ -0,0 +1,528 @@
+/*
+ *   LinuxSimCM730.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "JointData.h"
+#include "LinuxSimCM730.h"
+
+using namespace Robot;
+
+// the packet offsets below shadow CM730::INSTRUCTION
+static const int ERROR_INSTRUCTION = CM730::INSTRUCTION;
+
+#define ID					(2)
+#define LENGTH				(3)
+#define INSTRUCTION			(4)
+#define ERRBIT				(4)
+#define PARAMETER			(5)
+
+#define INST_PING			(1)
+#define INST_READ			(2)
+#define INST_WRITE			(3)
+#define INST_SYNC_WRITE		(131)   // 0x83
+#define INST_BULK_READ      (146)   // 0x92
+
+#define PACKET_MARGIN       (5.0)   // msec
+#define RETURN_DELAY_UNIT   (0.002) // msec
+
+
+LinuxSimCM730::LinuxSimCM730()
+{
+    DEBUG_PRINT = false;
+    REAL_TIME = true;
+    MAX_SPEED = 4096;
+    m_IsOpen = false;
+    m_ReplyLength = 0;
+    m_ReplyRead = 0;
+    m_ReplyStartTime = 0;
+    m_ReplyTime = 0;
+    m_RequestLength = 0;
+    m_PacketStartTime = 0;
+    m_PacketWaitTime = 0;
+    m_UpdateStartTime = 0;
+    m_UpdateWaitTime = 0;
+    m_Baudrate = 1000000; //bps (1Mbps)
+    m_ByteTransferTime = 10000.0 / (double)m_Baudrate;
+
+    for(int id = 0; id < 256; id++)
+    {
+        m_Present[id] = false;
+        ResetDevice(id);
+    }
+
+    m_Present[CM730::ID_CM] = true;
+    for(int id = JointData::ID_R_SHOULDER_PITCH; id < JointData::NUMBER_OF_JOINTS; id++)
+        m_Present[id] = true;
+
+    ResetBusStatistics();
+}
+
+LinuxSimCM730::~LinuxSimCM730()
+{
+    ClosePort();
+}
+
+long long LinuxSimCM730::GetCurrentTime()
+{
+    struct timespec tv;
+    clock_gettime(CLOCK_MONOTONIC, &tv);
+
+    return (long long)tv.tv_sec * 1000000000LL + tv.tv_nsec;
+}
+
+double LinuxSimCM730::GetElapsedTime(long long start)
+{
+    return (double)(GetCurrentTime() - start) / 1000000.0;
+}
+
+void LinuxSimCM730::ResetDevice(int id)
+{
+    unsigned char *table = m_Table[id];
+
+    memset(table, 0, TABLE_SIZE);
+    table[MX28::P_ID] = (unsigned char)id;
+    table[MX28::P_BAUD_RATE] = 1;   // 1Mbps
+    table[MX28::P_RETURN_LEVEL] = 2;
+
+    if(id == CM730::ID_CM)
+    {
+        table[CM730::P_MODEL_NUMBER_L] = 0x19;
+        table[CM730::P_MODEL_NUMBER_H] = 0x73;
+        table[CM730::P_VERSION] = 0x11;
+        table[CM730::P_DXL_POWER] = 1;
+        for(int addr = CM730::P_GYRO_Z_L; addr <= CM730::P_ACCEL_Z_H; addr += 2)
+        {
+            table[addr] = CM730::GetLowByte(512);
+            table[addr + 1] = CM730::GetHighByte(512);
+        }
+        table[CM730::P_VOLTAGE] = 120;
+    }
+    else
+    {
+        table[MX28::P_MODEL_NUMBER_L] = 29;     // MX-28
+        table[MX28::P_VERSION] = 30;
+        table[MX28::P_CCW_ANGLE_LIMIT_L] = CM730::GetLowByte(MX28::MAX_VALUE);
+        table[MX28::P_CCW_ANGLE_LIMIT_H] = CM730::GetHighByte(MX28::MAX_VALUE);
+        table[MX28::P_HIGH_LIMIT_TEMPERATURE] = 80;
+        table[MX28::P_LOW_LIMIT_VOLTAGE] = 60;
+        table[MX28::P_HIGH_LIMIT_VOLTAGE] = 160;
+        table[MX28::P_MAX_TORQUE_L] = CM730::GetLowByte(1023);
+        table[MX28::P_MAX_TORQUE_H] = CM730::GetHighByte(1023);
+        table[MX28::P_P_GAIN] = JointData::P_GAIN_DEFAULT;
+        table[MX28::P_GOAL_POSITION_L] = CM730::GetLowByte(MX28::CENTER_VALUE);
+        table[MX28::P_GOAL_POSITION_H] = CM730::GetHighByte(MX28::CENTER_VALUE);
+        table[MX28::P_TORQUE_LIMIT_L] = CM730::GetLowByte(1023);
+        table[MX28::P_TORQUE_LIMIT_H] = CM730::GetHighByte(1023);
+        table[MX28::P_PRESENT_POSITION_L] = CM730::GetLowByte(MX28::CENTER_VALUE);
+        table[MX28::P_PRESENT_POSITION_H] = CM730::GetHighByte(MX28::CENTER_VALUE);
+        table[MX28::P_PRESENT_VOLTAGE] = 120;
+        table[MX28::P_PRESENT_TEMPERATURE] = 40;
+        table[MX28::P_PUNCH_L] = 32;
+    }
+
+    m_MoveTime[id] = 0;
+}
+
+void LinuxSimCM730::SetPresent(int id, bool present)
+{
+    id &= 0xFF;
+    if(present == true && m_Present[id] == false)
+        ResetDevice(id);
+    m_Present[id] = present;
+}
+
+void LinuxSimCM730::UpdateDevice(int id, long long now)
+{
+    unsigned char *table = m_Table[id];
+    long long last = m_MoveTime[id];
+
+    m_MoveTime[id] = now;
+    if(id == CM730::ID_CM || last == 0)
+        return;
+
+    int present = CM730::MakeWord(table[MX28::P_PRESENT_POSITION_L], table[MX28::P_PRESENT_POSITION_H]);
+    int goal = CM730::MakeWord(table[MX28::P_GOAL_POSITION_L], table[MX28::P_GOAL_POSITION_H]);
+    int step = (int)((double)MAX_SPEED * (double)(now - last) / 1000000000.0);
+
+    if(table[MX28::P_TORQUE_ENABLE] == 0)
+        goal = present;
+
+    // without real time a tick takes no time, so servos reach the goal at once
+    if(REAL_TIME == false)
+        step = MX28::MAX_VALUE;
+
+    if(goal > present + step)
+        goal = present + step;
+    else if(goal < present - step)
+        goal = present - step;
+
+    table[MX28::P_PRESENT_POSITION_L] = CM730::GetLowByte(goal);
+    table[MX28::P_PRESENT_POSITION_H] = CM730::GetHighByte(goal);
+    table[MX28::P_MOVING] = (goal != present) ? 1 : 0;
+}
+
+void LinuxSimCM730::WriteTable(int id, int address, const unsigned char *data, int length)
+{
+    memcpy(&m_Table[id][address], data, length);
+
+    // a servo turns its torque on when it is given a goal position
+    if(id != CM730::ID_CM && address <= MX28::P_GOAL_POSITION_H && address + length > MX28::P_GOAL_POSITION_L)
+        m_Table[id][MX28::P_TORQUE_ENABLE] = 1;
+}
+
+bool LinuxSimCM730::IsListening(int id)
+{
+    Protocol1 protocol;
+    double bps = protocol.GetBaudrate(m_Table[id][MX28::P_BAUD_RATE]);
+
+    if(m_Present[id] == false)
+        return false;
+
+    // UART tolerance, about 3%
+    return (bps > m_Baudrate * 0.97 && bps < m_Baudrate * 1.03);
+}
+
+void LinuxSimCM730::AddStatus(int id, int error, const unsigned char *param, int num_param)
+{
+    int length = num_param + 6;
+    unsigned char checksum = 0;
+
+    if(m_ReplyLength + length > MAXNUM_REPLY)
+        return;
+
+    double ready = m_ReplyTime + (double)m_Table[id][MX28::P_RETURN_DELAY_TIME] * RETURN_DELAY_UNIT;
+    unsigned char *status = &m_Reply[m_ReplyLength];
+
+    status[0] = 0xFF;
+    status[1] = 0xFF;
+    status[ID] = (unsigned char)id;
+    status[LENGTH] = (unsigned char)(num_param + 2);
+    status[ERRBIT] = (unsigned char)error;
+    for(int i = 0; i < num_param; i++)
+        status[PARAMETER + i] = param[i];
+    for(int i = 2; i < length - 1; i++)
+        checksum += status[i];
+    status[length - 1] = ~checksum;
+
+    for(int i = 0; i < length; i++)
+    {
+        ready += m_ByteTransferTime;
+        m_ReplyReady[m_ReplyLength + i] = ready;
+    }
+
+    m_ReplyLength += length;
+    m_ReplyTime = ready;
+}
+
+void LinuxSimCM730::HandleRequest(unsigned char *packet, long long now)
+{
+    int id = packet[ID];
+    int num_param = packet[LENGTH] - 2;
+    unsigned char *param = &packet[PARAMETER];
+
+    switch(packet[INSTRUCTION])
+    {
+    case INST_PING:
+        if(id != CM730::ID_BROADCAST && IsListening(id) == true)
+            AddStatus(id, 0, 0, 0);
+        break;
+
+    case INST_READ:
+        if(id != CM730::ID_BROADCAST && IsListening(id) == true)
+        {
+            int addr = param[0];
+            int len = param[1];
+            if(addr + len > TABLE_SIZE)
+                AddStatus(id, CM730::RANGE, 0, 0);
+            else
+            {
+                UpdateDevice(id, now);
+                AddStatus(id, 0, &m_Table[id][addr], len);
+            }
+        }
+        break;
+
+    case INST_WRITE:
+        for(int n = 0; n < 256; n++)
+        {
+            if((id != CM730::ID_BROADCAST && n != id) || IsListening(n) == false)
+                continue;
+
+            int addr = param[0];
+            int len = num_param - 1;
+            UpdateDevice(n, now);
+            if(addr + len <= TABLE_SIZE)
+                WriteTable(n, addr, &param[1], len);
+            if(id != CM730::ID_BROADCAST)
+                AddStatus(n, (addr + len > TABLE_SIZE) ? CM730::RANGE : 0, 0, 0);
+        }
+        break;
+
+    case INST_SYNC_WRITE:
+        {
+            int addr = param[0];
+            int len = param[1];
+            for(int i = 2; i + len < num_param; i += len + 1)
+            {
+                int n = param[i];
+                if(IsListening(n) == false || addr + len > TABLE_SIZE)
+                    continue;
+                UpdateDevice(n, now);
+                WriteTable(n, addr, &param[i + 1], len);
+            }
+        }
+        break;
+
+    case INST_BULK_READ:
+        // every listed device answers in turn, as the real servos do: each
+        // waits for the status of the one before it, so a silent device
+        // silences the rest of the list
+        for(int i = 1; i + 2 < num_param; i += 3)
+        {
+            int len = param[i];
+            int n = param[i + 1];
+            int addr = param[i + 2];
+            if(IsListening(n) == false || addr + len > TABLE_SIZE)
+                break;
+            UpdateDevice(n, now);
+            AddStatus(n, 0, &m_Table[n][addr], len);
+        }
+        break;
+
+    default:
+        if(id != CM730::ID_BROADCAST && IsListening(id) == true)
+            AddStatus(id, ERROR_INSTRUCTION, 0, 0);
+        break;
+    }
+}
+
+bool LinuxSimCM730::OpenPort()
+{
+    m_IsOpen = true;
+    ClearPort();
+    return true;
+}
+
+bool LinuxSimCM730::SetBaud(int baud)
+{
+    Protocol1 protocol;
+    int bps = protocol.GetBaudrate(baud);
+
+    if(bps == 0)
+        return false;
+
+    return SetBaudrate(bps);
+}
+
+bool LinuxSimCM730::SetBaudrate(int bps)
+{
+    if(bps <= 0)
+        return false;
+
+    m_Baudrate = bps;
+    m_ByteTransferTime = 10000.0 / (double)bps;   // 8N1
+    return true;
+}
+
+void LinuxSimCM730::ClosePort()
+{
+    m_IsOpen = false;
+}
+
+void LinuxSimCM730::ClearPort()
+{
+    m_ReplyLength = 0;
+    m_ReplyRead = 0;
+    m_RequestLength = 0;
+}
+
+int LinuxSimCM730::WritePort(unsigned char* packet, int numPacket)
+{
+    if(m_IsOpen == false)
+        return -1;
+
+    long long now = GetCurrentTime();
+
+    if(DEBUG_PRINT == true)
+    {
+        fprintf(stderr, "SIM TX: ");
+        for(int i = 0; i < numPacket; i++)
+            fprintf(stderr, "%.2X ", packet[i]);
+        fprintf(stderr, "\n");
+    }
+
+    // the new request starts once the previous reply left the bus
+    m_ReplyLength = 0;
+    m_ReplyRead = 0;
+    m_ReplyStartTime = now;
+    m_ReplyTime = m_ByteTransferTime * (double)numPacket;
+
+    // requests are complete packets from CM730::TxPacket
+    for(int i = 0; i < numPacket; i++)
+    {
+        if(m_RequestLength < MAXNUM_REPLY)
+            m_Request[m_RequestLength++] = packet[i];
+
+        if(m_RequestLength >= 4 && m_Request[0] == 0xFF && m_Request[1] == 0xFF
+                && m_RequestLength == m_Request[LENGTH] + 4)
+        {
+            unsigned char checksum = 0;
+            for(int j = 2; j < m_RequestLength; j++)
+                checksum += m_Request[j];
+            if(checksum == 0xFF)
+                HandleRequest(m_Request, now);
+            m_RequestLength = 0;
+        }
+        else if((m_RequestLength == 1 && m_Request[0] != 0xFF)
+                || (m_RequestLength == 2 && m_Request[1] != 0xFF))
+            m_RequestLength = 0;
+    }
+
+    m_BusBytes += numPacket + m_ReplyLength;
+    m_BusTime += m_ReplyTime;
+
+    return numPacket;
+}
+
+int LinuxSimCM730::ReadPort(unsigned char* packet, int numPacket)
+{
+    if(m_IsOpen == false)
+        return -1;
+
+    int ready = m_ReplyLength;
+
+    if(REAL_TIME == true)
+    {
+        double elapsed = GetElapsedTime(m_ReplyStartTime);
+        ready = m_ReplyRead;
+        while(ready < m_ReplyLength && m_ReplyReady[ready] <= elapsed)
+            ready++;
+
+        // like a blocking read: wait for the next byte unless the packet expires first
+        if(ready == m_ReplyRead && ready < m_ReplyLength)
+        {
+            double next = m_ReplyReady[ready] - elapsed;
+            double remain = m_PacketWaitTime - GetPacketTime();
+            if(next < remain)
+            {
+                Sleep(next);
+                return ReadPort(packet, numPacket);
+            }
+        }
+    }
+
+    int length = ready - m_ReplyRead;
+    if(length > numPacket)
+        length = numPacket;
+
+    memcpy(packet, &m_Reply[m_ReplyRead], length);
+    m_ReplyRead += length;
+
+    return length;
+}
+
+void LinuxSimCM730::LowPriorityWait()
+{
+    m_Arbiter.Acquire(LinuxBusArbiter::PRIORITY_LOW);
+}
+
+void LinuxSimCM730::MidPriorityWait()
+{
+    m_Arbiter.Acquire(LinuxBusArbiter::PRIORITY_MID);
+}
+
+void LinuxSimCM730::HighPriorityWait()
+{
+    m_Arbiter.Acquire(LinuxBusArbiter::PRIORITY_HIGH);
+}
+
+void LinuxSimCM730::LowPriorityRelease()
+{
+    m_Arbiter.Release();
+}
+
+void LinuxSimCM730::MidPriorityRelease()
+{
+    m_Arbiter.Release();
+}
+
+void LinuxSimCM730::HighPriorityRelease()
+{
+    m_Arbiter.Release();
+}
+
+double LinuxSimCM730::GetBusUtilization()
+{
+    double elapsed = GetElapsedTime(m_BusStartTime);
+
+    if(elapsed <= 0)
+        return 0;
+
+    return m_BusTime / elapsed;
+}
+
+void LinuxSimCM730::ResetBusStatistics()
+{
+    m_BusBytes = 0;
+    m_BusTime = 0;
+    m_BusStartTime = GetCurrentTime();
+}
+
+void LinuxSimCM730::SetPacketTimeout(int lenPacket)
+{
+    m_PacketStartTime = GetCurrentTime();
+    m_PacketWaitTime = m_ByteTransferTime * (double)lenPacket + PACKET_MARGIN;
+}
+
+bool LinuxSimCM730::IsPacketTimeout()
+{
+    // without real time every reply is in already, nothing more will come
+    if(REAL_TIME == false)
+        return m_ReplyRead >= m_ReplyLength;
+
+    if(GetPacketTime() > m_PacketWaitTime)
+        return true;
+
+    return false;
+}
+
+double LinuxSimCM730::GetPacketTime()
+{
+    return GetElapsedTime(m_PacketStartTime);
+}
+
+void LinuxSimCM730::SetUpdateTimeout(int msec)
+{
+    m_UpdateStartTime = GetCurrentTime();
+    m_UpdateWaitTime = msec;
+}
+
+bool LinuxSimCM730::IsUpdateTimeout()
+{
+    if(GetUpdateTime() > m_UpdateWaitTime)
+        return true;
+
+    return false;
+}
+
+double LinuxSimCM730::GetUpdateTime()
+{
+    return GetElapsedTime(m_UpdateStartTime);
+}
+
+void LinuxSimCM730::Sleep(double msec)
+{
+    long long start_time = GetCurrentTime();
+    double elapsed = 0;
+
+    do {
+        usleep((useconds_t)((msec - elapsed) * 1000.0));
+        elapsed = GetElapsedTime(start_time);
+    } while(elapsed < msec);
+}
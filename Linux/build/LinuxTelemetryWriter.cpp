@@ -0,0 +1,140 @@
+/*
+ *   LinuxTelemetryWriter.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include "LinuxTelemetryWriter.h"
+
+using namespace Robot;
+
+
+LinuxTelemetryWriter::LinuxTelemetryWriter(MotionManager *manager) :
+        m_Manager(manager),
+        m_File(0),
+        m_Running(false),
+        m_RecordCount(0),
+        m_DroppedAtStart(0),
+        POLL_INTERVAL(20)
+{
+    m_FileName[0] = 0;
+}
+
+LinuxTelemetryWriter::~LinuxTelemetryWriter()
+{
+    Stop();
+}
+
+bool LinuxTelemetryWriter::Start()
+{
+    char filename[sizeof(m_FileName)];
+
+    for(int count = 0; count <= 256; count++)
+    {
+        sprintf(filename, "Logs/Log%d.dlog", count);
+        if(access(filename, F_OK) != 0)
+            return Start(filename);
+    }
+
+    return false;
+}
+
+bool LinuxTelemetryWriter::Start(const char *filename)
+{
+    if(m_Running == true)
+        return false;
+
+    m_File = fopen(filename, "wb");
+    if(m_File == 0)
+    {
+        fprintf(stderr, "Fail to open telemetry log %s\n", filename);
+        return false;
+    }
+
+    strncpy(m_FileName, filename, sizeof(m_FileName) - 1);
+    m_FileName[sizeof(m_FileName) - 1] = 0;
+
+    TelemetryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TELEMETRY_MAGIC, sizeof(header.magic));
+    header.version = TELEMETRY_VERSION;
+    header.header_size = sizeof(TelemetryHeader);
+    header.record_size = sizeof(TelemetryRecord);
+    header.number_of_joints = JointData::NUMBER_OF_JOINTS;
+    header.time_unit = (float)m_Manager->GetTimeUnit();
+    fwrite(&header, sizeof(header), 1, m_File);
+
+    // records left over from an earlier run do not belong to this log
+    m_Manager->GetTelemetry()->Clear();
+    m_DroppedAtStart = m_Manager->GetTelemetry()->GetDropped();
+    m_RecordCount = 0;
+
+    m_Running = true;
+    if(pthread_create(&m_Thread, 0, WriterProc, this) != 0)
+    {
+        m_Running = false;
+        fclose(m_File);
+        m_File = 0;
+        return false;
+    }
+
+    m_Manager->StartLogging();
+    return true;
+}
+
+void LinuxTelemetryWriter::Stop()
+{
+    if(m_Running == false)
+        return;
+
+    m_Manager->StopLogging();
+    m_Running = false;
+    pthread_join(m_Thread, 0);
+    Drain();
+
+    // complete the header now that the length is known
+    unsigned int dropped = GetDroppedCount();
+    fseek(m_File, offsetof(TelemetryHeader, record_count), SEEK_SET);
+    fwrite(&m_RecordCount, sizeof(m_RecordCount), 1, m_File);
+    fseek(m_File, offsetof(TelemetryHeader, dropped), SEEK_SET);
+    fwrite(&dropped, sizeof(dropped), 1, m_File);
+
+    fclose(m_File);
+    m_File = 0;
+}
+
+unsigned int LinuxTelemetryWriter::GetDroppedCount()
+{
+    return m_Manager->GetTelemetry()->GetDropped() - m_DroppedAtStart;
+}
+
+void LinuxTelemetryWriter::Drain()
+{
+    TelemetryRing *ring = m_Manager->GetTelemetry();
+    TelemetryRecord *records;
+    int count;
+
+    while((count = ring->Peek(&records)) > 0)
+    {
+        fwrite(records, sizeof(TelemetryRecord), count, m_File);
+        ring->Release(count);
+        m_RecordCount += count;
+    }
+}
+
+void *LinuxTelemetryWriter::WriterProc(void *param)
+{
+    LinuxTelemetryWriter *writer = (LinuxTelemetryWriter *)param;
+
+    while(writer->m_Running == true)
+    {
+        writer->Drain();
+        usleep(writer->POLL_INTERVAL * 1000);
+    }
+
+    return 0;
+}
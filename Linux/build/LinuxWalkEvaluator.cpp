@@ -0,0 +1,60 @@
+/*
+ *   LinuxWalkEvaluator.cpp
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include "LinuxWalkEvaluator.h"
+
+using namespace Robot;
+
+
+void *LinuxWalkEvaluator::WorkerProc(void *param)
+{
+    Job *job = (Job*)param;
+    WalkEvaluator evaluator(job->time_unit);
+
+    int i;
+    while((i = __sync_fetch_and_add(&job->next, 1)) < job->number)
+        evaluator.Evaluate(&job->candidates[i]);
+
+    return 0;
+}
+
+int LinuxWalkEvaluator::Run(WalkCandidate *candidates, int number, int threads, double time_unit)
+{
+    if(threads <= 0)
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if(threads > number)
+        threads = number;
+    if(threads < 1)
+        threads = 1;
+
+    Job job;
+    job.candidates = candidates;
+    job.number = number;
+    job.next = 0;
+    job.time_unit = time_unit;
+
+    // the calling thread is the first worker
+    pthread_t *thread = new pthread_t[threads];
+    int started = 1;
+    for(; started < threads; started++)
+    {
+        if(pthread_create(&thread[started], 0, WorkerProc, &job) != 0)
+        {
+            fprintf(stderr, "Fail to create walk evaluator thread\n");
+            break;
+        }
+    }
+
+    WorkerProc(&job);
+    for(int t = 1; t < started; t++)
+        pthread_join(thread[t], 0);
+
+    delete[] thread;
+    return started;
+}
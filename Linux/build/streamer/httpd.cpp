@@ -591,6 +591,7 @@ void httpd::command(int fd, char *parameter) {
 void httpd::input_cmd(in_cmd_type cmd, float value, char* res_str)
 {
     int res = -1;
+    double x, y, a;
 
     //pthread_mutex_lock(&controls_mutex);
 
@@ -721,9 +722,7 @@ void httpd::input_cmd(in_cmd_type cmd, float value, char* res_str)
         else
         {
             Walking::GetInstance()->Stop();
-            Walking::GetInstance()->X_MOVE_AMPLITUDE = 0;
-            Walking::GetInstance()->Y_MOVE_AMPLITUDE = 0;
-            Walking::GetInstance()->A_MOVE_AMPLITUDE = 0;
+            Walking::GetInstance()->SetMoveAmplitude(0, 0, 0);
             strcpy(res_str, "OFF");
         }
         break;
@@ -778,20 +777,26 @@ void httpd::input_cmd(in_cmd_type cmd, float value, char* res_str)
         sprintf(res_str, "%.2f", Walking::GetInstance()->STEP_FB_RATIO);
         break;
     case IN_CMD_WALK_STEP_FB:
-        Walking::GetInstance()->X_MOVE_AMPLITUDE += value;
-        sprintf(res_str, "%d", (int)Walking::GetInstance()->X_MOVE_AMPLITUDE);
+        Walking::GetInstance()->GetMoveAmplitude(&x, &y, &a);
+        x += value;
+        Walking::GetInstance()->SetMoveAmplitude(x, y, a);
+        sprintf(res_str, "%d", (int)x);
         break;
     case IN_CMD_WALK_STEP_RL:
-        Walking::GetInstance()->Y_MOVE_AMPLITUDE += value;
-        sprintf(res_str, "%d", (int)Walking::GetInstance()->Y_MOVE_AMPLITUDE);
+        Walking::GetInstance()->GetMoveAmplitude(&x, &y, &a);
+        y += value;
+        Walking::GetInstance()->SetMoveAmplitude(x, y, a);
+        sprintf(res_str, "%d", (int)y);
         break;
     case IN_CMD_WALK_STEP_DIR:
-        Walking::GetInstance()->A_MOVE_AMPLITUDE += value;
-        sprintf(res_str, "%d", (int)Walking::GetInstance()->A_MOVE_AMPLITUDE);
+        Walking::GetInstance()->GetMoveAmplitude(&x, &y, &a);
+        a += value;
+        Walking::GetInstance()->SetMoveAmplitude(x, y, a);
+        sprintf(res_str, "%d", (int)a);
         break;
     case IN_CMD_WALK_TURN_AIM:
-        Walking::GetInstance()->A_MOVE_AIM_ON = value;
-        if(Walking::GetInstance()->A_MOVE_AIM_ON) strcpy(res_str, "ON");
+        Walking::GetInstance()->SetMoveAimOn(value);
+        if(value) strcpy(res_str, "ON");
         else strcpy(res_str, "OFF");
         break;
     case IN_CMD_WALK_FOOT_HEIGHT:
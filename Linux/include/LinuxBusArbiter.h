@@ -0,0 +1,64 @@
+/*
+ *   LinuxBusArbiter.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _LINUX_BUS_ARBITER_H_
+#define _LINUX_BUS_ARBITER_H_
+
+#include <pthread.h>
+
+namespace Robot
+{
+    /*
+     * Grants the Dynamixel bus to one packet at a time.
+     * Each priority has its own FIFO queue. When the bus is released the
+     * oldest request of the highest non-empty queue gets it next, so the
+     * motion tick only ever waits for the packet already on the wire.
+     */
+    class LinuxBusArbiter
+    {
+    public:
+        enum
+        {
+            PRIORITY_HIGH,  // motion tick: bulk read, sync write
+            PRIORITY_MID,   // table reads
+            PRIORITY_LOW,   // single register access from tools
+            NUMBER_OF_PRIORITY
+        };
+
+        enum
+        {
+            // bin 0: < 1us, bin n: [2^(n-1), 2^n) us, last bin open-ended
+            NUMBER_OF_WAIT_BIN = 20
+        };
+
+    private:
+        pthread_mutex_t m_Mutex;
+        pthread_cond_t m_Cond;
+        bool m_Busy;
+
+        unsigned int m_NextTicket[NUMBER_OF_PRIORITY];
+        unsigned int m_ServingTicket[NUMBER_OF_PRIORITY];
+
+        unsigned int m_WaitHistogram[NUMBER_OF_PRIORITY][NUMBER_OF_WAIT_BIN];
+        double m_MaxWaitTime[NUMBER_OF_PRIORITY];  // usec
+
+        bool IsGranted(int priority, unsigned int ticket);
+
+    public:
+        LinuxBusArbiter();
+        ~LinuxBusArbiter();
+
+        void Acquire(int priority);
+        void Release();
+
+        void GetWaitHistogram(int priority, unsigned int *bins);
+        double GetMaxWaitTime(int priority);
+        void ResetStatistics();
+    };
+}
+
+#endif
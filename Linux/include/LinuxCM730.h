@@ -8,31 +8,58 @@
 #ifndef _LINUX_CM730_H_
 #define _LINUX_CM730_H_
 
-#include <semaphore.h>
 #include "CM730.h"
+#include "LinuxBusArbiter.h"
 
 
 namespace Robot
 {
 	class LinuxCM730 : public PlatformCM730
 	{
+	public:
+		enum
+		{
+			MODEL_ANY					= 255,	// all unicast replies together
+			NUMBER_OF_TIMEOUT_MODEL		= 256,
+			ADAPTIVE_MIN_SAMPLES		= 8
+		};
+
 	private:
+		// Reply delay beyond the wire time, learned per ID (msec)
+		struct TimeoutModel
+		{
+			int samples;
+			double latency;
+			double deviation;
+		};
+
 		int m_Socket_fd;
-		double m_PacketStartTime;
+		long long m_PacketStartTime;	// nsec, CLOCK_MONOTONIC
 		double m_PacketWaitTime;
-		double m_UpdateStartTime;
+		int m_PacketID;
+		int m_PacketLength;
+		long long m_UpdateStartTime;
 		double m_UpdateWaitTime;
 		double m_ByteTransferTime;
+		int m_Baudrate;		// bps
+		TimeoutModel m_TimeoutModel[NUMBER_OF_TIMEOUT_MODEL];
 		char m_PortName[20];
 
-		sem_t m_LowSemID;
-		sem_t m_MidSemID;
-		sem_t m_HighSemID;
+		double m_ReadWaitTime;	// usec blocked in poll
+		double m_ReadSpinTime;	// usec spent in read calls
+		unsigned int m_ReadCount;
+		unsigned int m_EmptyReadCount;
+
+		LinuxBusArbiter m_Arbiter;
 
-		double GetCurrentTime();
+		long long GetCurrentTime();
+		double GetElapsedTime(long long start);
+		void UpdateTimeoutModel(TimeoutModel *model, double latency);
 
 	public:
 		bool DEBUG_PRINT;
+		bool POLL_READ;	// false: plain non-blocking read, the caller spins
+		bool ADAPTIVE_TIMEOUT;	// false: wire time + 5 ms for every packet
 
 		LinuxCM730(const char* name);
 		~LinuxCM730();
@@ -40,9 +67,23 @@ namespace Robot
 		void SetPortName(const char* name);
 		const char* GetPortName()		{ return (const char*)m_PortName; }
 
+		// Time spent in ReadPort since the last ResetReadTime()
+		double GetReadWaitTime()			{ return m_ReadWaitTime; }
+		double GetReadSpinTime()			{ return m_ReadSpinTime; }
+		unsigned int GetReadCount()			{ return m_ReadCount; }
+		unsigned int GetEmptyReadCount()	{ return m_EmptyReadCount; }
+		void ResetReadTime();
+
+		LinuxBusArbiter* GetBusArbiter()	{ return &m_Arbiter; }
+
+		double GetLearnedLatency(int id);	// msec, -1 if unknown
+		void ResetTimeoutModel();
+
 		///////////////// Platform Porting //////////////////////
 		bool OpenPort();
         bool SetBaud(int baud);
+		bool SetBaudrate(int bps);
+		int GetBaudrate()				{ return m_Baudrate; }
 		void ClosePort();
 		void ClearPort();
 		int WritePort(unsigned char* packet, int numPacket);
@@ -56,6 +97,8 @@ namespace Robot
 		void HighPriorityRelease();
 
 		void SetPacketTimeout(int lenPacket);
+		void SetPacketTimeout(int id, int lenPacket);
+		void PacketReceived();
 		bool IsPacketTimeout();
 		double GetPacketTime();
 		void SetUpdateTimeout(int msec);
@@ -11,6 +11,10 @@
 #include "DARwIn.h"
 #include "LinuxMotionTimer.h"
 #include "LinuxCM730.h"
+#include "LinuxSimCM730.h"
+#include "LinuxReplayCM730.h"
+#include "LinuxTelemetryWriter.h"
+#include "LinuxWalkEvaluator.h"
 #include "LinuxCamera.h"
 #include "LinuxNetwork.h"
 #include "LinuxActionScript.h"
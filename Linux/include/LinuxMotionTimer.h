@@ -16,6 +16,21 @@ namespace Robot
 {
   class LinuxMotionTimer
   {
+    public:
+      // What to do with the ticks whose start time passed while a tick overran
+      enum
+      {
+        CATCH_UP_COMPRESS,  // run them back to back until the schedule is met again
+        CATCH_UP_SKIP,      // drop them and continue on the original schedule
+        CATCH_UP_LATE       // start the next tick at once and shift the schedule
+      };
+
+      enum
+      {
+        // bin 0: < 1us, bin n: [2^(n-1), 2^n) us, last bin open-ended
+        NUMBER_OF_TIME_BIN = 20
+      };
+
     private:
       pthread_t m_Thread;// thread structure
       unsigned long m_Interval_ns;
@@ -23,16 +38,43 @@ namespace Robot
       bool m_TimerRunning;
       bool m_FinishTimer;
 
+      // written by the timer thread only
+      unsigned int m_JitterHistogram[NUMBER_OF_TIME_BIN];
+      unsigned int m_ExecHistogram[NUMBER_OF_TIME_BIN];
+      unsigned int m_TickCount;
+      unsigned int m_OverrunCount;
+      unsigned int m_SkippedCount;
+      double m_MaxJitter;     // usec
+      double m_MaxExecTime;   // usec
+
+      static void AddHistogram(unsigned int *bins, double usec);
+
     protected:
       static void *TimerProc(void *param);// thread function
 
     public:
+      int CATCH_UP;
+      bool LOCK_MEMORY;     // mlockall() before the thread starts
+      int CPU_AFFINITY;     // CPU the thread runs on, -1: any
+
       LinuxMotionTimer(MotionManager* manager);
       ~LinuxMotionTimer();
 
       void Start();
       void Stop();
       bool IsRunning();
+
+      // Start jitter: how late a tick began after its scheduled time
+      void GetJitterHistogram(unsigned int *bins);
+      // Execution time of MotionManager::Process()
+      void GetExecHistogram(unsigned int *bins);
+      unsigned int GetTickCount()     { return m_TickCount; }
+      // ticks that ended after the next one was due
+      unsigned int GetOverrunCount()  { return m_OverrunCount; }
+      unsigned int GetSkippedCount()  { return m_SkippedCount; }
+      double GetMaxJitter()           { return m_MaxJitter; }
+      double GetMaxExecTime()         { return m_MaxExecTime; }
+      void ResetStatistics();
   };
 }
 
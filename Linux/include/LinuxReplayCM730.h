@@ -0,0 +1,110 @@
+/*
+ *   LinuxReplayCM730.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _LINUX_REPLAY_CM730_H_
+#define _LINUX_REPLAY_CM730_H_
+
+#include <stdio.h>
+#include "CM730.h"
+#include "LinuxBusArbiter.h"
+
+
+namespace Robot
+{
+    /*
+     * Records or replays the bytes of a Dynamixel bus.
+     * Given a port, every call is passed through to it and each request
+     * ("T") and each chunk read back ("R") is logged as a text line with
+     * its time in msec and the bytes in hex. Without a port the log is played
+     * back: a request is matched with the next "T" line and the "R" lines
+     * after it are served at once, so a session taken on the robot runs
+     * again deterministically on a PC.
+     */
+    class LinuxReplayCM730 : public PlatformCM730
+    {
+    public:
+        enum
+        {
+            MAXNUM_LINE     = 8192,
+            MAXNUM_REPLY    = 2048
+        };
+
+    private:
+        PlatformCM730 *m_Port;
+        FILE *m_File;
+        char m_FileName[256];
+        long long m_StartTime;
+
+        char m_Line[MAXNUM_LINE];
+        bool m_HasLine;
+
+        unsigned char m_Reply[MAXNUM_REPLY];
+        int m_ReplyLength;
+        int m_ReplyRead;
+
+        unsigned int m_Requests;
+        unsigned int m_Mismatches;
+
+        long long m_PacketStartTime;
+        double m_PacketWaitTime;
+        long long m_UpdateStartTime;
+        double m_UpdateWaitTime;
+
+        LinuxBusArbiter m_Arbiter;
+
+        long long GetCurrentTime();
+        double GetElapsedTime(long long start);
+
+        void WriteLine(char type, unsigned char *data, int length);
+        bool NextLine();
+        int ParseLine(unsigned char *data, int capacity);
+
+    public:
+        bool DEBUG_PRINT;
+
+        // Records through 'port' into 'filename', or replays 'filename' if port is 0
+        LinuxReplayCM730(const char* filename, PlatformCM730 *port = 0);
+        ~LinuxReplayCM730();
+
+        bool IsRecording()              { return m_Port != 0; }
+
+        // Replay: requests played back and those that differed from the log
+        unsigned int GetRequestCount()  { return m_Requests; }
+        unsigned int GetMismatchCount() { return m_Mismatches; }
+
+        ///////////////// Platform Porting //////////////////////
+        bool OpenPort();
+        bool SetBaud(int baud);
+        bool SetBaudrate(int bps);
+        int GetBaudrate();
+        void ClosePort();
+        void ClearPort();
+        int WritePort(unsigned char* packet, int numPacket);
+        int ReadPort(unsigned char* packet, int numPacket);
+
+        void LowPriorityWait();
+        void MidPriorityWait();
+        void HighPriorityWait();
+        void LowPriorityRelease();
+        void MidPriorityRelease();
+        void HighPriorityRelease();
+
+        void SetPacketTimeout(int lenPacket);
+        void SetPacketTimeout(int id, int lenPacket);
+        void PacketReceived();
+        bool IsPacketTimeout();
+        double GetPacketTime();
+        void SetUpdateTimeout(int msec);
+        bool IsUpdateTimeout();
+        double GetUpdateTime();
+
+        void Sleep(double msec);
+        ////////////////////////////////////////////////////////
+    };
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ *   LinuxSimCM730.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _LINUX_SIM_CM730_H_
+#define _LINUX_SIM_CM730_H_
+
+#include "CM730.h"
+#include "LinuxBusArbiter.h"
+
+
+namespace Robot
+{
+    /*
+     * PlatformCM730 without hardware: a CM-730 (ID 200) and the MX-28s of
+     * DARwIn-OP answer protocol 1.0 packets from emulated control tables.
+     * With REAL_TIME set, reply bytes become readable at the pace of a real
+     * bus: 10 bits per byte at the current baud rate, after the request is on
+     * the wire and each device's Return Delay Time. Process() cost and bus
+     * time can then be measured on a PC. Otherwise replies are ready at once
+     * and servos reach their goal position within the tick.
+     * A device whose baud rate register does not match the bus stays silent.
+     */
+    class LinuxSimCM730 : public PlatformCM730
+    {
+    public:
+        enum
+        {
+            TABLE_SIZE      = 128,
+            MAXNUM_REPLY    = 2048
+        };
+
+    private:
+        unsigned char m_Table[256][TABLE_SIZE];
+        bool m_Present[256];
+        long long m_MoveTime[256];      // nsec of the last position update
+
+        unsigned char m_Reply[MAXNUM_REPLY];
+        double m_ReplyReady[MAXNUM_REPLY];  // msec after m_ReplyStartTime
+        int m_ReplyLength;
+        int m_ReplyRead;
+        long long m_ReplyStartTime;     // nsec
+        double m_ReplyTime;             // msec, when the bus is free again
+
+        unsigned char m_Request[MAXNUM_REPLY];
+        int m_RequestLength;
+
+        long long m_PacketStartTime;
+        double m_PacketWaitTime;
+        long long m_UpdateStartTime;
+        double m_UpdateWaitTime;
+
+        bool m_IsOpen;
+        int m_Baudrate;                 // bps
+        double m_ByteTransferTime;      // msec
+        LinuxBusArbiter m_Arbiter;
+
+        unsigned long long m_BusBytes;
+        double m_BusTime;               // msec the bus carried bytes
+        long long m_BusStartTime;
+
+        long long GetCurrentTime();
+        double GetElapsedTime(long long start);
+
+        void ResetDevice(int id);
+        void UpdateDevice(int id, long long now);
+        void WriteTable(int id, int address, const unsigned char *data, int length);
+        bool IsListening(int id);
+        void HandleRequest(unsigned char *packet, long long now);
+        void AddStatus(int id, int error, const unsigned char *param, int num_param);
+
+    public:
+        bool DEBUG_PRINT;
+        bool REAL_TIME;
+        int MAX_SPEED;          // position units per second a servo moves at most
+
+        LinuxSimCM730();
+        ~LinuxSimCM730();
+
+        // Bus population, all devices are present after construction
+        void SetPresent(int id, bool present);
+        bool IsPresent(int id)  { return m_Present[id & 0xFF]; }
+        unsigned char* GetTable(int id) { return m_Table[id & 0xFF]; }
+
+        // Bytes moved on the simulated bus and its share of the elapsed time
+        unsigned long long GetBusBytes()    { return m_BusBytes; }
+        double GetBusTime()                 { return m_BusTime; }
+        double GetBusUtilization();
+        void ResetBusStatistics();
+
+        ///////////////// Platform Porting //////////////////////
+        bool OpenPort();
+        bool SetBaud(int baud);
+        bool SetBaudrate(int bps);
+        int GetBaudrate() { return m_Baudrate; }
+        void ClosePort();
+        void ClearPort();
+        int WritePort(unsigned char* packet, int numPacket);
+        int ReadPort(unsigned char* packet, int numPacket);
+
+        void LowPriorityWait();
+        void MidPriorityWait();
+        void HighPriorityWait();
+        void LowPriorityRelease();
+        void MidPriorityRelease();
+        void HighPriorityRelease();
+
+        void SetPacketTimeout(int lenPacket);
+        bool IsPacketTimeout();
+        double GetPacketTime();
+        void SetUpdateTimeout(int msec);
+        bool IsUpdateTimeout();
+        double GetUpdateTime();
+
+        void Sleep(double msec);
+        ////////////////////////////////////////////////////////
+    };
+}
+
+#endif
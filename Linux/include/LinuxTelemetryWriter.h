@@ -0,0 +1,54 @@
+/*
+ *   LinuxTelemetryWriter.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _LINUX_TELEMETRY_WRITER_H_
+#define _LINUX_TELEMETRY_WRITER_H_
+
+#include <stdio.h>
+#include <pthread.h>
+#include "MotionManager.h"
+
+namespace Robot
+{
+    /*
+     * Background thread that drains MotionManager's telemetry ring into a
+     * binary log (see Telemetry.h), so the motion thread never waits on disk.
+     * log_convert turns a log into CSV.
+     */
+    class LinuxTelemetryWriter
+    {
+    private:
+        MotionManager *m_Manager;
+        FILE *m_File;
+        pthread_t m_Thread;
+        volatile bool m_Running;
+        unsigned int m_RecordCount;
+        unsigned int m_DroppedAtStart;
+        char m_FileName[64];
+
+        static void *WriterProc(void *param);
+        void Drain();
+
+    public:
+        int POLL_INTERVAL;      // msec between drains
+
+        LinuxTelemetryWriter(MotionManager *manager);
+        ~LinuxTelemetryWriter();
+
+        // Without a file name the next free Logs/Log<n>.dlog is used
+        bool Start();
+        bool Start(const char *filename);
+        void Stop();
+        bool IsRunning()                { return m_Running; }
+
+        const char* GetFileName()       { return m_FileName; }
+        unsigned int GetRecordCount()   { return m_RecordCount; }
+        unsigned int GetDroppedCount();
+    };
+}
+
+#endif
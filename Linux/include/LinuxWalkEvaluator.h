@@ -0,0 +1,41 @@
+/*
+ *   LinuxWalkEvaluator.h
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#ifndef _LINUX_WALK_EVALUATOR_H_
+#define _LINUX_WALK_EVALUATOR_H_
+
+#include <pthread.h>
+#include "WalkEvaluator.h"
+
+namespace Robot
+{
+    /*
+     * Screens many gait candidates offline: worker threads, one WalkEvaluator
+     * each, take the next candidate until all are done. Results do not
+     * depend on the number of threads.
+     */
+    class LinuxWalkEvaluator
+    {
+    private:
+        struct Job
+        {
+            WalkCandidate *candidates;
+            int number;
+            int next;       // next candidate to take, __sync_fetch_and_add()
+            double time_unit;
+        };
+
+        static void *WorkerProc(void *param);
+
+    public:
+        // threads <= 0: one per online CPU. Returns the threads used.
+        static int Run(WalkCandidate *candidates, int number, int threads = 0,
+                double time_unit = MotionModule::TIME_UNIT);
+    };
+}
+
+#endif
@@ -21,31 +21,37 @@ using namespace Robot;
 int StatusCheck::m_cur_mode     = READY;
 int StatusCheck::m_old_btn      = 0;
 int StatusCheck::m_is_started   = 0;
+bool StatusCheck::m_use_fall_prediction = false;
 
 void StatusCheck::Check(CM730 &cm730)
 {
-    if(MotionStatus::FALLEN != STANDUP && m_cur_mode == SOCCER && m_is_started == 1)
+    MotionState state;
+    MotionStatus::GetState(&state);
+
+    // The orientation filter sees a fall coming before the averaged
+    // accelerometer reports it, so the get up page is ready as the robot lands.
+    int fallen = state.fallen;
+    if(fallen == STANDUP && m_use_fall_prediction == true)
+        fallen = state.fall_prediction;
+
+    // Action outranks Head and Walking, so the get up page takes the body over
+    // while it plays and the joints fade back to them once it is done.
+    if(fallen != STANDUP && m_cur_mode == SOCCER && m_is_started == 1
+        && Action::GetInstance()->IsRunning() == false)
     {
         Walking::GetInstance()->Stop();
-        while(Walking::GetInstance()->IsRunning() == 1) usleep(8000);
+        Action::GetInstance()->m_Joint.SetEnableBody(true);
 
-        Action::GetInstance()->m_Joint.SetEnableBody(true, true);
-
-        if(MotionStatus::FALLEN == FORWARD)
+        if(fallen == FORWARD)
             Action::GetInstance()->Start(10);   // FORWARD GETUP
-        else if(MotionStatus::FALLEN == BACKWARD)
+        else if(fallen == BACKWARD)
             Action::GetInstance()->Start(11);   // BACKWARD GETUP
-
-        while(Action::GetInstance()->IsRunning() == 1) usleep(8000);
-
-        Head::GetInstance()->m_Joint.SetEnableHeadOnly(true, true);
-        Walking::GetInstance()->m_Joint.SetEnableBodyWithoutHead(true, true);
     }
 
-    if(m_old_btn == MotionStatus::BUTTON)
+    if(m_old_btn == state.button)
         return;
 
-    m_old_btn = MotionStatus::BUTTON;
+    m_old_btn = state.button;
 
     if(m_old_btn & BTN_MODE)
     {
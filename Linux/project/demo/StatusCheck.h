@@ -33,6 +33,9 @@ namespace Robot
     public:
         static int m_cur_mode;
         static int m_is_started;
+        // get up on the orientation filter's fall prediction as well; off
+        // until its gyro signs and scales have been checked on the robot
+        static bool m_use_fall_prediction;
 
         static void Check(CM730 &cm730);
     };
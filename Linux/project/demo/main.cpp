@@ -104,6 +104,11 @@ int main(void)
     MotionManager::GetInstance()->AddModule((MotionModule*)Head::GetInstance());
     MotionManager::GetInstance()->AddModule((MotionModule*)Walking::GetInstance());
 
+    Action::GetInstance()->SetPriority(1);
+    Action::GetInstance()->SetFadeTime(40);
+    Head::GetInstance()->SetFadeTime(200);
+    Walking::GetInstance()->SetFadeTime(200);
+
     LinuxMotionTimer *motion_timer = new LinuxMotionTimer(MotionManager::GetInstance());
     motion_timer->Start();
     /////////////////////////////////////////////////////////////////////
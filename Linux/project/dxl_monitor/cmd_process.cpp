@@ -94,6 +94,9 @@ void Help()
 	printf( " wr [ADDR] [VALUE] : Writes value [VALUE] to address [ADDR] of current Dynamixel\n" );
 	printf( " on/off : Turns torque on/off of current Dynamixel\n" );
 	printf( " on/off all : Turns torque on/off of all Dynamixels)\n" );
+	printf( " baud [BAUD] : Moves all Dynamixels and the PC to baud rate register value [BAUD]\n" );
+	printf( " stat : Outputs bus packet/error counters per Dynamixel and instruction\n" );
+	printf( " stat clear : Clears the bus counters\n" );
 	printf( "\n       Copyright ROBOTIS CO.,LTD.\n\n" );
 }
 
@@ -619,3 +622,62 @@ void Write(Robot::CM730 *cm730, int id, int addr, int value)
 
 	printf(" Writing successful!\n");
 }
+
+// upper bound (msec) of the latency bin holding the given fraction of packets
+double GetLatencyPercentile(BusCounter *counter, double fraction)
+{
+	unsigned int total = 0, sum = 0;
+	for(int i = 0; i < BusCounter::NUMBER_OF_LATENCY_BIN; i++)
+		total += counter->latency[i];
+	if(total == 0)
+		return 0;
+
+	double limit = 0.1;
+	for(int i = 0; i < BusCounter::NUMBER_OF_LATENCY_BIN - 1; i++, limit *= 2.0)
+	{
+		sum += counter->latency[i];
+		if(sum >= total * fraction)
+			return limit;
+	}
+
+	return limit; // open-ended last bin
+}
+
+void PrintCounter(const char *name, BusCounter *counter)
+{
+	printf( " %-18s %8u %7u %7u %7u %10u %10u   <%.1f  <%.1f\n", name,
+			counter->packets, counter->tx_fail, counter->rx_timeout, counter->rx_corrupt,
+			counter->tx_bytes, counter->rx_bytes,
+			GetLatencyPercentile(counter, 0.5), GetLatencyPercentile(counter, 0.99));
+}
+
+void Stat(CM730 *cm730)
+{
+	BusStatistics *stat = cm730->GetStatistics();
+	BusCounter counter;
+	char name[32];
+
+	printf( "\n" );
+	printf( " %-18s %8s %7s %7s %7s %10s %10s   %s\n", "ID", "PACKETS", "TX_FAIL", "TIMEOUT", "CORRUPT", "TX_BYTES", "RX_BYTES", "P50/P99(ms)" );
+	for(int id = 0; id < BusStatistics::NUMBER_OF_ID; id++)
+	{
+		stat->GetIDSnapshot(id, &counter);
+		if(counter.packets == 0)
+			continue;
+
+		sprintf(name, "%d(%s)", id, GetIDString(id));
+		PrintCounter(name, &counter);
+	}
+
+	printf( "\n" );
+	printf( " %-18s %8s %7s %7s %7s %10s %10s   %s\n", "INSTRUCTION", "PACKETS", "TX_FAIL", "TIMEOUT", "CORRUPT", "TX_BYTES", "RX_BYTES", "P50/P99(ms)" );
+	for(int i = 0; i < BusStatistics::NUMBER_OF_INSTRUCTION; i++)
+	{
+		stat->GetInstructionSnapshot(i, &counter);
+		if(counter.packets == 0)
+			continue;
+
+		PrintCounter(BusStatistics::GetInstructionName(i), &counter);
+	}
+	printf( "\n" );
+}
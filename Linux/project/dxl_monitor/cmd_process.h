@@ -11,5 +11,6 @@ void Scan(Robot::CM730 *cm730);
 void Dump(Robot::CM730 *cm730, int id);
 void Reset(Robot::CM730 *cm730, int id);
 void Write(Robot::CM730 *cm730, int id, int addr, int value);
+void Stat(Robot::CM730 *cm730);
 
 #endif
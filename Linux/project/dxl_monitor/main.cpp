@@ -203,6 +203,31 @@ int main()
 					continue;
 				}
 			}
+			else if(strcmp(cmd, "baud") == 0)
+			{
+				if(num_param != 1)
+				{
+					printf(" Invalid parameter!\n");
+					continue;
+				}
+
+				if(cm730.NegotiateBaud(atoi(param[0])) == true)
+					printf(" Baud rate changed to %d bps\n", linux_cm730.GetBaudrate());
+				else
+					printf(" Fail to change baud rate!\n");
+			}
+			else if(strcmp(cmd, "stat") == 0)
+			{
+				if(num_param == 0)
+					Stat(&cm730);
+				else if(num_param == 1 && strcmp(param[0], "clear") == 0)
+					cm730.GetStatistics()->Clear();
+				else
+				{
+					printf(" Invalid parameter!\n");
+					continue;
+				}
+			}
 			else
 				printf(" Bad command! please input 'help'.\n");
 		}
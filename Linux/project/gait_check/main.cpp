@@ -0,0 +1,737 @@
+/*
+ *   main.cpp
+ *
+ *   Checks that Walking::Process() still produces, bit for bit, the foot
+ *   endpoints and joint values of the gait generator that evaluated every
+ *   wsin() on every tick, and compares their speed. Also checks that Stop()
+ *   during a SetVelocity() walk moves the feet no faster than walking, or
+ *   the same walk driven by SetMoveAmplitude(), does.
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include "LinuxDARwIn.h"
+#include "Kinematics.h"
+
+using namespace Robot;
+
+#define PI (3.14159265)
+
+
+long long get_time()
+{
+    struct timespec tv;
+    clock_gettime(CLOCK_MONOTONIC, &tv);
+
+    return (long long)tv.tv_sec * 1000000000LL + tv.tv_nsec;
+}
+
+static const int id_map[14] =
+{
+    JointData::ID_R_HIP_YAW, JointData::ID_R_HIP_ROLL, JointData::ID_R_HIP_PITCH,
+    JointData::ID_R_KNEE, JointData::ID_R_ANKLE_PITCH, JointData::ID_R_ANKLE_ROLL,
+    JointData::ID_L_HIP_YAW, JointData::ID_L_HIP_ROLL, JointData::ID_L_HIP_PITCH,
+    JointData::ID_L_KNEE, JointData::ID_L_ANKLE_PITCH, JointData::ID_L_ANKLE_ROLL,
+    JointData::ID_R_SHOULDER_PITCH, JointData::ID_L_SHOULDER_PITCH
+};
+
+// Walking's trajectory code before the gait coefficients were precomputed.
+// Parameters are read from the Walking it is compared with.
+class LegacyGait
+{
+public:
+    Walking *w;
+
+    double m_PeriodTime;
+    double m_DSP_Ratio;
+    double m_SSP_Ratio;
+    double m_X_Swap_PeriodTime;
+    double m_X_Move_PeriodTime;
+    double m_Y_Swap_PeriodTime;
+    double m_Y_Move_PeriodTime;
+    double m_Z_Swap_PeriodTime;
+    double m_Z_Move_PeriodTime;
+    double m_A_Move_PeriodTime;
+    double m_SSP_Time;
+    double m_SSP_Time_Start_L;
+    double m_SSP_Time_End_L;
+    double m_SSP_Time_Start_R;
+    double m_SSP_Time_End_R;
+    double m_Phase_Time1;
+    double m_Phase_Time2;
+    double m_Phase_Time3;
+
+    double m_X_Offset;
+    double m_Y_Offset;
+    double m_Z_Offset;
+    double m_R_Offset;
+    double m_P_Offset;
+    double m_A_Offset;
+
+    double m_X_Swap_Phase_Shift;
+    double m_X_Swap_Amplitude;
+    double m_X_Swap_Amplitude_Shift;
+    double m_X_Move_Phase_Shift;
+    double m_X_Move_Amplitude;
+    double m_X_Move_Amplitude_Shift;
+    double m_Y_Swap_Phase_Shift;
+    double m_Y_Swap_Amplitude;
+    double m_Y_Swap_Amplitude_Shift;
+    double m_Y_Move_Phase_Shift;
+    double m_Y_Move_Amplitude;
+    double m_Y_Move_Amplitude_Shift;
+    double m_Z_Swap_Phase_Shift;
+    double m_Z_Swap_Amplitude;
+    double m_Z_Swap_Amplitude_Shift;
+    double m_Z_Move_Phase_Shift;
+    double m_Z_Move_Amplitude;
+    double m_Z_Move_Amplitude_Shift;
+    double m_A_Move_Phase_Shift;
+    double m_A_Move_Amplitude;
+    double m_A_Move_Amplitude_Shift;
+
+    double m_Pelvis_Offset;
+    double m_Pelvis_Swing;
+    double m_Hip_Pitch_Offset;
+    double m_Arm_Swing_Gain;
+
+    bool m_Ctrl_Running;
+    bool m_Real_Running;
+    double m_Time;
+
+    int    m_Phase;
+    double m_Body_Swing_Y;
+    double m_Body_Swing_Z;
+
+    double m_Endpoint[12];
+    int m_OutValue[14];
+    JointData m_Joint;
+
+    LegacyGait(Walking *walking) : w(walking)
+    {
+        memset(m_Endpoint, 0, sizeof(m_Endpoint));
+        memset(m_OutValue, 0, sizeof(m_OutValue));
+    }
+
+    // as Walking::Initialize(), after it
+    void Initialize()
+    {
+        m_Body_Swing_Y = 0;
+        m_Body_Swing_Z = 0;
+
+        m_X_Swap_Phase_Shift = PI;
+        m_X_Swap_Amplitude_Shift = 0;
+        m_X_Move_Phase_Shift = PI / 2;
+        m_X_Move_Amplitude_Shift = 0;
+        m_Y_Swap_Phase_Shift = 0;
+        m_Y_Swap_Amplitude_Shift = 0;
+        m_Y_Move_Phase_Shift = PI / 2;
+        m_Z_Swap_Phase_Shift = PI * 3 / 2;
+        m_Z_Move_Phase_Shift = PI / 2;
+        m_A_Move_Phase_Shift = PI / 2;
+
+        m_Ctrl_Running = false;
+        m_Real_Running = false;
+        m_Time = 0;
+        update_param_time();
+        update_param_move();
+
+        Process();
+    }
+
+    void Start()    { m_Ctrl_Running = true; m_Real_Running = true; }
+    void Stop()     { m_Ctrl_Running = false; }
+
+    double wsin(double time, double period, double period_shift, double mag, double mag_shift);
+    void update_param_time();
+    void update_param_move();
+    void update_param_balance();
+    void Process();
+};
+
+double LegacyGait::wsin(double time, double period, double period_shift, double mag, double mag_shift)
+{
+    return mag * sin(2 * 3.141592 / period * time - period_shift) + mag_shift;
+}
+
+void LegacyGait::update_param_time()
+{
+    m_PeriodTime = w->PERIOD_TIME;
+    m_DSP_Ratio = w->DSP_RATIO;
+    m_SSP_Ratio = 1 - w->DSP_RATIO;
+
+    m_X_Swap_PeriodTime = m_PeriodTime / 2;
+    m_X_Move_PeriodTime = m_PeriodTime * m_SSP_Ratio;
+    m_Y_Swap_PeriodTime = m_PeriodTime;
+    m_Y_Move_PeriodTime = m_PeriodTime * m_SSP_Ratio;
+    m_Z_Swap_PeriodTime = m_PeriodTime / 2;
+    m_Z_Move_PeriodTime = m_PeriodTime * m_SSP_Ratio / 2;
+    m_A_Move_PeriodTime = m_PeriodTime * m_SSP_Ratio;
+
+    m_SSP_Time = m_PeriodTime * m_SSP_Ratio;
+    m_SSP_Time_Start_L = (1 - m_SSP_Ratio) * m_PeriodTime / 4;
+    m_SSP_Time_End_L = (1 + m_SSP_Ratio) * m_PeriodTime / 4;
+    m_SSP_Time_Start_R = (3 - m_SSP_Ratio) * m_PeriodTime / 4;
+    m_SSP_Time_End_R = (3 + m_SSP_Ratio) * m_PeriodTime / 4;
+
+    m_Phase_Time1 = (m_SSP_Time_End_L + m_SSP_Time_Start_L) / 2;
+    m_Phase_Time2 = (m_SSP_Time_Start_R + m_SSP_Time_End_L) / 2;
+    m_Phase_Time3 = (m_SSP_Time_End_R + m_SSP_Time_Start_R) / 2;
+
+    m_Pelvis_Offset = w->PELVIS_OFFSET*MX28::RATIO_ANGLE2VALUE;
+    m_Pelvis_Swing = m_Pelvis_Offset * 0.35;
+    m_Arm_Swing_Gain = w->ARM_SWING_GAIN;
+}
+
+void LegacyGait::update_param_move()
+{
+    // Forward/Back
+    m_X_Move_Amplitude = w->X_MOVE_AMPLITUDE;
+    m_X_Swap_Amplitude = w->X_MOVE_AMPLITUDE * w->STEP_FB_RATIO;
+
+    // Right/Left
+    m_Y_Move_Amplitude = w->Y_MOVE_AMPLITUDE / 2;
+    if(m_Y_Move_Amplitude > 0)
+        m_Y_Move_Amplitude_Shift = m_Y_Move_Amplitude;
+    else
+        m_Y_Move_Amplitude_Shift = -m_Y_Move_Amplitude;
+    m_Y_Swap_Amplitude = w->Y_SWAP_AMPLITUDE + m_Y_Move_Amplitude_Shift * 0.04;
+
+    m_Z_Move_Amplitude = w->Z_MOVE_AMPLITUDE / 2;
+    m_Z_Move_Amplitude_Shift = m_Z_Move_Amplitude / 2;
+    m_Z_Swap_Amplitude = w->Z_SWAP_AMPLITUDE;
+    m_Z_Swap_Amplitude_Shift = m_Z_Swap_Amplitude;
+
+    // Direction
+    if(w->A_MOVE_AIM_ON == false)
+    {
+        m_A_Move_Amplitude = w->A_MOVE_AMPLITUDE * PI / 180.0 / 2;
+        if(m_A_Move_Amplitude > 0)
+            m_A_Move_Amplitude_Shift = m_A_Move_Amplitude;
+        else
+            m_A_Move_Amplitude_Shift = -m_A_Move_Amplitude;
+    }
+    else
+    {
+        m_A_Move_Amplitude = -w->A_MOVE_AMPLITUDE * PI / 180.0 / 2;
+        if(m_A_Move_Amplitude > 0)
+            m_A_Move_Amplitude_Shift = -m_A_Move_Amplitude;
+        else
+            m_A_Move_Amplitude_Shift = m_A_Move_Amplitude;
+    }
+}
+
+void LegacyGait::update_param_balance()
+{
+    m_X_Offset = w->X_OFFSET;
+    m_Y_Offset = w->Y_OFFSET;
+    m_Z_Offset = w->Z_OFFSET;
+    m_R_Offset = w->R_OFFSET * PI / 180.0;
+    m_P_Offset = w->P_OFFSET * PI / 180.0;
+    m_A_Offset = w->A_OFFSET * PI / 180.0;
+    m_Hip_Pitch_Offset = w->HIP_PITCH_OFFSET*MX28::RATIO_ANGLE2VALUE;
+}
+
+void LegacyGait::Process()
+{
+    double x_swap, y_swap, z_swap, a_swap, b_swap, c_swap;
+    double x_move_r, y_move_r, z_move_r, a_move_r, b_move_r, c_move_r;
+    double x_move_l, y_move_l, z_move_l, a_move_l, b_move_l, c_move_l;
+    double pelvis_offset_r, pelvis_offset_l;
+    double angle[14], *ep = m_Endpoint;
+    double offset;
+    double TIME_UNIT = w->GetTimeUnit();
+    //                     R_HIP_YAW, R_HIP_ROLL, R_HIP_PITCH, R_KNEE, R_ANKLE_PITCH, R_ANKLE_ROLL, L_HIP_YAW, L_HIP_ROLL, L_HIP_PITCH, L_KNEE, L_ANKLE_PITCH, L_ANKLE_ROLL, R_ARM_SWING, L_ARM_SWING
+    int dir[14]          = {   -1,        -1,          1,         1,         -1,            1,          -1,        -1,         -1,         -1,         1,            1,           1,           -1      };
+    double initAngle[14] = {   0.0,       0.0,        0.0,       0.0,        0.0,          0.0,         0.0,       0.0,        0.0,        0.0,       0.0,          0.0,       -48.345,       41.313    };
+    int outValue[14];
+
+    // Update walk parameters
+    if(m_Time == 0)
+    {
+        update_param_time();
+        m_Phase = Walking::PHASE0;
+        if(m_Ctrl_Running == false)
+        {
+            if(m_X_Move_Amplitude == 0 && m_Y_Move_Amplitude == 0 && m_A_Move_Amplitude == 0)
+            {
+                m_Real_Running = false;
+            }
+            else
+            {
+                w->X_MOVE_AMPLITUDE = 0;
+                w->Y_MOVE_AMPLITUDE = 0;
+                w->A_MOVE_AMPLITUDE = 0;
+            }
+        }
+    }
+    else if(m_Time >= (m_Phase_Time1 - TIME_UNIT/2) && m_Time < (m_Phase_Time1 + TIME_UNIT/2))
+    {
+        update_param_move();
+        m_Phase = Walking::PHASE1;
+    }
+    else if(m_Time >= (m_Phase_Time2 - TIME_UNIT/2) && m_Time < (m_Phase_Time2 + TIME_UNIT/2))
+    {
+        update_param_time();
+        m_Time = m_Phase_Time2;
+        m_Phase = Walking::PHASE2;
+        if(m_Ctrl_Running == false)
+        {
+            if(m_X_Move_Amplitude == 0 && m_Y_Move_Amplitude == 0 && m_A_Move_Amplitude == 0)
+            {
+                m_Real_Running = false;
+            }
+            else
+            {
+                w->X_MOVE_AMPLITUDE = 0;
+                w->Y_MOVE_AMPLITUDE = 0;
+                w->A_MOVE_AMPLITUDE = 0;
+            }
+        }
+    }
+    else if(m_Time >= (m_Phase_Time3 - TIME_UNIT/2) && m_Time < (m_Phase_Time3 + TIME_UNIT/2))
+    {
+        update_param_move();
+        m_Phase = Walking::PHASE3;
+    }
+    update_param_balance();
+
+    // Compute endpoints
+    x_swap = wsin(m_Time, m_X_Swap_PeriodTime, m_X_Swap_Phase_Shift, m_X_Swap_Amplitude, m_X_Swap_Amplitude_Shift);
+    y_swap = wsin(m_Time, m_Y_Swap_PeriodTime, m_Y_Swap_Phase_Shift, m_Y_Swap_Amplitude, m_Y_Swap_Amplitude_Shift);
+    z_swap = wsin(m_Time, m_Z_Swap_PeriodTime, m_Z_Swap_Phase_Shift, m_Z_Swap_Amplitude, m_Z_Swap_Amplitude_Shift);
+    a_swap = 0;
+    b_swap = 0;
+    c_swap = 0;
+
+    if(m_Time <= m_SSP_Time_Start_L)
+    {
+        x_move_l = wsin(m_SSP_Time_Start_L, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, m_X_Move_Amplitude, m_X_Move_Amplitude_Shift);
+        y_move_l = wsin(m_SSP_Time_Start_L, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, m_Y_Move_Amplitude, m_Y_Move_Amplitude_Shift);
+        z_move_l = wsin(m_SSP_Time_Start_L, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
+        c_move_l = wsin(m_SSP_Time_Start_L, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, m_A_Move_Amplitude, m_A_Move_Amplitude_Shift);
+        x_move_r = wsin(m_SSP_Time_Start_L, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, -m_X_Move_Amplitude, -m_X_Move_Amplitude_Shift);
+        y_move_r = wsin(m_SSP_Time_Start_L, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, -m_Y_Move_Amplitude, -m_Y_Move_Amplitude_Shift);
+        z_move_r = wsin(m_SSP_Time_Start_R, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
+        c_move_r = wsin(m_SSP_Time_Start_L, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, -m_A_Move_Amplitude, -m_A_Move_Amplitude_Shift);
+        pelvis_offset_l = 0;
+        pelvis_offset_r = 0;
+    }
+    else if(m_Time <= m_SSP_Time_End_L)
+    {
+        x_move_l = wsin(m_Time, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, m_X_Move_Amplitude, m_X_Move_Amplitude_Shift);
+        y_move_l = wsin(m_Time, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, m_Y_Move_Amplitude, m_Y_Move_Amplitude_Shift);
+        z_move_l = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
+        c_move_l = wsin(m_Time, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, m_A_Move_Amplitude, m_A_Move_Amplitude_Shift);
+        x_move_r = wsin(m_Time, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, -m_X_Move_Amplitude, -m_X_Move_Amplitude_Shift);
+        y_move_r = wsin(m_Time, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, -m_Y_Move_Amplitude, -m_Y_Move_Amplitude_Shift);
+        z_move_r = wsin(m_SSP_Time_Start_R, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
+        c_move_r = wsin(m_Time, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, -m_A_Move_Amplitude, -m_A_Move_Amplitude_Shift);
+        pelvis_offset_l = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Pelvis_Swing / 2, m_Pelvis_Swing / 2);
+        pelvis_offset_r = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, -m_Pelvis_Offset / 2, -m_Pelvis_Offset / 2);
+    }
+    else if(m_Time <= m_SSP_Time_Start_R)
+    {
+        x_move_l = wsin(m_SSP_Time_End_L, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, m_X_Move_Amplitude, m_X_Move_Amplitude_Shift);
+        y_move_l = wsin(m_SSP_Time_End_L, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, m_Y_Move_Amplitude, m_Y_Move_Amplitude_Shift);
+        z_move_l = wsin(m_SSP_Time_End_L, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
+        c_move_l = wsin(m_SSP_Time_End_L, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, m_A_Move_Amplitude, m_A_Move_Amplitude_Shift);
+        x_move_r = wsin(m_SSP_Time_End_L, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_L, -m_X_Move_Amplitude, -m_X_Move_Amplitude_Shift);
+        y_move_r = wsin(m_SSP_Time_End_L, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_L, -m_Y_Move_Amplitude, -m_Y_Move_Amplitude_Shift);
+        z_move_r = wsin(m_SSP_Time_Start_R, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
+        c_move_r = wsin(m_SSP_Time_End_L, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_L, -m_A_Move_Amplitude, -m_A_Move_Amplitude_Shift);
+        pelvis_offset_l = 0;
+        pelvis_offset_r = 0;
+    }
+    else if(m_Time <= m_SSP_Time_End_R)
+    {
+        x_move_l = wsin(m_Time, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_X_Move_Amplitude, m_X_Move_Amplitude_Shift);
+        y_move_l = wsin(m_Time, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_Y_Move_Amplitude, m_Y_Move_Amplitude_Shift);
+        z_move_l = wsin(m_SSP_Time_End_L, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
+        c_move_l = wsin(m_Time, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_A_Move_Amplitude, m_A_Move_Amplitude_Shift);
+        x_move_r = wsin(m_Time, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_X_Move_Amplitude, -m_X_Move_Amplitude_Shift);
+        y_move_r = wsin(m_Time, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_Y_Move_Amplitude, -m_Y_Move_Amplitude_Shift);
+        z_move_r = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
+        c_move_r = wsin(m_Time, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_A_Move_Amplitude, -m_A_Move_Amplitude_Shift);
+        pelvis_offset_l = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Pelvis_Offset / 2, m_Pelvis_Offset / 2);
+        pelvis_offset_r = wsin(m_Time, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, -m_Pelvis_Swing / 2, -m_Pelvis_Swing / 2);
+    }
+    else
+    {
+        x_move_l = wsin(m_SSP_Time_End_R, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_X_Move_Amplitude, m_X_Move_Amplitude_Shift);
+        y_move_l = wsin(m_SSP_Time_End_R, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_Y_Move_Amplitude, m_Y_Move_Amplitude_Shift);
+        z_move_l = wsin(m_SSP_Time_End_L, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_L, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
+        c_move_l = wsin(m_SSP_Time_End_R, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_R + PI, m_A_Move_Amplitude, m_A_Move_Amplitude_Shift);
+        x_move_r = wsin(m_SSP_Time_End_R, m_X_Move_PeriodTime, m_X_Move_Phase_Shift + 2 * PI / m_X_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_X_Move_Amplitude, -m_X_Move_Amplitude_Shift);
+        y_move_r = wsin(m_SSP_Time_End_R, m_Y_Move_PeriodTime, m_Y_Move_Phase_Shift + 2 * PI / m_Y_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_Y_Move_Amplitude, -m_Y_Move_Amplitude_Shift);
+        z_move_r = wsin(m_SSP_Time_End_R, m_Z_Move_PeriodTime, m_Z_Move_Phase_Shift + 2 * PI / m_Z_Move_PeriodTime * m_SSP_Time_Start_R, m_Z_Move_Amplitude, m_Z_Move_Amplitude_Shift);
+        c_move_r = wsin(m_SSP_Time_End_R, m_A_Move_PeriodTime, m_A_Move_Phase_Shift + 2 * PI / m_A_Move_PeriodTime * m_SSP_Time_Start_R + PI, -m_A_Move_Amplitude, -m_A_Move_Amplitude_Shift);
+        pelvis_offset_l = 0;
+        pelvis_offset_r = 0;
+    }
+
+    a_move_l = 0;
+    b_move_l = 0;
+    a_move_r = 0;
+    b_move_r = 0;
+
+    ep[0] = x_swap + x_move_r + m_X_Offset;
+    ep[1] = y_swap + y_move_r - m_Y_Offset / 2;
+    ep[2] = z_swap + z_move_r + m_Z_Offset;
+    ep[3] = a_swap + a_move_r - m_R_Offset / 2;
+    ep[4] = b_swap + b_move_r + m_P_Offset;
+    ep[5] = c_swap + c_move_r - m_A_Offset / 2;
+    ep[6] = x_swap + x_move_l + m_X_Offset;
+    ep[7] = y_swap + y_move_l + m_Y_Offset / 2;
+    ep[8] = z_swap + z_move_l + m_Z_Offset;
+    ep[9] = a_swap + a_move_l + m_R_Offset / 2;
+    ep[10] = b_swap + b_move_l + m_P_Offset;
+    ep[11] = c_swap + c_move_l + m_A_Offset / 2;
+
+    // Compute body swing
+    if(m_Time <= m_SSP_Time_End_L)
+    {
+        m_Body_Swing_Y = -ep[7];
+        m_Body_Swing_Z = ep[8];
+    }
+    else
+    {
+        m_Body_Swing_Y = -ep[1];
+        m_Body_Swing_Z = ep[2];
+    }
+    m_Body_Swing_Z -= Kinematics::LEG_LENGTH;
+
+    // Compute arm swing
+    if(m_X_Move_Amplitude == 0)
+    {
+        angle[12] = 0; // Right
+        angle[13] = 0; // Left
+    }
+    else
+    {
+        angle[12] = wsin(m_Time, m_PeriodTime, PI * 1.5, -m_X_Move_Amplitude * m_Arm_Swing_Gain, 0);
+        angle[13] = wsin(m_Time, m_PeriodTime, PI * 1.5, m_X_Move_Amplitude * m_Arm_Swing_Gain, 0);
+    }
+
+    if(m_Real_Running == true)
+    {
+        m_Time += TIME_UNIT;
+        if(m_Time >= m_PeriodTime)
+            m_Time = 0;
+    }
+
+    // Compute angles
+    if((Kinematics::LegIK(&angle[0], ep[0], ep[1], ep[2], ep[3], ep[4], ep[5]) == true)
+        && (Kinematics::LegIK(&angle[6], ep[6], ep[7], ep[8], ep[9], ep[10], ep[11]) == true))
+    {
+        for(int i=0; i<12; i++)
+            angle[i] *= 180.0 / PI;
+    }
+    else
+    {
+        return; // Do not use angle;
+    }
+
+    // Compute motor value
+    for(int i=0; i<14; i++)
+    {
+        offset = (double)dir[i] * angle[i] * MX28::RATIO_ANGLE2VALUE;
+        if(i == 1) // R_HIP_ROLL
+            offset += (double)dir[i] * pelvis_offset_r;
+        else if(i == 7) // L_HIP_ROLL
+            offset += (double)dir[i] * pelvis_offset_l;
+        else if(i == 2 || i == 8) // R_HIP_PITCH or L_HIP_PITCH
+            offset -= (double)dir[i] * w->HIP_PITCH_OFFSET * MX28::RATIO_ANGLE2VALUE;
+
+        outValue[i] = MX28::Angle2Value(initAngle[i]) + (int)offset;
+    }
+
+    for(int i=0; i<14; i++)
+        m_OutValue[i] = outValue[i];
+
+    // same joint writes as Walking, so the timing compares like with like
+    for(int i=0; i<14; i++)
+        m_Joint.SetValue(id_map[i], outValue[i]);
+    m_Joint.SetAngle(JointData::ID_HEAD_PAN, w->A_MOVE_AMPLITUDE);
+
+    for(int id = JointData::ID_R_HIP_YAW; id <= JointData::ID_L_ANKLE_ROLL; id++)
+    {
+        m_Joint.SetPGain(id, w->P_GAIN);
+        m_Joint.SetIGain(id, w->I_GAIN);
+        m_Joint.SetDGain(id, w->D_GAIN);
+    }
+}
+
+struct Scenario
+{
+    const char *name;
+    double time_unit;
+    double period_time;
+    double dsp_ratio;
+    double x_move[2];       // first and second half of the run
+    double y_move[2];
+    double a_move[2];
+    bool aim_on;
+};
+
+static Scenario scenarios[] =
+{
+    { "in place",           8,  600, 0.1,  {  0,   0 }, {  0,   0 }, {   0,   0 }, false },
+    { "forward",            8,  600, 0.1,  { 20,  30 }, {  0,   0 }, {   0,   0 }, false },
+    { "backward, turning",  8,  600, 0.1,  {-15, -10 }, {  0,   0 }, {  15, -10 }, false },
+    { "side steps",         8,  600, 0.1,  {  0,   5 }, { 20, -25 }, {   0,   0 }, false },
+    { "aiming",             8,  600, 0.1,  {  5,  10 }, {-10,  10 }, {  20, -20 }, true  },
+    { "slow, long DSP",     8,  900, 0.3,  { 10,  20 }, {  5,   0 }, {   5,   0 }, false },
+    { "10 msec tick",      10,  600, 0.1,  { 25,  10 }, {-10,   0 }, { -10,  10 }, false },
+    { "6 msec tick",        6,  480, 0.15, { 15,  20 }, {  0,  10 }, {   0,  -5 }, false }
+};
+
+Walking* create_walking(Scenario *sc)
+{
+    Walking *walking = new Walking();
+
+    walking->SetTimeUnit(sc->time_unit);
+    walking->PERIOD_TIME = sc->period_time;
+    walking->DSP_RATIO = sc->dsp_ratio;
+    walking->A_MOVE_AIM_ON = sc->aim_on;
+    walking->BALANCE_ENABLE = false;
+    walking->Initialize();
+
+    return walking;
+}
+
+// amplitudes for the first and second half, stop for the last quarter
+void set_command(Scenario *sc, Walking *walking, LegacyGait *legacy, int t, int ticks)
+{
+    if(t == 0 || t == ticks / 2)
+    {
+        int half = (t == 0) ? 0 : 1;
+        walking->X_MOVE_AMPLITUDE = sc->x_move[half];
+        walking->Y_MOVE_AMPLITUDE = sc->y_move[half];
+        walking->A_MOVE_AMPLITUDE = sc->a_move[half];
+        if(t == 0)
+        {
+            walking->Start();
+            if(legacy != 0)
+                legacy->Start();
+        }
+    }
+    else if(t == ticks * 3 / 4)
+    {
+        walking->Stop();
+        if(legacy != 0)
+            legacy->Stop();
+    }
+}
+
+// Largest move of a foot endpoint (mm) from one tick to the next
+double endpoint_step(Walking *walking, double *prev)
+{
+    double max = 0;
+    for(int foot = 0; foot < 12; foot += 6)
+    {
+        for(int i = foot; i < foot + 3; i++)
+        {
+            double diff = fabs(walking->GetEndpoint(i) - prev[i]);
+            if(diff > max)
+                max = diff;
+        }
+    }
+    for(int i = 0; i < 12; i++)
+        prev[i] = walking->GetEndpoint(i);
+
+    return max;
+}
+
+struct StopScenario
+{
+    const char *name;
+    double x_move;
+    double y_move;
+    double a_move;
+};
+
+static StopScenario stop_scenarios[] =
+{
+    { "forward",    30,   0,   0 },
+    { "backward",  -20,   0,   0 },
+    { "side steps",  0,  30,   0 },
+    { "walk, turn", 25,   0,  20 }
+};
+
+// The walk stopped at every tick of one period, largest endpoint moves per
+// tick before and after Stop()
+void run_stop(StopScenario *sc, bool velocity, double *walk_max, double *stop_max)
+{
+    Walking *walking = new Walking();
+    walking->BALANCE_ENABLE = false;
+    int period = (int)(walking->PERIOD_TIME / walking->GetTimeUnit());
+
+    *walk_max = 0;
+    *stop_max = 0;
+    for(int offset = 0; offset < period; offset++)
+    {
+        double prev[12];
+        walking->Initialize();
+        if(velocity == true)
+            walking->SetVelocity(sc->x_move, sc->y_move, sc->a_move);
+        else
+            walking->SetMoveAmplitude(sc->x_move, sc->y_move, sc->a_move);
+        walking->Start();
+        walking->Process();
+        endpoint_step(walking, prev);
+
+        int t;
+        for(t = 0; t < period * 6 + offset; t++)
+        {
+            walking->Process();
+            double step = endpoint_step(walking, prev);
+            if(step > *walk_max)
+                *walk_max = step;
+        }
+
+        walking->Stop();
+        for(t = 0; t < period * 4 && walking->IsRunning() == true; t++)
+        {
+            walking->Process();
+            double step = endpoint_step(walking, prev);
+            if(step > *stop_max)
+                *stop_max = step;
+        }
+    }
+    delete walking;
+}
+
+// false if stopping a SetVelocity() walk moves a foot further in a tick
+// than the walk itself or any tick of the SetMoveAmplitude() one
+bool check_stop(StopScenario *sc)
+{
+    double walk_max, stop_max, amp_walk_max, amp_stop_max;
+    run_stop(sc, true, &walk_max, &stop_max);
+    run_stop(sc, false, &amp_walk_max, &amp_stop_max);
+
+    double bound = walk_max;
+    if(amp_walk_max > bound)
+        bound = amp_walk_max;
+    if(amp_stop_max > bound)
+        bound = amp_stop_max;
+
+    bool ok = (stop_max <= bound + 1e-6);
+    printf("stop, %-14s : walking %.2f, stopping %.2f, bound %.2f mm/tick%s\n",
+            sc->name, walk_max, stop_max, bound, ok ? "" : "  TOO FAST");
+    return ok;
+}
+
+void usage(char *name)
+{
+    fprintf(stderr, "Usage: %s [-n TICKS]\n", name);
+    fprintf(stderr, " -n TICKS : motion ticks per scenario (default 3000)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int ticks = 3000;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'n': ticks = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(ticks < 10)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int failed = 0;
+    int scenario_num = sizeof(scenarios) / sizeof(scenarios[0]);
+
+    // both generators in lock step, reading the same parameters
+    for(int s = 0; s < scenario_num; s++)
+    {
+        Scenario *sc = &scenarios[s];
+        Walking *walking = create_walking(sc);
+        LegacyGait legacy(walking);
+        legacy.Initialize();
+
+        int endpoint_diff = 0, joint_diff = 0;
+        for(int t = 0; t < ticks; t++)
+        {
+            set_command(sc, walking, &legacy, t, ticks);
+            walking->Process();
+            legacy.Process();
+
+            for(int i = 0; i < 12; i++)
+            {
+                double value = walking->GetEndpoint(i);
+                if(memcmp(&value, &legacy.m_Endpoint[i], sizeof(double)) != 0)
+                    endpoint_diff++;
+            }
+            for(int i = 0; i < 14; i++)
+            {
+                if(walking->m_Joint.GetValue(id_map[i]) != legacy.m_OutValue[i])
+                    joint_diff++;
+            }
+        }
+
+        printf("%-20s : %d endpoint and %d joint differences\n", sc->name, endpoint_diff, joint_diff);
+        if(endpoint_diff != 0 || joint_diff != 0)
+            failed++;
+
+        delete walking;
+    }
+
+    for(unsigned int s = 0; s < sizeof(stop_scenarios) / sizeof(stop_scenarios[0]); s++)
+    {
+        if(check_stop(&stop_scenarios[s]) == false)
+            failed++;
+    }
+
+    // each on its own for the timing
+    long long walking_time = 0, legacy_time = 0;
+    for(int s = 0; s < scenario_num; s++)
+    {
+        Scenario *sc = &scenarios[s];
+        Walking *walking = create_walking(sc);
+        long long start = get_time();
+        for(int t = 0; t < ticks; t++)
+        {
+            set_command(sc, walking, 0, t, ticks);
+            walking->Process();
+        }
+        walking_time += get_time() - start;
+        delete walking;
+
+        Walking *param = create_walking(sc);
+        LegacyGait legacy(param);
+        legacy.Initialize();
+        start = get_time();
+        for(int t = 0; t < ticks; t++)
+        {
+            set_command(sc, param, &legacy, t, ticks);
+            legacy.Process();
+        }
+        legacy_time += get_time() - start;
+        delete param;
+    }
+
+    printf("Walking::Process() : %.0f nsec/tick, every wsin(): %.0f nsec/tick\n",
+            (double)walking_time / (ticks * scenario_num), (double)legacy_time / (ticks * scenario_num));
+    printf("%s\n", failed == 0 ? "bit for bit identical, smooth stops" : "FAILED");
+
+    return (failed == 0) ? 0 : 1;
+}
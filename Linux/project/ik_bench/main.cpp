@@ -0,0 +1,284 @@
+/*
+ *   main.cpp
+ *
+ *   Compares Kinematics::LegIK() with the matrix based leg IK Walking used
+ *   before: largest angle difference and time per leg.
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include "LinuxDARwIn.h"
+#include "Kinematics.h"
+
+using namespace Robot;
+
+#define PI (3.14159265)
+
+
+long long get_time()
+{
+    struct timespec tv;
+    clock_gettime(CLOCK_MONOTONIC, &tv);
+
+    return (long long)tv.tv_sec * 1000000000LL + tv.tv_nsec;
+}
+
+// Walking::computeIK() as it was, for reference
+bool matrix_ik(double *out, double x, double y, double z, double a, double b, double c)
+{
+    Matrix3D Tad, Tda, Tcd, Tdc, Tac;
+    Vector3D vec;
+    double _Rac, _Acos, _Atan, _k, _l, _m, _n, _s, _c, _theta;
+    double LEG_LENGTH = Kinematics::LEG_LENGTH;
+    double THIGH_LENGTH = Kinematics::THIGH_LENGTH;
+    double CALF_LENGTH = Kinematics::CALF_LENGTH;
+    double ANKLE_LENGTH = Kinematics::ANKLE_LENGTH;
+
+    Tad.SetTransform(Point3D(x, y, z - LEG_LENGTH), Vector3D(a * 180.0 / PI, b * 180.0 / PI, c * 180.0 / PI));
+
+    vec.X = x + Tad.m[2] * ANKLE_LENGTH;
+    vec.Y = y + Tad.m[6] * ANKLE_LENGTH;
+    vec.Z = (z - LEG_LENGTH) + Tad.m[10] * ANKLE_LENGTH;
+
+    _Rac = vec.Length();
+    _Acos = acos((_Rac * _Rac - THIGH_LENGTH * THIGH_LENGTH - CALF_LENGTH * CALF_LENGTH) / (2 * THIGH_LENGTH * CALF_LENGTH));
+    if(isnan(_Acos) == 1)
+        return false;
+    *(out + 3) = _Acos;
+
+    Tda = Tad;
+    if(Tda.Inverse() == false)
+        return false;
+    _k = sqrt(Tda.m[7] * Tda.m[7] + Tda.m[11] * Tda.m[11]);
+    _l = sqrt(Tda.m[7] * Tda.m[7] + (Tda.m[11] - ANKLE_LENGTH) * (Tda.m[11] - ANKLE_LENGTH));
+    _m = (_k * _k - _l * _l - ANKLE_LENGTH * ANKLE_LENGTH) / (2 * _l * ANKLE_LENGTH);
+    if(_m > 1.0)
+        _m = 1.0;
+    else if(_m < -1.0)
+        _m = -1.0;
+    _Acos = acos(_m);
+    if(isnan(_Acos) == 1)
+        return false;
+    if(Tda.m[7] < 0.0)
+        *(out + 5) = -_Acos;
+    else
+        *(out + 5) = _Acos;
+
+    Tcd.SetTransform(Point3D(0, 0, -ANKLE_LENGTH), Vector3D(*(out + 5) * 180.0 / PI, 0, 0));
+    Tdc = Tcd;
+    if(Tdc.Inverse() == false)
+        return false;
+    Tac = Tad * Tdc;
+    _Atan = atan2(-Tac.m[1] , Tac.m[5]);
+    if(isinf(_Atan) == 1)
+        return false;
+    *(out) = _Atan;
+
+    _Atan = atan2(Tac.m[9], -Tac.m[1] * sin(*(out)) + Tac.m[5] * cos(*(out)));
+    if(isinf(_Atan) == 1)
+        return false;
+    *(out + 1) = _Atan;
+
+    _Atan = atan2(Tac.m[2] * cos(*(out)) + Tac.m[6] * sin(*(out)), Tac.m[0] * cos(*(out)) + Tac.m[4] * sin(*(out)));
+    if(isinf(_Atan) == 1)
+        return false;
+    _theta = _Atan;
+    _k = sin(*(out + 3)) * CALF_LENGTH;
+    _l = -THIGH_LENGTH - cos(*(out + 3)) * CALF_LENGTH;
+    _m = cos(*(out)) * vec.X + sin(*(out)) * vec.Y;
+    _n = cos(*(out + 1)) * vec.Z + sin(*(out)) * sin(*(out + 1)) * vec.X - cos(*(out)) * sin(*(out + 1)) * vec.Y;
+    _s = (_k * _n + _l * _m) / (_k * _k + _l * _l);
+    _c = (_n - _k * _s) / _l;
+    _Atan = atan2(_s, _c);
+    if(isinf(_Atan) == 1)
+        return false;
+    *(out + 2) = _Atan;
+    *(out + 4) = _theta - *(out + 3) - *(out + 2);
+
+    return true;
+}
+
+double uniform(double min, double max)
+{
+    return min + (max - min) * (double)rand() / (double)RAND_MAX;
+}
+
+void usage(char *name)
+{
+    fprintf(stderr, "Usage: %s [-n POSES] [-r ROUNDS]\n", name);
+    fprintf(stderr, " -n POSES  : number of random leg poses (default 1000)\n");
+    fprintf(stderr, " -r ROUNDS : times every pose is solved (default 1000)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int number = 1000;
+    int rounds = 1000;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:r:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'n': number = atoi(optarg); break;
+        case 'r': rounds = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(number < 1 || rounds < 1)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // poses in the range Walking produces
+    double *pose[6];
+    float *posef[6];
+    double *angle[6];
+    float *anglef[6];
+    for(int j = 0; j < 6; j++)
+    {
+        pose[j] = new double[number];
+        posef[j] = new float[number];
+        angle[j] = new double[number];
+        anglef[j] = new float[number];
+    }
+
+    srand(1);
+    for(int i = 0; i < number; i++)
+    {
+        pose[0][i] = uniform(-60, 60);
+        pose[1][i] = uniform(-40, 40);
+        pose[2][i] = uniform(10, 80);
+        pose[3][i] = uniform(-0.2, 0.2);
+        pose[4][i] = uniform(-0.3, 0.3);
+        pose[5][i] = uniform(-0.5, 0.5);
+        for(int j = 0; j < 6; j++)
+            posef[j][i] = (float)pose[j][i];
+    }
+
+    LegIKBatch<double> batch;
+    batch.number = number;
+    batch.x = pose[0]; batch.y = pose[1]; batch.z = pose[2];
+    batch.a = pose[3]; batch.b = pose[4]; batch.c = pose[5];
+    for(int j = 0; j < 6; j++)
+        batch.angle[j] = angle[j];
+    batch.valid = 0;
+
+    LegIKBatch<float> batchf;
+    batchf.number = number;
+    batchf.x = posef[0]; batchf.y = posef[1]; batchf.z = posef[2];
+    batchf.a = posef[3]; batchf.b = posef[4]; batchf.c = posef[5];
+    for(int j = 0; j < 6; j++)
+        batchf.angle[j] = anglef[j];
+    batchf.valid = 0;
+
+    // accuracy against the matrix IK
+    int solved = 0, mismatch = 0;
+    double max_err = 0, max_errf = 0;
+    Kinematics::LegIK(batch);
+    Kinematics::LegIK(batchf);
+    for(int i = 0; i < number; i++)
+    {
+        double ref[6], out[6];
+        bool ok_ref = matrix_ik(ref, pose[0][i], pose[1][i], pose[2][i], pose[3][i], pose[4][i], pose[5][i]);
+        bool ok = Kinematics::LegIK(out, pose[0][i], pose[1][i], pose[2][i], pose[3][i], pose[4][i], pose[5][i]);
+        if(ok != ok_ref)
+        {
+            mismatch++;
+            continue;
+        }
+        if(ok == false)
+            continue;
+
+        solved++;
+        for(int j = 0; j < 6; j++)
+        {
+            if(fabs(out[j] - ref[j]) > max_err)
+                max_err = fabs(out[j] - ref[j]);
+            if(fabs(angle[j][i] - out[j]) > max_err)
+                max_err = fabs(angle[j][i] - out[j]);
+            if(fabs(anglef[j][i] - ref[j]) > max_errf)
+                max_errf = fabs(anglef[j][i] - ref[j]);
+        }
+    }
+
+    printf("poses           : %d, %d reachable, %d disagree on reachability\n", number, solved, mismatch);
+    printf("max difference  : double %.3g rad, float %.3g rad (1 servo step = %.3g rad)\n",
+            max_err, max_errf, 1.0 / MX28::RATIO_ANGLE2VALUE * PI / 180.0);
+
+    // speed
+    double out[6];
+    float outf[6];
+    volatile double sink = 0;
+    long long start;
+    double total = (double)number * rounds;
+
+    start = get_time();
+    for(int r = 0; r < rounds; r++)
+        for(int i = 0; i < number; i++)
+        {
+            matrix_ik(out, pose[0][i], pose[1][i], pose[2][i], pose[3][i], pose[4][i], pose[5][i]);
+            sink += out[2];
+        }
+    double t_matrix = (get_time() - start) / total;
+
+    start = get_time();
+    for(int r = 0; r < rounds; r++)
+        for(int i = 0; i < number; i++)
+        {
+            Kinematics::LegIK(out, pose[0][i], pose[1][i], pose[2][i], pose[3][i], pose[4][i], pose[5][i]);
+            sink += out[2];
+        }
+    double t_double = (get_time() - start) / total;
+
+    start = get_time();
+    for(int r = 0; r < rounds; r++)
+        for(int i = 0; i < number; i++)
+        {
+            Kinematics::LegIK(outf, posef[0][i], posef[1][i], posef[2][i], posef[3][i], posef[4][i], posef[5][i]);
+            sink += outf[2];
+        }
+    double t_float = (get_time() - start) / total;
+
+    start = get_time();
+    for(int r = 0; r < rounds; r++)
+    {
+        Kinematics::LegIK(batch);
+        sink += angle[2][r % number];
+    }
+    double t_batch = (get_time() - start) / total;
+
+    start = get_time();
+    for(int r = 0; r < rounds; r++)
+    {
+        Kinematics::LegIK(batchf);
+        sink += anglef[2][r % number];
+    }
+    double t_batchf = (get_time() - start) / total;
+
+    printf("matrix IK       : %7.1f nsec/leg\n", t_matrix);
+    printf("LegIK double    : %7.1f nsec/leg (x%.1f)\n", t_double, t_matrix / t_double);
+    printf("LegIK float     : %7.1f nsec/leg (x%.1f)\n", t_float, t_matrix / t_float);
+    printf("batch double    : %7.1f nsec/leg (x%.1f)\n", t_batch, t_matrix / t_batch);
+    printf("batch float     : %7.1f nsec/leg (x%.1f)\n", t_batchf, t_matrix / t_batchf);
+
+    for(int j = 0; j < 6; j++)
+    {
+        delete[] pose[j];
+        delete[] posef[j];
+        delete[] angle[j];
+        delete[] anglef[j];
+    }
+
+    return 0;
+}
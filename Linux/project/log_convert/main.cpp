@@ -0,0 +1,113 @@
+/*
+ *   main.cpp
+ *
+ *   Converts a binary telemetry log (LinuxTelemetryWriter) to CSV.
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Telemetry.h"
+
+using namespace Robot;
+
+void usage(char *name)
+{
+    fprintf(stderr, "Usage: %s LOG [CSV]\n", name);
+    fprintf(stderr, " writes to stdout when no CSV file is given\n");
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2 || argc > 3)
+    {
+        usage(argv[0]);
+        return 0;
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    if(fd < 0)
+    {
+        fprintf(stderr, "Fail to open %s\n", argv[1]);
+        return 1;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(TelemetryHeader))
+    {
+        fprintf(stderr, "%s is not a telemetry log\n", argv[1]);
+        close(fd);
+        return 1;
+    }
+
+    unsigned char *map = (unsigned char*)mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+    {
+        fprintf(stderr, "Fail to map %s\n", argv[1]);
+        return 1;
+    }
+
+    TelemetryHeader *header = (TelemetryHeader*)map;
+    if(memcmp(header->magic, TELEMETRY_MAGIC, sizeof(header->magic)) != 0
+        || header->version != TELEMETRY_VERSION
+        || header->record_size != sizeof(TelemetryRecord)
+        || header->number_of_joints != JointData::NUMBER_OF_JOINTS
+        || header->header_size > (unsigned int)st.st_size)
+    {
+        fprintf(stderr, "%s is not a version %d telemetry log of this build\n", argv[1], TELEMETRY_VERSION);
+        munmap(map, st.st_size);
+        return 1;
+    }
+
+    // a log that was not closed has no count, take what is complete
+    unsigned int count = (st.st_size - header->header_size) / header->record_size;
+    if(header->record_count != 0 && header->record_count < count)
+        count = header->record_count;
+    if(header->record_count == 0 && count != 0)
+        fprintf(stderr, "%s was not closed, converting %u complete records\n", argv[1], count);
+    if(header->dropped != 0)
+        fprintf(stderr, "%u records were dropped while logging\n", header->dropped);
+
+    FILE *out = stdout;
+    if(argc == 3)
+    {
+        out = fopen(argv[2], "w");
+        if(out == 0)
+        {
+            fprintf(stderr, "Fail to open %s\n", argv[2]);
+            munmap(map, st.st_size);
+            return 1;
+        }
+    }
+
+    fprintf(out, "Tick,Time,ProcessTime,WriteBytes,CMError,");
+    for(int id = 1; id < JointData::NUMBER_OF_JOINTS; id++)
+        fprintf(out, "ID_%d_GP,ID_%d_PP,", id, id);
+    fprintf(out, "GyroZ,GyroY,GyroX,AccelX,AccelY,AccelZ,L_FSR_X,L_FSR_Y,R_FSR_X,R_FSR_Y\n");
+
+    TelemetryRecord *record = (TelemetryRecord*)(map + header->header_size);
+    for(unsigned int i = 0; i < count; i++, record++)
+    {
+        fprintf(out, "%u,%.3f,%.3f,%u,%d,", record->tick, record->time, record->process_time,
+                record->write_bytes, record->cm_error);
+        for(int id = 1; id < JointData::NUMBER_OF_JOINTS; id++)
+            fprintf(out, "%d,%d,", record->goal_position[id], record->present_position[id]);
+        fprintf(out, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
+                record->gyro[0], record->gyro[1], record->gyro[2],
+                record->accel[0], record->accel[1], record->accel[2],
+                record->fsr_x[0], record->fsr_y[0], record->fsr_x[1], record->fsr_y[1]);
+    }
+
+    if(out != stdout)
+        fclose(out);
+    munmap(map, st.st_size);
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+/*
+ *   main.cpp
+ *
+ *   Measures MotionManager::Process() and the bus traffic it causes,
+ *   against the simulated CM-730, a replayed log, or the robot (recording).
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "LinuxDARwIn.h"
+
+using namespace Robot;
+
+
+long long get_time()
+{
+    struct timespec tv;
+    clock_gettime(CLOCK_MONOTONIC, &tv);
+
+    return (long long)tv.tv_sec * 1000000000LL + tv.tv_nsec;
+}
+
+// baud rate register value of the current protocol for 'bps', -1 if none is within 3%
+int find_baud(CM730 *cm730, int bps)
+{
+    for(int baud = 0; baud < 256; baud++)
+    {
+        int rate = cm730->GetProtocol()->GetBaudrate(baud);
+        if(rate > bps * 0.97 && rate < bps * 1.03)
+            return baud;
+    }
+
+    return -1;
+}
+
+void usage(char *name)
+{
+    fprintf(stderr, "Usage: %s [-n TICKS] [-t MSEC] [-f] [-s] [-w] [-b BPS] [-l DLOG] [-r LOG | -p LOG]\n", name);
+    fprintf(stderr, " -n TICKS : number of motion ticks (default 1000)\n");
+    fprintf(stderr, " -t MSEC  : control period (default %d)\n", MotionModule::TIME_UNIT);
+    fprintf(stderr, " -f       : simulated bus answers at once instead of at bus speed\n");
+    fprintf(stderr, " -s       : no bulk read pipelining\n");
+    fprintf(stderr, " -w       : write every joint every tick instead of only changes\n");
+    fprintf(stderr, " -b BPS   : simulated bus baud rate (default 1000000)\n");
+    fprintf(stderr, " -l DLOG  : write the telemetry of every tick into DLOG\n");
+    fprintf(stderr, " -r LOG   : run on /dev/ttyUSB0 and record the bus into LOG\n");
+    fprintf(stderr, " -p LOG   : replay LOG instead of simulating\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int ticks = 1000;
+    double time_unit = MotionModule::TIME_UNIT;
+    bool real_time = true;
+    bool pipelining = true;
+    bool delta_write = true;
+    int baudrate = 1000000;
+    char *record = 0;
+    char *replay = 0;
+    char *telemetry_log = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:t:fswb:l:r:p:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'n': ticks = atoi(optarg); break;
+        case 't': time_unit = atof(optarg); break;
+        case 'f': real_time = false; break;
+        case 's': pipelining = false; break;
+        case 'w': delta_write = false; break;
+        case 'b': baudrate = atoi(optarg); break;
+        case 'l': telemetry_log = optarg; break;
+        case 'r': record = optarg; break;
+        case 'p': replay = optarg; break;
+        default:
+            usage(argv[0]);
+            return 0;
+        }
+    }
+
+    if(ticks <= 0 || time_unit <= 0 || (record != 0 && replay != 0))
+    {
+        usage(argv[0]);
+        return 0;
+    }
+
+    LinuxSimCM730 *sim_cm730 = 0;
+    LinuxCM730 *linux_cm730 = 0;
+    PlatformCM730 *platform;
+
+    if(record != 0)
+    {
+        linux_cm730 = new LinuxCM730("/dev/ttyUSB0");
+        platform = new LinuxReplayCM730(record, linux_cm730);
+    }
+    else if(replay != 0)
+        platform = new LinuxReplayCM730(replay);
+    else
+    {
+        sim_cm730 = new LinuxSimCM730();
+        sim_cm730->REAL_TIME = real_time;
+        platform = sim_cm730;
+    }
+
+    CM730 *cm730 = new CM730(platform);
+
+    //////////////////// Framework Initialize ////////////////////////////
+    if(MotionManager::GetInstance()->Initialize(cm730) == false)
+    {
+        printf("Fail to initialize Motion Manager!\n");
+        return 0;
+    }
+    // the simulated devices start at 1Mbps like the robot; move them over
+    if(sim_cm730 != 0 && baudrate != sim_cm730->GetBaudrate())
+    {
+        int baud = find_baud(cm730, baudrate);
+        if(baud < 0 || cm730->NegotiateBaud(baud) == false)
+        {
+            printf("Fail to change the bus to %d bps!\n", baudrate);
+            return 0;
+        }
+    }
+    MotionManager::GetInstance()->SetBusPipelining(pipelining);
+    MotionManager::GetInstance()->SetDeltaWrite(delta_write);
+    MotionManager::GetInstance()->SetTimeUnit(time_unit);
+    MotionManager::GetInstance()->AddModule((MotionModule*)Walking::GetInstance());
+    /////////////////////////////////////////////////////////////////////
+
+    Walking::GetInstance()->m_Joint.SetEnableBody(true, true);
+    MotionManager::GetInstance()->SetEnable(true);
+    Walking::GetInstance()->SetMoveAmplitude(10.0, 0, 0);
+    Walking::GetInstance()->Start();
+
+    LinuxTelemetryWriter telemetry(MotionManager::GetInstance());
+    if(telemetry_log != 0 && telemetry.Start(telemetry_log) == false)
+        return 0;
+
+    cm730->GetStatistics()->Clear();
+    if(sim_cm730 != 0)
+        sim_cm730->ResetBusStatistics();
+
+    double total = 0, max = 0;
+    long long write_bytes = 0;
+    int max_write_bytes = 0;
+    long long start = get_time();
+    long long next = start;
+
+    for(int i = 0; i < ticks; i++)
+    {
+        long long t = get_time();
+        MotionManager::GetInstance()->Process();
+        double elapsed = (double)(get_time() - t) / 1000000.0;
+
+        total += elapsed;
+        if(elapsed > max)
+            max = elapsed;
+
+        write_bytes += MotionManager::GetInstance()->GetWriteBytes();
+        if(MotionManager::GetInstance()->GetWriteBytes() > max_write_bytes)
+            max_write_bytes = MotionManager::GetInstance()->GetWriteBytes();
+
+        // keep the robot's tick rate when the bus runs in real time
+        if(record != 0 || (sim_cm730 != 0 && real_time == true))
+        {
+            next += (long long)(time_unit * 1000000.0);
+            long long remain = next - get_time();
+            if(remain > 0)
+                usleep((useconds_t)(remain / 1000));
+        }
+    }
+
+    double run_time = (double)(get_time() - start) / 1000000.0;
+    telemetry.Stop();
+
+    printf("ticks           : %d x %.1f msec (%s)\n", ticks, time_unit, pipelining ? "pipelined" : "sequential");
+    printf("Process()       : mean %.3f msec, max %.3f msec\n", total / ticks, max);
+    printf("run time        : %.1f msec\n", run_time);
+    if(telemetry_log != 0)
+        printf("telemetry       : %u records, %u dropped\n", telemetry.GetRecordCount(), telemetry.GetDroppedCount());
+    printf("joint write     : mean %.1f bytes/tick, max %d (%s)\n",
+           (double)write_bytes / ticks, max_write_bytes, delta_write ? "changes only" : "every joint");
+
+    unsigned int tx_bytes = 0, rx_bytes = 0, packets = 0, errors = 0;
+    for(int i = 0; i < BusStatistics::NUMBER_OF_INSTRUCTION; i++)
+    {
+        BusCounter counter;
+        cm730->GetStatistics()->GetInstructionSnapshot(i, &counter);
+        if(counter.packets == 0)
+            continue;
+        printf("  %-12s: %6u packets %8u tx bytes %8u rx bytes\n",
+               BusStatistics::GetInstructionName(i), counter.packets, counter.tx_bytes, counter.rx_bytes);
+        tx_bytes += counter.tx_bytes;
+        rx_bytes += counter.rx_bytes;
+        packets += counter.packets;
+        errors += counter.tx_fail + counter.rx_timeout + counter.rx_corrupt;
+    }
+    printf("bus             : %u packets, %u errors, %.1f bytes/tick\n",
+           packets, errors, (double)(tx_bytes + rx_bytes) / ticks);
+
+    if(sim_cm730 != 0)
+    {
+        double period = (double)ticks * time_unit;
+        printf("bus time        : %.3f msec/tick, %.1f%% of a %.1f msec tick\n",
+               sim_cm730->GetBusTime() / ticks, sim_cm730->GetBusTime() * 100.0 / period, time_unit);
+    }
+    else if(replay != 0)
+    {
+        LinuxReplayCM730 *replay_cm730 = (LinuxReplayCM730*)platform;
+        printf("replay          : %u requests, %u differ from the log\n",
+               replay_cm730->GetRequestCount(), replay_cm730->GetMismatchCount());
+    }
+
+    delete cm730;
+    delete platform;
+    if(linux_cm730 != 0)
+        delete linux_cm730;
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ *   main.cpp
+ *
+ *   Walks PreviewWalking through a few commands without a robot: how far
+ *   the ZMP of its model leaves the reference, IK failures, the largest
+ *   joint change per tick and the time Process() takes.
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include "LinuxDARwIn.h"
+
+using namespace Robot;
+
+
+struct Scenario
+{
+    const char *name;
+    double period_time;
+    double x_move, y_move, a_move;  // first half
+    double x_move2;                 // second half
+};
+
+Scenario scenarios[] =
+{
+    { "in place",       600,  0,  0,  0,   0 },
+    { "forward",        600, 20,  0,  0,  20 },
+    { "forward, back",  600, 20,  0,  0, -20 },
+    { "side step",      600,  0, 10,  0,   0 },
+    { "turn",           600,  0,  0, 10,   0 },
+    { "walk and turn",  600, 30, 10, 10,  30 },
+    { "fast",           400, 40,  0,  0,  40 },
+};
+
+long long get_time()
+{
+    struct timespec tv;
+    clock_gettime(CLOCK_MONOTONIC, &tv);
+
+    return (long long)tv.tv_sec * 1000000000LL + tv.tv_nsec;
+}
+
+void usage(char *name)
+{
+    fprintf(stderr, "Usage: %s [-t TICKS]\n", name);
+    fprintf(stderr, " -t TICKS : ticks walked before Stop() (default 750)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int ticks = 750;
+    int opt;
+
+    while((opt = getopt(argc, argv, "t:")) != -1)
+    {
+        switch(opt)
+        {
+        case 't': ticks = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(ticks < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    PreviewWalking *walking = new PreviewWalking();
+    long long start = get_time();
+    walking->Initialize();
+    printf("gains          : %.2f msec for %d preview ticks\n\n", (get_time() - start) / 1e6, (int)(walking->PREVIEW_TIME / walking->GetTimeUnit()));
+
+    printf("%-15s %9s %7s %9s %11s %9s %9s %9s\n", "", "ZMP err", "IK fail", "joint", "walked", "stopped", "nsec", "max nsec");
+    printf("%-15s %9s %7s %9s %11s %9s %9s %9s\n", "", "(mm)", "", "(/tick)", "(mm)", "(ticks)", "(/tick)", "(/tick)");
+
+    bool ok = true;
+    for(unsigned int n = 0; n < sizeof(scenarios) / sizeof(scenarios[0]); n++)
+    {
+        Scenario *sc = &scenarios[n];
+        walking->PERIOD_TIME = sc->period_time;
+        walking->Initialize();
+        walking->SetVelocity(sc->x_move, sc->y_move, sc->a_move);
+        walking->Start();
+
+        int prev[JointData::NUMBER_OF_JOINTS];
+        for(int id = 0; id < JointData::NUMBER_OF_JOINTS; id++)
+            prev[id] = walking->m_Joint.GetValue(id);
+
+        double max_err = 0, max_time = 0, total_time = 0;
+        int max_joint = 0, stopped = -1, t;
+        for(t = 0; t < ticks * 4; t++)
+        {
+            if(t == ticks / 2)
+                walking->SetVelocity(sc->x_move2, sc->y_move, sc->a_move);
+            else if(t == ticks)
+                walking->Stop();
+
+            start = get_time();
+            walking->Process();
+            double time = (double)(get_time() - start);
+            total_time += time;
+            if(time > max_time)
+                max_time = time;
+
+            double err = hypot(walking->GetZmpX() - walking->GetZmpRefX(), walking->GetZmpY() - walking->GetZmpRefY());
+            if(err > max_err)
+                max_err = err;
+            for(int id = JointData::ID_R_HIP_YAW; id <= JointData::ID_L_ANKLE_ROLL; id++)
+            {
+                int diff = abs(walking->m_Joint.GetValue(id) - prev[id]);
+                if(diff > max_joint)
+                    max_joint = diff;
+                prev[id] = walking->m_Joint.GetValue(id);
+            }
+
+            if(t >= ticks && walking->IsRunning() == false)
+            {
+                stopped = t - ticks;
+                break;
+            }
+        }
+
+        printf("%-15s %9.1f %7u %9d %11.1f %9d %9.0f %9.0f\n", sc->name, max_err, walking->GetIKFailCount(), max_joint,
+                hypot(walking->GetComX(), walking->GetComY()), stopped, total_time / (t + 1), max_time);
+        if(stopped < 0 || walking->GetIKFailCount() > 0)
+            ok = false;
+    }
+
+    printf("\n%s\n", (ok == true) ? "all walks ended standing" : "FAILED");
+    return (ok == true) ? 0 : 1;
+}
@@ -40,15 +40,17 @@ int _getch()
 
 void* walk_thread(void* ptr)
 {
+    LinuxTelemetryWriter telemetry(MotionManager::GetInstance());
+
     while(1) {
         int ch = _getch();
         if(ch == 0x20) {
             if(Walking::GetInstance()->IsRunning() == true) {
-                MotionManager::GetInstance()->StopLogging();
+                telemetry.Stop();
                 Walking::GetInstance()->Stop();
             }
             else {
-                MotionManager::GetInstance()->StartLogging();
+                telemetry.Start();
                 Walking::GetInstance()->Start();
             }
         }
@@ -0,0 +1,186 @@
+/*
+ *   main.cpp
+ *
+ *   Screens a grid of gait candidates around the Walking settings in
+ *   config.ini with LinuxWalkEvaluator and lists the ones with the most
+ *   reach to spare.
+ *
+ *   Author: ROBOTIS
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "LinuxDARwIn.h"
+
+#define INI_FILE_PATH       "../../../Data/config.ini"
+
+using namespace Robot;
+
+
+long long get_time()
+{
+    struct timespec tv;
+    clock_gettime(CLOCK_MONOTONIC, &tv);
+
+    return (long long)tv.tv_sec * 1000000000LL + tv.tv_nsec;
+}
+
+void usage(char *name)
+{
+    fprintf(stderr, "Usage: %s [-i INI] [-n STEPS] [-c CYCLES] [-j THREADS] [-b BEST]\n", name);
+    fprintf(stderr, " -i INI     : settings to start from (default %s)\n", INI_FILE_PATH);
+    fprintf(stderr, " -n STEPS   : values tried per parameter (default 8)\n");
+    fprintf(stderr, " -c CYCLES  : gait periods per candidate (default 4)\n");
+    fprintf(stderr, " -j THREADS : worker threads, 0 for one per CPU (default 0)\n");
+    fprintf(stderr, " -b BEST    : candidates listed (default 5)\n");
+}
+
+double step(double min, double max, int i, int steps)
+{
+    return (steps > 1) ? min + (max - min) * i / (steps - 1) : min;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *ini_file = INI_FILE_PATH;
+    int steps = 8;
+    int cycles = 4;
+    int threads = 0;
+    int best = 5;
+    int opt;
+
+    while((opt = getopt(argc, argv, "i:n:c:j:b:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'i': ini_file = optarg; break;
+        case 'n': steps = atoi(optarg); break;
+        case 'c': cycles = atoi(optarg); break;
+        case 'j': threads = atoi(optarg); break;
+        case 'b': best = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(steps < 1 || cycles < 1)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Walking's defaults, overridden by the ini file when there is one
+    Walking *walking = new Walking();
+    if(access(ini_file, R_OK) == 0)
+    {
+        minIni ini(ini_file);
+        walking->LoadINISettings(&ini);
+    }
+    WalkParameters base;
+    base.Get(walking);
+    delete walking;
+
+    // PERIOD_TIME x DSP_RATIO x X_MOVE_AMPLITUDE x Z_MOVE_AMPLITUDE
+    int number = steps * steps * steps * steps;
+    WalkCandidate *candidate = new WalkCandidate[number];
+    int n = 0;
+    for(int p = 0; p < steps; p++)
+        for(int d = 0; d < steps; d++)
+            for(int x = 0; x < steps; x++)
+                for(int z = 0; z < steps; z++)
+                {
+                    candidate[n].param = base;
+                    candidate[n].param.PERIOD_TIME = step(400, 800, p, steps);
+                    candidate[n].param.DSP_RATIO = step(0.05, 0.4, d, steps);
+                    candidate[n].param.X_MOVE_AMPLITUDE = step(-20, 40, x, steps);
+                    candidate[n].param.Z_MOVE_AMPLITUDE = step(20, 60, z, steps);
+                    candidate[n].cycles = cycles;
+                    candidate[n].trajectory = 0;
+                    n++;
+                }
+
+    // one thread first, its trajectories are the reference for the parallel run
+    WalkEvaluator sizer;
+    int *serial = new int[number];
+    long long ticks = 0;
+    for(int i = 0; i < number; i++)
+    {
+        serial[i] = sizer.GetTicks(candidate[i].param, cycles) * JointData::NUMBER_OF_JOINTS;
+        ticks += sizer.GetTicks(candidate[i].param, cycles);
+    }
+    int **trajectory = new int*[number];
+    for(int i = 0; i < number; i++)
+    {
+        trajectory[i] = new int[serial[i]];
+        candidate[i].trajectory = trajectory[i];
+    }
+
+    long long start = get_time();
+    LinuxWalkEvaluator::Run(candidate, number, 1);
+    double t_serial = (get_time() - start) / 1e9;
+
+    WalkCandidate *parallel = new WalkCandidate[number];
+    for(int i = 0; i < number; i++)
+    {
+        parallel[i] = candidate[i];
+        parallel[i].trajectory = new int[serial[i]];
+    }
+    start = get_time();
+    int used = LinuxWalkEvaluator::Run(parallel, number, threads);
+    double t_parallel = (get_time() - start) / 1e9;
+
+    int differ = 0, failing = 0;
+    for(int i = 0; i < number; i++)
+    {
+        if(memcmp(parallel[i].trajectory, candidate[i].trajectory, serial[i] * sizeof(int)) != 0
+                || parallel[i].ik_failures != candidate[i].ik_failures
+                || parallel[i].reach_margin != candidate[i].reach_margin)
+            differ++;
+        if(candidate[i].ik_failures > 0)
+            failing++;
+    }
+
+    printf("candidates     : %d, %d cycles, %lld ticks\n", number, cycles, ticks);
+    printf("1 thread       : %.3f sec (%.0f nsec/tick)\n", t_serial, t_serial * 1e9 / ticks);
+    printf("%2d threads     : %.3f sec (x%.1f)\n", used, t_parallel, t_serial / t_parallel);
+    printf("parallel run   : %d candidates differ\n", differ);
+    printf("out of reach   : %d candidates\n", failing);
+
+    // most reach to spare among the reachable ones
+    printf("\n PERIOD   DSP  X_MOVE  Z_MOVE  margin(mm)\n");
+    for(int b = 0; b < best; b++)
+    {
+        int pick = -1;
+        for(int i = 0; i < number; i++)
+        {
+            if(candidate[i].ik_failures > 0 || candidate[i].cycles == 0)
+                continue;
+            if(pick < 0 || candidate[i].reach_margin > candidate[pick].reach_margin)
+                pick = i;
+        }
+        if(pick < 0)
+            break;
+
+        WalkParameters &p = candidate[pick].param;
+        printf("%7.0f %5.2f %7.1f %7.1f %11.2f\n", p.PERIOD_TIME, p.DSP_RATIO,
+                p.X_MOVE_AMPLITUDE, p.Z_MOVE_AMPLITUDE, candidate[pick].reach_margin);
+        candidate[pick].cycles = 0; // listed
+    }
+
+    for(int i = 0; i < number; i++)
+    {
+        delete[] trajectory[i];
+        delete[] parallel[i].trajectory;
+    }
+    delete[] trajectory;
+    delete[] parallel;
+    delete[] candidate;
+    delete[] serial;
+
+    return (differ == 0) ? 0 : 1;
+}
@@ -18,6 +18,7 @@ bool bBeginCommandMode = false;
 bool bEdited = false;
 int indexPage = 1;
 Action::PAGE Page;
+LinuxTelemetryWriter *Telemetry = 0;
 Action::STEP Step;
 
 
@@ -345,6 +346,7 @@ void IncreaseValue(bool large)
 {
 	int col;
 	int row;
+	double x, y, a;
 	if(bBeginCommandMode == true)
 	{
 		col = Old_Col;
@@ -364,7 +366,9 @@ void IncreaseValue(bool large)
 	switch(row)
 	{
 	case WALKING_MODE_ROW:
-	    MotionManager::GetInstance()->StartLogging();
+		if(Telemetry == 0)
+			Telemetry = new LinuxTelemetryWriter(MotionManager::GetInstance());
+		Telemetry->Start();
 		Walking::GetInstance()->Start();
 		printf("ON    ");
 		break;
@@ -455,31 +459,37 @@ void IncreaseValue(bool large)
         break;
 
 	case STEP_FORWARDBACK_ROW:
+		Walking::GetInstance()->GetMoveAmplitude(&x, &y, &a);
 		if(large == true)
-			Walking::GetInstance()->X_MOVE_AMPLITUDE += 10;
+			x += 10;
 		else
-			Walking::GetInstance()->X_MOVE_AMPLITUDE += 1;
-		printf("%d    ", (int)Walking::GetInstance()->X_MOVE_AMPLITUDE);
+			x += 1;
+		Walking::GetInstance()->SetMoveAmplitude(x, y, a);
+		printf("%d    ", (int)x);
 		break;
 
 	case STEP_RIGHTLEFT_ROW:
+		Walking::GetInstance()->GetMoveAmplitude(&x, &y, &a);
 		if(large == true)
-			Walking::GetInstance()->Y_MOVE_AMPLITUDE += 10;
+			y += 10;
 		else
-			Walking::GetInstance()->Y_MOVE_AMPLITUDE += 1;
-		printf("%d    ", (int)Walking::GetInstance()->Y_MOVE_AMPLITUDE);
+			y += 1;
+		Walking::GetInstance()->SetMoveAmplitude(x, y, a);
+		printf("%d    ", (int)y);
 		break;
 
 	case STEP_DIRECTION_ROW:
+		Walking::GetInstance()->GetMoveAmplitude(&x, &y, &a);
 		if(large == true)
-			Walking::GetInstance()->A_MOVE_AMPLITUDE += 10;
+			a += 10;
 		else
-			Walking::GetInstance()->A_MOVE_AMPLITUDE += 1;
-		printf("%d    ", (int)Walking::GetInstance()->A_MOVE_AMPLITUDE);
+			a += 1;
+		Walking::GetInstance()->SetMoveAmplitude(x, y, a);
+		printf("%d    ", (int)a);
 		break;
 
 	case TURNING_AIM_ROW:
-		Walking::GetInstance()->A_MOVE_AIM_ON = true;
+		Walking::GetInstance()->SetMoveAimOn(true);
 		printf("ON   ");
 		break;
 
@@ -587,6 +597,7 @@ void DecreaseValue(bool large)
 {
 	int col;
 	int row;
+	double x, y, a;
 	if(bBeginCommandMode == true)
 	{
 		col = Old_Col;
@@ -607,17 +618,16 @@ void DecreaseValue(bool large)
 	{
 	case WALKING_MODE_ROW:
 		Walking::GetInstance()->Stop();
-		MotionManager::GetInstance()->StopLogging();
+		if(Telemetry != 0)
+			Telemetry->Stop();
 		printf("OFF");
+		Walking::GetInstance()->SetMoveAmplitude(0, 0, 0);
 		GoToCursor(PARAM_COL, STEP_FORWARDBACK_ROW);
-		Walking::GetInstance()->X_MOVE_AMPLITUDE = 0;
-		printf("%d    ", (int)Walking::GetInstance()->X_MOVE_AMPLITUDE);
+		printf("%d    ", 0);
 		GoToCursor(PARAM_COL, STEP_RIGHTLEFT_ROW);
-		Walking::GetInstance()->Y_MOVE_AMPLITUDE = 0;
-		printf("%d    ", (int)Walking::GetInstance()->Y_MOVE_AMPLITUDE);
+		printf("%d    ", 0);
 		GoToCursor(PARAM_COL, STEP_DIRECTION_ROW);
-		Walking::GetInstance()->A_MOVE_AMPLITUDE = 0;
-		printf("%.1f    ", Walking::GetInstance()->A_MOVE_AMPLITUDE);
+		printf("%.1f    ", 0.0);
 		break;
 
 	case X_OFFSET_ROW:
@@ -706,31 +716,37 @@ void DecreaseValue(bool large)
         break;
 
 	case STEP_FORWARDBACK_ROW:
+		Walking::GetInstance()->GetMoveAmplitude(&x, &y, &a);
 		if(large == true)
-			Walking::GetInstance()->X_MOVE_AMPLITUDE -= 10;
+			x -= 10;
 		else
-			Walking::GetInstance()->X_MOVE_AMPLITUDE -= 1;
-		printf("%d    ", (int)Walking::GetInstance()->X_MOVE_AMPLITUDE);
+			x -= 1;
+		Walking::GetInstance()->SetMoveAmplitude(x, y, a);
+		printf("%d    ", (int)x);
 		break;
 
 	case STEP_RIGHTLEFT_ROW:
+		Walking::GetInstance()->GetMoveAmplitude(&x, &y, &a);
 		if(large == true)
-			Walking::GetInstance()->Y_MOVE_AMPLITUDE -= 10;
+			y -= 10;
 		else
-			Walking::GetInstance()->Y_MOVE_AMPLITUDE -= 1;
-		printf("%d    ", (int)Walking::GetInstance()->Y_MOVE_AMPLITUDE);
+			y -= 1;
+		Walking::GetInstance()->SetMoveAmplitude(x, y, a);
+		printf("%d    ", (int)y);
 		break;
 
 	case STEP_DIRECTION_ROW:
+		Walking::GetInstance()->GetMoveAmplitude(&x, &y, &a);
 		if(large == true)
-			Walking::GetInstance()->A_MOVE_AMPLITUDE -= 10;
+			a -= 10;
 		else
-			Walking::GetInstance()->A_MOVE_AMPLITUDE -= 1;
-		printf("%d    ", (int)Walking::GetInstance()->A_MOVE_AMPLITUDE);
+			a -= 1;
+		Walking::GetInstance()->SetMoveAmplitude(x, y, a);
+		printf("%d    ", (int)a);
 		break;
 
 	case TURNING_AIM_ROW:
-		Walking::GetInstance()->A_MOVE_AIM_ON = false;
+		Walking::GetInstance()->SetMoveAimOn(false);
 		printf("OFF   ");
 		break;
 
@@ -904,7 +920,10 @@ void MonitorCmd()
 	set_stdin();
 	while(1)
 	{
-		value = MotionStatus::FB_GYRO; //MotionStatus::FB_GYRO;
+		MotionState state;
+		MotionStatus::GetState(&state);
+
+		value = state.fb_gyro;
 		if(GyroFB_min > value)
 			GyroFB_min = value;
 		if(GyroFB_max < value)
@@ -912,7 +931,7 @@ void MonitorCmd()
 		GoToCursor(PARAM_COL, X_OFFSET_ROW);
 		printf("%d (%d~%d)   ", value, GyroFB_min, GyroFB_max);
 
-		value = MotionStatus::RL_GYRO; //MotionStatus::RL_GYRO;
+		value = state.rl_gyro;
 		if(GyroRL_min > value)
 			GyroRL_min = value;
 		if(GyroRL_max < value)
@@ -920,7 +939,7 @@ void MonitorCmd()
 		GoToCursor(PARAM_COL, Y_OFFSET_ROW);
 		printf("%d (%d~%d)   ", value, GyroRL_min, GyroRL_max);
 
-		value = MotionStatus::FB_ACCEL;
+		value = state.fb_accel;
 		if(AccelFB_min > value)
 			AccelFB_min = value;
 		if(AccelFB_max < value)
@@ -928,7 +947,7 @@ void MonitorCmd()
 		GoToCursor(PARAM_COL, Z_OFFSET_ROW);
 		printf("%d (%d~%d)   ", value, AccelFB_min, AccelFB_max);
 
-		value = MotionStatus::RL_ACCEL;
+		value = state.rl_accel;
 		if(AccelRL_min > value)
 			AccelRL_min = value;
 		if(AccelRL_max < value)
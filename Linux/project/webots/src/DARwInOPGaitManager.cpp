@@ -79,10 +79,8 @@ void DARwInOPGaitManager::step(int step) {
 #endif
   
   if (mIsWalking) {
-    mWalking->X_MOVE_AMPLITUDE = mXAmplitude;
-    mWalking->A_MOVE_AMPLITUDE = mAAmplitude;
-    mWalking->Y_MOVE_AMPLITUDE = mYAmplitude;
-    mWalking->A_MOVE_AIM_ON = mMoveAimOn;
+    mWalking->SetMoveAmplitude(mXAmplitude, mYAmplitude, mAAmplitude);
+    mWalking->SetMoveAimOn(mMoveAimOn);
     mWalking->BALANCE_ENABLE = mBalanceEnable;
   }
 